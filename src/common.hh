@@ -120,6 +120,12 @@ char *GetPrintlogLine(int Line);
 void IncrementObjectCounter(void);
 void DecrementObjectCounter(void);
 uint32 GetObjectCounter(void);
+void SetHashTableStatistics(uint32 Size, uint32 Load, uint32 ProbeLength);
+void InitSnapshotProcess(void);
+void SetSnapshotState(int State);
+int GetSnapshotState(void);
+void SetSnapshotProcessID(pid_t Pid);
+void SetSnapshotProgress(int Progress, int Total);
 void IncrementPlayersOnline(void);
 void DecrementPlayersOnline(void);
 int GetPlayersOnline(void);
@@ -143,11 +149,13 @@ uint32 AddDynamicString(const char *String);
 const char *GetDynamicString(uint32 Number);
 void DeleteDynamicString(uint32 Number);
 void CleanupDynamicStrings(void);
+void DynamicStringSummary(void);
 void InitStrings(void);
 void ExitStrings(void);
 
 bool IsCountable(const char *s);
 const char *Plural(const char *s, int Count);
+bool MatchWordAt(const char *Pattern, const char *Text);
 const char *SearchForWord(const char *Pattern, const char *Text);
 const char *SearchForNumber(int Count, const char *Text);
 bool MatchString(const char *Pattern, const char *String);
@@ -167,6 +175,8 @@ void GetDate(int *Year, int *Cycle, int *Day);
 void GetAmbiente(int *Brightness, int *Color);
 uint32 GetRoundAtTime(int Hour, int Minute);
 uint32 GetRoundForNextMinute(void);
+uint64 GetMonotonicMilliseconds(void);
+uint64 GetMonotonicMicroseconds(void);
 
 // utils.cc
 // =============================================================================
@@ -182,6 +192,8 @@ void error(const char *Text, ...) ATTR_PRINTF(1, 2);
 void print(int Level, const char *Text, ...) ATTR_PRINTF(2, 3);
 int random(int Min, int Max);
 bool FileExists(const char *FileName);
+bool GetFileModificationTime(const char *FileName, timespec *Time);
+void ReplaceFile(const char *TempFileName, const char *FileName);
 
 bool isSpace(int c);
 bool isAlpha(int c);
@@ -13,6 +13,8 @@
 #include <netinet/tcp.h>
 #include <poll.h>
 #include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 
 // NOTE(fusion): We seem to add this value of 48 every time `NetLoad` is called,
@@ -21,8 +23,34 @@
 // coming from.
 #define PACKET_AVERAGE_SIZE_OVERHEAD 48
 
-#define MAX_COMMUNICATION_THREADS 1100
-#define COMMUNICATION_THREAD_STACK_SIZE ((int)KB(64))
+// NOTE(fusion): Connections used to have their own thread each, sleeping in
+// `sigwait` and being woken up through `tgkill`. They're now distributed over
+// a small fixed set of network threads, each driving its own edge-triggered
+// epoll instance. Logins still need to talk to the query manager, which is
+// blocking, so they're handed over to a separate set of login threads.
+#define NETWORK_THREADS 4
+#define NETWORK_EVENTS 256
+#define NETWORK_TICK_INTERVAL 100
+#define LOGIN_THREADS 4
+#define LOGIN_TIMEOUT 5000
+#define WRITE_STALL_TIMEOUT 5000
+#define DELAYED_CLOSE_TIMEOUT 2000
+
+// NOTE(fusion): Maximum number of commands a single connection may have queued
+// for the game thread. Its network thread stops reading once it is reached and
+// the game thread wakes it again when there is room. It replaces the old ACK
+// handshake which allowed only a single command in flight.
+#define MAX_PENDING_COMMANDS 8
+
+struct TNetworkThread {
+	ThreadHandle Thread;
+	int EpollFD;
+	int EventFD;
+	bool Terminate;
+	TConnection *FirstWakeConnection;
+	int NumberOfConnections;
+	TConnection *Connections[MAX_CONNECTIONS];
+};
 
 #if TIBIA772
 static const int TERMINALVERSION[] = {772, 772, 772};
@@ -32,7 +60,6 @@ static const int TERMINALVERSION[] = {770, 770, 770};
 
 static int TCPSocket;
 static ThreadHandle AcceptorThread;
-static pid_t AcceptorThreadID;
 static int ActiveConnections;
 
 static Semaphore RSAMutex(1);
@@ -50,91 +77,19 @@ static store<TWaitinglistEntry, 100> Waitinglist;
 static TWaitinglistEntry *WaitinglistHead;
 
 static Semaphore CommunicationThreadMutex(1);
-static bool UseOwnStacks;
-static uint8 CommunicationThreadStacks[MAX_COMMUNICATION_THREADS][COMMUNICATION_THREAD_STACK_SIZE];
-static pid_t LastUsingCommunicationThread[MAX_COMMUNICATION_THREADS];
-static int FreeCommunicationThreadStacks[MAX_COMMUNICATION_THREADS];
-static int NumberOfFreeCommunicationThreadStacks;
 
-// Communication Thread Stacks
-// =============================================================================
-void GetCommunicationThreadStack(int *StackNumber, void **Stack){
-	*StackNumber = -1;
-	*Stack = NULL;
+static std::atomic<TCommand*> CommandQueue(NULL);
 
-	if(!UseOwnStacks){
-		error("GetCommunicationThreadStack: Bibliothek unterstützt keine eigenen Stacks.\n");
-		return;
-	}
+static TNetworkThread NetworkThreads[NETWORK_THREADS];
+static Semaphore NetworkWakeMutex(1);
+static int NextNetworkThread;
 
-	CommunicationThreadMutex.down();
-	for(int i = 0; i < NumberOfFreeCommunicationThreadStacks; i += 1){
-		int FreeStack = FreeCommunicationThreadStacks[i];
-		if(LastUsingCommunicationThread[FreeStack] == 0
-				|| tgkill(GetGameProcessID(), LastUsingCommunicationThread[FreeStack], 0) == -1){
-			// NOTE(fusion): A little swap and pop action.
-			NumberOfFreeCommunicationThreadStacks -= 1;
-			FreeCommunicationThreadStacks[i] = FreeCommunicationThreadStacks[NumberOfFreeCommunicationThreadStacks];
-
-			*StackNumber = FreeStack;
-			*Stack = CommunicationThreadStacks[FreeStack];
-			break;
-		}
-	}
-	CommunicationThreadMutex.up();
-}
-
-void AttachCommunicationThreadStack(int StackNumber){
-	LastUsingCommunicationThread[StackNumber] = gettid();
-}
-
-void ReleaseCommunicationThreadStack(int StackNumber){
-	CommunicationThreadMutex.down();
-	FreeCommunicationThreadStacks[NumberOfFreeCommunicationThreadStacks] = StackNumber;
-	NumberOfFreeCommunicationThreadStacks += 1;
-	CommunicationThreadMutex.up();
-}
-
-void InitCommunicationThreadStacks(void){
-	if(UseOwnStacks){
-		memset(CommunicationThreadStacks, 0xAA, sizeof(CommunicationThreadStacks));
-		for(int i = 0; i < MAX_COMMUNICATION_THREADS; i += 1){
-			LastUsingCommunicationThread[i] = 0;
-			FreeCommunicationThreadStacks[i] = i;
-		}
-		NumberOfFreeCommunicationThreadStacks = MAX_COMMUNICATION_THREADS;
-	}
-}
-
-void ExitCommunicationThreadStacks(void){
-	if(UseOwnStacks){
-		if(NumberOfFreeCommunicationThreadStacks != MAX_COMMUNICATION_THREADS){
-			error("FreeCommunicationThreadStacks: Nicht alle Stacks freigegeben.\n");
-		}
-
-		int HighestStackAddress = -1;
-		int LowestStackAddress = COMMUNICATION_THREAD_STACK_SIZE;
-		for(int i = 0; i < MAX_COMMUNICATION_THREADS; i += 1){
-			for(int Addr = 0; Addr < COMMUNICATION_THREAD_STACK_SIZE; Addr += 1){
-				if(CommunicationThreadStacks[i][Addr] != 0xAA){
-					if(Addr < LowestStackAddress){
-						LowestStackAddress = Addr;
-					}
-
-					if(Addr > HighestStackAddress){
-						HighestStackAddress = Addr;
-					}
-				}
-			}
-		}
-
-		// NOTE(fusion): It seems we want to track whether the stack size is
-		// too small but I'd argue the method is not very robust.
-		if((HighestStackAddress - LowestStackAddress) > (COMMUNICATION_THREAD_STACK_SIZE / 2)){
-			error("Maximale Stack-Ausdehnung: %d..%d\n", LowestStackAddress, HighestStackAddress);
-		}
-	}
-}
+static ThreadHandle LoginThreads[LOGIN_THREADS];
+static TConnection *LoginOrderBuffer[MAX_CONNECTIONS + LOGIN_THREADS];
+static int LoginOrderPointerWrite;
+static int LoginOrderPointerRead;
+static Semaphore LoginOrderMutex(1);
+static Semaphore LoginOrderBufferFull(0);
 
 // Load History
 // =============================================================================
@@ -259,7 +214,7 @@ static constexpr int GetPacketSize(int DataSize){
 #endif
 }
 
-bool WriteToSocket(TConnection *Connection, uint8 *Buffer, int Size, int MaxSize){
+static int EncryptPacket(TConnection *Connection, uint8 *Buffer, int Size, int MaxSize){
 	// IMPORTANT(fusion): The final packet will have the following layout:
 	//	PLAIN:
 	//		0 .. 2 => Encrypted Size
@@ -270,7 +225,7 @@ bool WriteToSocket(TConnection *Connection, uint8 *Buffer, int Size, int MaxSize
 	//	The caller must ensure `Buffer` has four extra bytes at the beginning so
 	// the packet and payload sizes can be written. It should also ensure that
 	// `(MaxSize % 8) == 2` so we can always add the necessary amount of padding
-	// for encryption.
+	// for encryption. Returns the final packet size or -1 on failure.
 	ASSERT(Size >= 4 && Size <= MaxSize && MaxSize <= UINT16_MAX);
 
 	int DataSize = Size - 4;
@@ -282,14 +237,24 @@ bool WriteToSocket(TConnection *Connection, uint8 *Buffer, int Size, int MaxSize
 	if((Size % 8) != 2){
 		error("WriteToSocket: Failed to add padding (Size: %d, MaxSize: %d)\n",
 				Size, MaxSize);
-		return false;
+		return -1;
 	}
 
 	TWriteBuffer WriteBuffer(Buffer, 4);
 	WriteBuffer.writeWord((uint16)(Size - 2));
 	WriteBuffer.writeWord((uint16)(DataSize));
-	for(int i = 2; i < Size; i += 8){
-		Connection->SymmetricKey.encrypt(&Buffer[i]);
+	Connection->SymmetricKey.encrypt(&Buffer[2], Size - 2);
+
+	return Size;
+}
+
+bool WriteToSocket(TConnection *Connection, uint8 *Buffer, int Size, int MaxSize){
+	// NOTE(fusion): This is the blocking version used for login messages, which
+	// are sent from login threads before the connection reaches the game. See
+	// `SendData` for the non-blocking version used by network threads.
+	Size = EncryptPacket(Connection, Buffer, Size, MaxSize);
+	if(Size < 0){
+		return false;
 	}
 
 	int Attempts = 50;
@@ -370,21 +335,70 @@ bool SendLoginMessage(TConnection *Connection, int Type, const char *Message, in
 	}
 }
 
+// NOTE(fusion): Writes as much of `Buffer` as the socket will take without
+// blocking and returns the number of bytes written, or -1 on connection errors.
+static int WriteToSocketNonBlocking(TConnection *Connection, const uint8 *Buffer, int Size){
+	int BytesWritten = 0;
+	while(BytesWritten < Size){
+		int Result = (int)write(Connection->GetSocket(), &Buffer[BytesWritten], Size - BytesWritten);
+		if(Result > 0){
+			BytesWritten += Result;
+		}else if(Result == 0){
+			error("SendData: Fehler %d beim Senden an Socket %d.\n",
+					errno, Connection->GetSocket());
+			return -1;
+		}else if(errno == EAGAIN){
+			break;
+		}else if(errno != EINTR){
+			if(errno == ECONNRESET || errno == EPIPE){
+				Log("game", "Verbindung an Socket %d zusammengebrochen.\n",
+						Connection->GetSocket());
+			}else{
+				error("SendData: Fehler %d beim Senden an Socket %d.\n",
+						errno, Connection->GetSocket());
+			}
+			return -1;
+		}
+	}
+	return BytesWritten;
+}
+
 bool SendData(TConnection *Connection){
 	if(Connection == NULL){
 		error("SendData: Verbindung ist NULL.\n");
 		return false;
 	}
 
+	// NOTE(fusion): Packets are always sent whole and in order, so we can't
+	// build a new one before the previous one has left completely. Whatever is
+	// left stays pending until the socket becomes writable again (`EPOLLOUT`).
+	if(Connection->PendingData != NULL){
+		int BytesWritten = WriteToSocketNonBlocking(Connection,
+				&Connection->PendingData[Connection->PendingPosition],
+				Connection->PendingSize - Connection->PendingPosition);
+		if(BytesWritten < 0){
+			return false;
+		}
+
+		Connection->PendingPosition += BytesWritten;
+		if(Connection->PendingPosition < Connection->PendingSize){
+			return true;
+		}
+
+		delete[] Connection->PendingData;
+		Connection->PendingData = NULL;
+		Connection->PendingSize = 0;
+		Connection->PendingPosition = 0;
+		Connection->PendingSince = 0;
+	}
+
 	int DataSize = Connection->NextToCommit - Connection->NextToSend;
-	int PacketSize = GetPacketSize(DataSize);
+	if(DataSize <= 0){
+		return true;
+	}
 
-	// TODO(fusion): The maximum size of a packet depends on the size of
-	// `Connection->OutData` and I don't think we'd have a problem with
-	// having a constant size buffer on the stack here although with such
-	// a small stack size (64KB with our own stacks) it could become a
-	// problem.
-	uint8 *Buffer = (uint8*)alloca(PacketSize);
+	int PacketSize = GetPacketSize(DataSize);
+	uint8 Buffer[GetPacketSize(sizeof(Connection->OutData))];
 	TWriteBuffer WriteBuffer(Buffer, PacketSize);
 	WriteBuffer.writeWord(0); // EncryptedSize
 	WriteBuffer.writeWord(0); // DataSize
@@ -402,11 +416,30 @@ bool SendData(TConnection *Connection){
 		WriteBuffer.writeBytes(&Connection->OutData[0],         DataEnd - OutDataSize);
 	}
 
-	bool Result = WriteToSocket(Connection, Buffer, WriteBuffer.Position, WriteBuffer.Size);
-	if(Result){
-		Connection->NextToSend += DataSize;
+	int Size = EncryptPacket(Connection, Buffer, WriteBuffer.Position, WriteBuffer.Size);
+	if(Size < 0){
+		return false;
 	}
-	return Result;
+
+	// NOTE(fusion): The data leaves the ring buffer as soon as it is encrypted,
+	// even if the socket doesn't take all of it at once.
+	Connection->NextToSend += DataSize;
+	NetLoad(PACKET_AVERAGE_SIZE_OVERHEAD + Size, true);
+
+	int BytesWritten = WriteToSocketNonBlocking(Connection, Buffer, Size);
+	if(BytesWritten < 0){
+		return false;
+	}
+
+	if(BytesWritten < Size){
+		Connection->PendingSize = Size - BytesWritten;
+		Connection->PendingPosition = 0;
+		Connection->PendingData = new uint8[Connection->PendingSize];
+		Connection->PendingSince = GetMonotonicMilliseconds();
+		memcpy(Connection->PendingData, &Buffer[BytesWritten], Connection->PendingSize);
+	}
+
+	return true;
 }
 
 // Waiting List
@@ -618,54 +651,26 @@ int CheckWaitingTime(const char *Name, TConnection *Connection, bool FreeAccount
 // Connection Input
 // =============================================================================
 int ReadFromSocket(TConnection *Connection, uint8 *Buffer, int Size){
-	int Attempts = 50;
-	int BytesToRead = Size;
-	uint8 *ReadPtr = Buffer;
-	while(BytesToRead > 0){
-		int BytesRead = (int)read(Connection->GetSocket(), ReadPtr, BytesToRead);
-		if(BytesRead > 0){
-			BytesToRead -= BytesRead;
-			ReadPtr += BytesRead;
-		}else if(BytesRead == 0){
+	// NOTE(fusion): Sockets are non-blocking and driven by edge-triggered epoll
+	// so we only read what is already there. Returns the number of bytes read,
+	// zero if the peer has closed the connection, or -1 on errors. `EAGAIN` is
+	// not an error but it will have `errno` set so the caller can tell.
+	int BytesRead = 0;
+	while(BytesRead < Size){
+		int Result = (int)read(Connection->GetSocket(), &Buffer[BytesRead], Size - BytesRead);
+		if(Result > 0){
+			BytesRead += Result;
+		}else if(Result == 0){
 			// NOTE(fusion): TCP FIN with no more data to read.
 			break;
 		}else if(errno != EINTR){
-			if(errno != EAGAIN || BytesToRead == Size || Attempts <= 0){
-				return -1;
+			if(errno == EAGAIN && BytesRead > 0){
+				break;
 			}
-			DelayThread(0, 100000);
-			Attempts -= 1;
+			return -1;
 		}
 	}
-	return Size - BytesToRead;
-}
-
-bool DrainSocket(TConnection *Connection, int Size){
-	uint8 DiscardBuffer[KB(2)];
-	while(Size > 0){
-		int BytesToRead = std::min<int>(Size, sizeof(DiscardBuffer));
-		int BytesRead = ReadFromSocket(Connection, DiscardBuffer, BytesToRead);
-		if(BytesRead <= 0){
-			return false;
-		}
-		Size -= BytesRead;
-		NetLoad(PACKET_AVERAGE_SIZE_OVERHEAD + BytesRead, false);
-	}
-	return true;
-}
-
-bool CallGameThread(TConnection *Connection){
-	if(GameRunning()){
-		Connection->WaitingForACK = true;
-		if(tgkill(GetGameProcessID(), GetGameThreadID(), SIGUSR1) == -1){
-			error("CallGameThread: Can't send SIGUSR1 to thread %d/%d: (%d) %s\n",
-					GetGameProcessID(), GetGameThreadID(), errno, strerrordesc_np(errno));
-			SendLoginMessage(Connection, LOGIN_MESSAGE_ERROR,
-					"The server is not online.\nPlease try again later.", -1);
-			return false;
-		}
-	}
-	return true;
+	return BytesRead;
 }
 
 bool CheckConnection(TConnection *Connection){
@@ -1119,64 +1124,92 @@ bool HandleLogin(TConnection *Connection){
 
 	Connection->NextToSend = 0;
 	Connection->NextToCommit = 0;
-	Connection->InDataSize = WriteBuffer.Position;
 	Connection->NextToWrite = 0;
 
 	Connection->Login();
-	return CallGameThread(Connection);
+	return CallGameThread(Connection, Connection->InData + 2, WriteBuffer.Position);
 }
 
 bool ReceiveCommand(TConnection *Connection){
 	// IMPORTANT(fusion): The return value of this function is used to determine
 	// whether the connection should be closed. Returning true will maintain it
 	// open. It is a weird convention but w/e.
+	//	Packets may arrive in pieces so the read state is kept in the connection
+	// (`InPacket`, `InSize`, `InSizeRead`, `InDataRead`, `InDataDiscard`) and we
+	// return as soon as the socket has no more data. The network thread will call
+	// us again on the next `EPOLLIN` or when the game thread has made room in the
+	// connection's command queue.
+	//	`InData` belongs to the game thread and is only filled in by it, right
+	// before a queued command is dispatched.
 
 	if(Connection == NULL){
 		error("ReceiveCommand: Connection ist NULL.\n");
 		return false;
 	}
 
-	while(!Connection->WaitingForACK){
-		uint8 Help[2];
-		int BytesRead = ReadFromSocket(Connection, Help, 2);
-		if(BytesRead == 0){
-			// NOTE(fusion): Peer has closed the connection and there was no
-			// more data to read.
-			return false;
-		}else if(BytesRead < 0){
-			// NOTE(fusion): There was either no data to be read or a connection
-			// error. Since we can't differ, let the connection be closed elsewhere
-			// in case of errors. This is the only path that will not cause the
-			// connection to be closed, aside from successfully reading a packet.
-			return true;
-		}
-
-		// NOTE(fusion): It doesn't make sense to continue if we couldn't read
-		// the packet's length completely. We're already using TCP which doesn't
-		// drop data so it would only compound into more errors.
-		if(BytesRead != 2){
+	while(Connection->PendingCommands < MAX_PENDING_COMMANDS && !Connection->LoginPending){
+		if(Connection->InDataDiscard > 0){
+			uint8 DiscardBuffer[KB(2)];
+			int BytesToRead = std::min<int>(Connection->InDataDiscard, sizeof(DiscardBuffer));
+			int BytesRead = ReadFromSocket(Connection, DiscardBuffer, BytesToRead);
+			if(BytesRead <= 0){
+				return BytesRead < 0 && errno == EAGAIN;
+			}
+			Connection->InDataDiscard -= BytesRead;
 			NetLoad(PACKET_AVERAGE_SIZE_OVERHEAD + BytesRead, false);
-			print(3, "Zu wenig Daten an Socket %d.\n", BytesRead);
-			return false;
+			continue;
 		}
 
-		// TODO(fusion): Size is encoded as a little endian uint16. We should
-		// have a few helper functions to assist with buffer reading.
-		int Size = ((uint16)Help[0] | ((uint16)Help[1] << 8));
+		if(Connection->InSizeRead < 2){
+			int BytesRead = ReadFromSocket(Connection,
+					&Connection->InSize[Connection->InSizeRead],
+					2 - Connection->InSizeRead);
+			if(BytesRead == 0){
+				// NOTE(fusion): Peer has closed the connection and there was no
+				// more data to read.
+				return false;
+			}else if(BytesRead < 0){
+				// NOTE(fusion): No more data to be read for now. Anything else is
+				// a connection error.
+				return errno == EAGAIN;
+			}
 
-		if(Size == 0 || Size > (int)sizeof(Connection->InData)){
-			// TODO(fusion): We should definitely close the connection here.
-			// Nevertheless, the original handling of this edge case was just
-			// terrible, reading from the socket recklessly until at least `Size`
-			// bytes were discarded. I replaced it with a small helper function
-			// function `DrainSocket`.
-			print(3, "Paket an Socket %d zu groß oder leer, wird verworfen (%d Bytes)\n",
-					Connection->GetSocket(), Size);
-			return DrainSocket(Connection, Size);
+			Connection->InSizeRead += BytesRead;
+			if(Connection->InSizeRead < 2){
+				continue;
+			}
+
+			// TODO(fusion): Size is encoded as a little endian uint16. We should
+			// have a few helper functions to assist with buffer reading.
+			int Size = ((uint16)Connection->InSize[0] | ((uint16)Connection->InSize[1] << 8));
+			if(Size == 0 || Size > (int)sizeof(Connection->InPacket)){
+				// TODO(fusion): We should definitely close the connection here.
+				// Nevertheless, the original handling of this edge case was to
+				// discard at least `Size` bytes and carry on.
+				print(3, "Paket an Socket %d zu groß oder leer, wird verworfen (%d Bytes)\n",
+						Connection->GetSocket(), Size);
+				Connection->InSizeRead = 0;
+				Connection->InDataDiscard = Size;
+				continue;
+			}
+
+			Connection->InDataRead = 0;
 		}
 
-		BytesRead = ReadFromSocket(Connection, &Connection->InData[0], Size);
-		if(BytesRead < 0){
+		int Size = ((uint16)Connection->InSize[0] | ((uint16)Connection->InSize[1] << 8));
+		int BytesRead = ReadFromSocket(Connection,
+				&Connection->InPacket[Connection->InDataRead],
+				Size - Connection->InDataRead);
+		if(BytesRead == 0){
+			// NOTE(fusion): It doesn't make sense to continue if we didn't receive
+			// the whole packet. We're already using TCP which doesn't drop data so
+			// it would only compound into more errors.
+			return false;
+		}else if(BytesRead < 0){
+			if(errno == EAGAIN){
+				return true;
+			}
+
 			// NOTE(fusion): It doesn't make sense to call `SendLoginMessage` before
 			// the key exchange has completed, which happens after login.
 			if(Connection->State != CONNECTION_CONNECTED){
@@ -1186,21 +1219,24 @@ bool ReceiveCommand(TConnection *Connection){
 			return false;
 		}
 
-		NetLoad(PACKET_AVERAGE_SIZE_OVERHEAD + BytesRead, false);
-
-		// NOTE(fusion): It doesn't make sense to continue if we didn't receive
-		// the whole packet. We're already using TCP which doesn't drop data so
-		// it would only compound into more errors.
-		if(BytesRead != Size){
-			return false;
+		Connection->InDataRead += BytesRead;
+		if(Connection->InDataRead < Size){
+			continue;
 		}
 
+		Connection->InSizeRead = 0;
+		Connection->InDataRead = 0;
+		NetLoad(PACKET_AVERAGE_SIZE_OVERHEAD + Size, false);
+
 		if(Connection->State == CONNECTION_CONNECTED){
-			Connection->StopLoginTimer();
+			// NOTE(fusion): `HandleLogin` talks to the query manager which may
+			// take a while, so it is done by a login thread. The connection is
+			// left alone by its network thread until `LoginPending` is cleared.
+			memcpy(Connection->InData, Connection->InPacket, Size);
+			Connection->LoginDeadline = 0;
 			Connection->InDataSize = Size;
-			if(!HandleLogin(Connection)){
-				return false;
-			}
+			Connection->LoginPending = true;
+			LoginOrder(Connection);
 		}else{
 			// NOTE(fusion): It doesn't make sense to continue if the client didn't
 			// correctly size its packet.
@@ -1210,38 +1246,109 @@ bool ReceiveCommand(TConnection *Connection){
 				return false;
 			}
 
-			for(int i = 0; i < Size; i += 8){
-				Connection->SymmetricKey.decrypt(&Connection->InData[i]);
-			}
+			Connection->SymmetricKey.decrypt(Connection->InPacket, Size);
 
 			// NOTE(fusion): It doesn't make sense to continue if the client didn't
 			// correctly size its payload.
-			int PlainSize = ((uint16)Connection->InData[0])
-					| ((uint16)Connection->InData[1] << 8);
+			int PlainSize = ((uint16)Connection->InPacket[0])
+					| ((uint16)Connection->InPacket[1] << 8);
 			if(PlainSize == 0 || (PlainSize + 2) > Size){
 				print(3, "Nutzdaten (%d Bytes) von Paket an Socket %d zu groß oder leer.\n",
 						PlainSize, Connection->GetSocket());
 				return false;
 			}
 
-			Connection->InDataSize = PlainSize;
-			if(!CallGameThread(Connection)){
+			if(!CallGameThread(Connection, &Connection->InPacket[2], PlainSize)){
 				return false;
 			}
 		}
 	}
 
-	// NOTE(fusion): We set `SigIOPending` here to signal that there could be more
-	// packets already queued up, in which case `CommunicationThread` will attempt
-	// to read without waiting for another `SIGIO`.
-	//	The only way to know there is no more data on a socket's receive buffer is
-	// when `read` returns `EAGAIN` which is handled when `ReadFromSocket` returns
-	// a negative value.
-	Connection->SigIOPending = true;
 	return true;
 }
 
-// Communication Thread
+// Command Queue
+// =============================================================================
+// NOTE(fusion): Network and login threads push complete commands onto a lock
+// free stack which the game thread takes over as a whole whenever it is woken
+// up with `SIGUSR1`. The signal is only sent when the stack was empty, since a
+// non empty stack means the game thread has yet to take it over and will see
+// the new command anyway.
+bool CallGameThread(TConnection *Connection, const uint8 *Data, int Size){
+	if(!GameRunning()){
+		return true;
+	}
+
+	TCommand *Command = (TCommand*)malloc(sizeof(TCommand) + Size);
+	if(Command == NULL){
+		error("CallGameThread: Kann Kommando mit %d Bytes nicht anlegen.\n", Size);
+		return false;
+	}
+
+	Command->Connection = Connection;
+	Command->Data = (uint8*)(Command + 1);
+	Command->Size = Size;
+	memcpy(Command->Data, Data, Size);
+
+	// NOTE(fusion): The counter is incremented before the command is visible to
+	// the game thread so it can never see it going below zero.
+	Connection->PendingCommands += 1;
+
+	TCommand *Head = CommandQueue.load(std::memory_order_relaxed);
+	do{
+		Command->Next = Head;
+	}while(!CommandQueue.compare_exchange_weak(Head, Command,
+			std::memory_order_release, std::memory_order_relaxed));
+
+	if(Head == NULL){
+		if(tgkill(GetGameProcessID(), GetGameThreadID(), SIGUSR1) == -1){
+			error("CallGameThread: Can't send SIGUSR1 to thread %d/%d: (%d) %s\n",
+					GetGameProcessID(), GetGameThreadID(), errno, strerrordesc_np(errno));
+			SendLoginMessage(Connection, LOGIN_MESSAGE_ERROR,
+					"The server is not online.\nPlease try again later.", -1);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TCommand *TakeCommands(void){
+	// NOTE(fusion): Commands are pushed in LIFO order so we need to reverse the
+	// list to process them in the order they were received.
+	TCommand *Command = CommandQueue.exchange(NULL, std::memory_order_acquire);
+	TCommand *First = NULL;
+	while(Command != NULL){
+		TCommand *Next = Command->Next;
+		Command->Next = First;
+		First = Command;
+		Command = Next;
+	}
+	return First;
+}
+
+void ReleaseCommand(TCommand *Command){
+	TConnection *Connection = Command->Connection;
+	int Pending = Connection->PendingCommands.fetch_sub(1);
+	if(Pending >= MAX_PENDING_COMMANDS && Connection->Live()){
+		// NOTE(fusion): The network thread stopped reading when the queue was
+		// full and it won't get another `EPOLLIN` for data that is already
+		// buffered, so we need to poke it.
+		WakeConnection(Connection);
+	}
+	free(Command);
+}
+
+static void DiscardCommands(void){
+	TCommand *Command = TakeCommands();
+	while(Command != NULL){
+		TCommand *Next = Command->Next;
+		ReleaseCommand(Command);
+		Command = Next;
+	}
+}
+
+// Network Threads
 // =============================================================================
 void IncrementActiveConnections(void){
 	CommunicationThreadMutex.down();
@@ -1255,161 +1362,319 @@ void DecrementActiveConnections(void){
 	CommunicationThreadMutex.up();
 }
 
-void CommunicationThread(int Socket){
-	TConnection *Connection = AssignFreeConnection();
-	if(Connection == NULL){
-		print(2, "Keine Verbindung mehr frei.\n");
-		if(close(Socket) == -1){
-			error("CommunicationThread: Fehler %d beim Schließen der Socket (1).\n", errno);
-		}
+static void WakeNetworkThread(TNetworkThread *Thread){
+	uint64 Value = 1;
+	if(write(Thread->EventFD, &Value, sizeof(Value)) == -1 && errno != EAGAIN){
+		error("WakeNetworkThread: Fehler %d beim Schreiben auf EventFD.\n", errno);
+	}
+}
+
+// NOTE(fusion): This replaces the signals that were used to poke connection
+// threads (`SIGUSR1` for ACKs, `SIGUSR2` for output, and `SIGHUP` for closing).
+// The connection is queued with its network thread, which is woken up through
+// its eventfd, and it'll then resume reading, flush pending output, or notice
+// that the connection is closing, whatever applies.
+void WakeConnection(TConnection *Connection){
+	if(Connection->NetworkThread < 0 || Connection->NetworkThread >= NETWORK_THREADS){
+		error("WakeConnection: Verbindung ist keinem Netzwerk-Thread zugewiesen.\n");
 		return;
 	}
 
-	ASSERT(Connection->ThreadID == gettid());
-	Connection->Connect(Socket);
-	Connection->WaitingForACK = false;
+	TNetworkThread *Thread = &NetworkThreads[Connection->NetworkThread];
+	bool WasEmpty = false;
+	NetworkWakeMutex.down();
+	if(!Connection->WakePending){
+		WasEmpty = (Thread->FirstWakeConnection == NULL);
+		Connection->WakePending = true;
+		Connection->NextWakeConnection = Thread->FirstWakeConnection;
+		Thread->FirstWakeConnection = Connection;
+	}
+	NetworkWakeMutex.up();
 
-	struct f_owner_ex FOwnerEx = {};
-	FOwnerEx.type = F_OWNER_TID;
-	FOwnerEx.pid = Connection->ThreadID;
-	if(fcntl(Socket, F_SETOWN_EX, &FOwnerEx) == -1){
-		error("CommunicationThread: F_SETOWN_EX fehlgeschlagen für Socket %d.\n", Socket);
-		if(close(Socket) == -1){
-			error("CommunicationThread: Fehler %d beim Schließen der Socket (2).\n", errno);
-		}
-		Connection->Free();
-		return;
+	if(WasEmpty){
+		WakeNetworkThread(Thread);
 	}
+}
 
-	if(fcntl(Socket, F_SETFL, (O_NONBLOCK | O_ASYNC)) == -1){
-		error("ConnectionThread: F_SETFL fehlgeschlagen für Socket %d.\n", Socket);
-		if(close(Socket) == -1){
-			error("CommunicationThread: Fehler %d beim Schließen der Socket (3).\n", errno);
-		}
-		Connection->Free();
-		return;
+static void ReleaseConnection(TNetworkThread *Thread, int Index);
+
+static bool RegisterConnection(TNetworkThread *Thread, TConnection *Connection){
+	Connection->Registered = true;
+	Connection->LoginDeadline = GetMonotonicMilliseconds() + LOGIN_TIMEOUT;
+	Thread->Connections[Thread->NumberOfConnections] = Connection;
+	Thread->NumberOfConnections += 1;
+
+	// NOTE(fusion): A socket that isn't in the epoll set would never get any
+	// events, so it is closed and its slot released right away.
+	struct epoll_event Event = {};
+	Event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+	Event.data.ptr = Connection;
+	if(epoll_ctl(Thread->EpollFD, EPOLL_CTL_ADD, Connection->GetSocket(), &Event) == -1){
+		error("RegisterConnection: Fehler %d bei epoll_ctl für Socket %d.\n",
+				errno, Connection->GetSocket());
+		ReleaseConnection(Thread, Thread->NumberOfConnections - 1);
+		return false;
 	}
 
-	// NOTE(fusion): In some systems, the accepted socket will inherit TCP_NODELAY
-	// from the acceptor, making this next call redundant then. Nevertheless it is
-	// probably better to set it anyways to be sure.
-	int NoDelay = 1;
-	if(setsockopt(Socket, IPPROTO_TCP, TCP_NODELAY, &NoDelay, sizeof(NoDelay)) == -1){
-		error("ConnectionThread: Failed to set TCP_NODELAY=1 on socket %d.\n", Socket);
-		if(close(Socket) == -1){
-			error("CommunicationThread: Fehler %d beim Schließen der Socket (3.5).\n", errno);
-		}
-		Connection->Free();
-		return;
+	return true;
+}
+
+static void ReleaseConnection(TNetworkThread *Thread, int Index){
+	TConnection *Connection = Thread->Connections[Index];
+	int Socket = Connection->GetSocket();
+	if(epoll_ctl(Thread->EpollFD, EPOLL_CTL_DEL, Socket, NULL) == -1 && errno != ENOENT){
+		error("ReleaseConnection: Fehler %d bei epoll_ctl für Socket %d.\n", errno, Socket);
 	}
 
-	sigset_t SignalSet;
-	sigfillset(&SignalSet);
-	sigprocmask(SIG_SETMASK, &SignalSet, NULL);
-	if(!Connection->SetLoginTimer(5)){
-		error("CommunicationThread: Failed to set login timer.\n");
-		if(close(Socket) == -1){
-			error("CommunicationThread: Fehler %d beim Schließen der Socket (4).\n", errno);
+	if(close(Socket) == -1){
+		error("ReleaseConnection: Fehler %d beim Schließen der Socket.\n", errno);
+	}
+
+	// NOTE(fusion): Make sure there is no stale wake up left behind for this
+	// connection since it may be reassigned right after being freed.
+	NetworkWakeMutex.down();
+	if(Connection->WakePending){
+		TConnection **Link = &Thread->FirstWakeConnection;
+		while(*Link != NULL && *Link != Connection){
+			Link = &(*Link)->NextWakeConnection;
+		}
+
+		if(*Link == Connection){
+			*Link = Connection->NextWakeConnection;
 		}
-		Connection->Free();
+
+		Connection->WakePending = false;
+		Connection->NextWakeConnection = NULL;
+	}
+	NetworkWakeMutex.up();
+
+	if(Connection->PendingData != NULL){
+		delete[] Connection->PendingData;
+		Connection->PendingData = NULL;
+	}
+
+	// NOTE(fusion): A little swap and pop action.
+	Thread->NumberOfConnections -= 1;
+	Thread->Connections[Index] = Thread->Connections[Thread->NumberOfConnections];
+	Connection->Free();
+	DecrementActiveConnections();
+}
+
+static void ProcessConnectionInput(TConnection *Connection){
+	if(Connection->LoginPending || !Connection->ConnectionIsOk || !GameRunning()){
 		return;
 	}
 
 	if(!ReceiveCommand(Connection)){
 		Connection->Close(true);
 	}
+}
 
-	Connection->SigIOPending = false;
-	while(GameRunning() && Connection->ConnectionIsOk){
-		int Signal;
-		sigwait(&SignalSet, &Signal);
-		switch(Signal){
-			case SIGHUP:
-			case SIGPIPE:{
+static void ProcessConnectionOutput(TConnection *Connection){
+	if(Connection->LoginPending || !Connection->ConnectionIsOk || !GameRunning()){
+		return;
+	}
+
+	if(!SendData(Connection)){
+		Connection->Close(false);
+	}
+}
+
+static void ProcessWakeQueue(TNetworkThread *Thread){
+	NetworkWakeMutex.down();
+	TConnection *Connection = Thread->FirstWakeConnection;
+	Thread->FirstWakeConnection = NULL;
+	while(Connection != NULL){
+		TConnection *Next = Connection->NextWakeConnection;
+		Connection->WakePending = false;
+		Connection->NextWakeConnection = NULL;
+		NetworkWakeMutex.up();
+
+		// NOTE(fusion): Input is resumed here after the game thread consumes the
+		// last packet. With edge-triggered epoll there won't be another `EPOLLIN`
+		// for data that was already there while we were waiting.
+		if(Connection->Registered || RegisterConnection(Thread, Connection)){
+			ProcessConnectionInput(Connection);
+			ProcessConnectionOutput(Connection);
+		}
+
+		NetworkWakeMutex.down();
+		Connection = Next;
+	}
+	NetworkWakeMutex.up();
+}
+
+static void ProcessNetworkTimeouts(TNetworkThread *Thread){
+	// NOTE(fusion): This takes over the rest of what connection threads used to
+	// do outside their signal loop: login timeouts, giving up on stalled sockets
+	// and closing connections once the game thread has let go of them.
+	uint64 Now = GetMonotonicMilliseconds();
+	int Index = 0;
+	while(Index < Thread->NumberOfConnections){
+		TConnection *Connection = Thread->Connections[Index];
+		if(Connection->LoginPending){
+			Index += 1;
+			continue;
+		}
+
+		if(GameRunning() && Connection->ConnectionIsOk){
+			if(Connection->LoginDeadline != 0 && Now >= Connection->LoginDeadline){
+				Connection->LoginDeadline = 0;
+				if(Connection->State == CONNECTION_CONNECTED){
+					print(2, "Login-TimeOut für Socket %d.\n", Connection->GetSocket());
+					Connection->Close(false);
+				}
+			}else if(Connection->PendingData != NULL
+					&& (Now - Connection->PendingSince) >= WRITE_STALL_TIMEOUT){
+				Log("game", "Verbindung an Socket %d zusammengebrochen.\n",
+						Connection->GetSocket());
 				Connection->Close(false);
-				break;
 			}
+		}
 
-			case SIGUSR1:
-			case SIGIO:{
-				if(Signal == SIGIO || Connection->SigIOPending){
-					if(!Connection->WaitingForACK){
-						Connection->SigIOPending = false;
-						if(!ReceiveCommand(Connection)){
-							Connection->Close(true);
-						}
-					}else{
-						Connection->SigIOPending = true;
-					}
-				}
-				break;
+		// NOTE(fusion): Queued commands keep a pointer to their connection so
+		// it can't be released until the game thread is done with them.
+		if((GameRunning() && Connection->ConnectionIsOk) || Connection->Live()
+				|| Connection->PendingCommands > 0){
+			Index += 1;
+			continue;
+		}
+
+		// TODO(fusion): Is this done to allow for queued data to be sent, almost
+		// like `SO_LINGER`?
+		if(Connection->CloseTime == 0){
+			Connection->CloseTime = Now;
+			if(Connection->ClosingIsDelayed){
+				Connection->CloseTime += DELAYED_CLOSE_TIMEOUT;
 			}
+		}
 
-			case SIGUSR2:{
-				if(!SendData(Connection)){
-					Connection->Close(false);
-				}
-				break;
+		if(Now >= Connection->CloseTime){
+			ReleaseConnection(Thread, Index);
+		}else{
+			Index += 1;
+		}
+	}
+}
+
+int NetworkThreadLoop(void *Pointer){
+	TNetworkThread *Thread = (TNetworkThread*)Pointer;
+
+	// NOTE(fusion): Signals are for the game thread. We don't need any here.
+	sigset_t SignalSet;
+	sigfillset(&SignalSet);
+	pthread_sigmask(SIG_SETMASK, &SignalSet, NULL);
+
+	struct epoll_event Events[NETWORK_EVENTS];
+	uint64 NextTick = 0;
+	while(true){
+		int NumberOfEvents = epoll_wait(Thread->EpollFD,
+				Events, NARRAY(Events), NETWORK_TICK_INTERVAL);
+		if(NumberOfEvents == -1){
+			if(errno != EINTR){
+				error("NetworkThreadLoop: Fehler %d bei epoll_wait.\n", errno);
 			}
+			NumberOfEvents = 0;
+		}
 
-			case SIGALRM:{
-				// NOTE(fusion): Login timeout.
-				Connection->StopLoginTimer();
-				if(Connection->State == CONNECTION_CONNECTED){
-					print(2, "Login-TimeOut für Socket %d.\n", Socket);
-					Connection->Close(false);
+		for(int i = 0; i < NumberOfEvents; i += 1){
+			TConnection *Connection = (TConnection*)Events[i].data.ptr;
+			if(Connection == NULL){
+				uint64 Value;
+				while(read(Thread->EventFD, &Value, sizeof(Value)) > 0){
+					// no-op
 				}
-				break;
+				continue;
 			}
 
-			default:{
-				// no-op
-				break;
+			try{
+				if(Events[i].events & EPOLLOUT){
+					ProcessConnectionOutput(Connection);
+				}
+
+				if(Events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)){
+					ProcessConnectionInput(Connection);
+				}
+			}catch(const char *str){
+				error("NetworkThreadLoop: Nicht abgefangene Exception \"%s\".\n", str);
+				Connection->Close(false);
 			}
 		}
-	}
 
-	while(Connection->Live()){
-		DelayThread(1, 0);
-	}
+		ProcessWakeQueue(Thread);
+
+		uint64 Now = GetMonotonicMilliseconds();
+		if(Now >= NextTick){
+			ProcessNetworkTimeouts(Thread);
+			NextTick = Now + NETWORK_TICK_INTERVAL;
+		}
 
-	// TODO(fusion): Is this done to allow for queued data to be sent, almost
-	// like `SO_LINGER`?
-	if(Connection->ClosingIsDelayed){
-		DelayThread(2, 0);
+		NetworkWakeMutex.down();
+		bool Terminate = Thread->Terminate;
+		NetworkWakeMutex.up();
+		if(Terminate){
+			break;
+		}
 	}
 
-	if(close(Socket) == -1){
-		error("CommunicationThread: Fehler %d beim Schließen der Socket (4).\n", errno);
+	while(Thread->NumberOfConnections > 0){
+		ReleaseConnection(Thread, Thread->NumberOfConnections - 1);
 	}
 
-	Connection->Free();
+	return 0;
 }
 
-int HandleConnection(void *Data){
-	int Socket		= (uint16)((uintptr)Data);
-	int StackNumber	= (uint16)((uintptr)Data >> 16);
+// Login Threads
+// =============================================================================
+void LoginOrder(TConnection *Connection){
+	LoginOrderMutex.down();
+	LoginOrderBuffer[LoginOrderPointerWrite % NARRAY(LoginOrderBuffer)] = Connection;
+	LoginOrderPointerWrite += 1;
+	LoginOrderMutex.up();
+	LoginOrderBufferFull.up();
+}
 
-	if(UseOwnStacks){
-		AttachCommunicationThreadStack(StackNumber);
-	}
+TConnection *GetLoginOrder(void){
+	LoginOrderBufferFull.down();
+	LoginOrderMutex.down();
+	TConnection *Connection = LoginOrderBuffer[LoginOrderPointerRead % NARRAY(LoginOrderBuffer)];
+	LoginOrderPointerRead += 1;
+	LoginOrderMutex.up();
+	return Connection;
+}
 
-	try{
-		CommunicationThread(Socket);
-	}catch(RESULT r){
-		error("HandleConnection: Nicht abgefangene Exception %d.\n", r);
-	}catch(const char *str){
-		error("HandleConnection: Nicht abgefangene Exception \"%s\".\n", str);
-	}catch(const std::exception &e){
-		error("HandleConnection: Nicht abgefangene Exception %s.\n", e.what());
-	}catch(...){
-		error("HandleConnection: Nicht abgefangene Exception unbekannten Typs.\n");
-	}
+int LoginThreadLoop(void *Unused){
+	sigset_t SignalSet;
+	sigfillset(&SignalSet);
+	pthread_sigmask(SIG_SETMASK, &SignalSet, NULL);
 
-	DecrementActiveConnections();
+	while(true){
+		// NOTE(fusion): A NULL connection is the order to terminate.
+		TConnection *Connection = GetLoginOrder();
+		if(Connection == NULL){
+			break;
+		}
 
-	if(UseOwnStacks){
-		ReleaseCommunicationThreadStack(StackNumber);
+		try{
+			if(!HandleLogin(Connection)){
+				Connection->Close(true);
+			}
+		}catch(RESULT r){
+			error("LoginThreadLoop: Nicht abgefangene Exception %d.\n", r);
+			Connection->Close(true);
+		}catch(const char *str){
+			error("LoginThreadLoop: Nicht abgefangene Exception \"%s\".\n", str);
+			Connection->Close(true);
+		}catch(const std::exception &e){
+			error("LoginThreadLoop: Nicht abgefangene Exception %s.\n", e.what());
+			Connection->Close(true);
+		}catch(...){
+			error("LoginThreadLoop: Nicht abgefangene Exception unbekannten Typs.\n");
+			Connection->Close(true);
+		}
+
+		Connection->LoginPending = false;
+		WakeConnection(Connection);
 	}
 
 	return 0;
@@ -1470,75 +1735,55 @@ bool OpenSocket(void){
 }
 
 int AcceptorThreadLoop(void *Unused){
-	AcceptorThreadID = gettid();
 	print(1, "Warte auf Clients...\n");
 	while(GameRunning()){
 		int Socket = accept(TCPSocket, NULL, NULL);
 		if(Socket == -1){
-			error("AcceptorThreadLoop: Fehler %d beim Accept.\n", errno);
+			if(GameRunning()){
+				error("AcceptorThreadLoop: Fehler %d beim Accept.\n", errno);
+			}
 			continue;
 		}
 
-		// TODO(fusion): I don't think anything in here can throw any exception.
-		try{
-			if(UseOwnStacks){
-				int StackNumber;
-				void *Stack;
-				GetCommunicationThreadStack(&StackNumber, &Stack);
-				if(Stack == NULL){
-					print(3,"Kein Stack-Bereich mehr frei.\n");
-					if(close(Socket) == -1){
-						error("AcceptorThreadLoop: Fehler %d beim Schließen der Socket (1).\n", errno);
-					}
-				}else{
-					IncrementActiveConnections();
-					void *Argument = (void*)(((uintptr)Socket & 0xFFFF)
-									| (((uintptr)StackNumber & 0xFFFF) << 16));
-					ThreadHandle ConnectionThread = StartThread(HandleConnection,
-							Argument, Stack, COMMUNICATION_THREAD_STACK_SIZE, true);
-					if(ConnectionThread == INVALID_THREAD_HANDLE){
-						DecrementActiveConnections();
-						ReleaseCommunicationThreadStack(StackNumber);
-						if(close(Socket) == -1){
-							error("AcceptorThreadLoop: Fehler %d beim Schließen der Socket (2).\n", errno);
-						}
-					}
-				}
-			}else{
-				if(ActiveConnections >= MAX_COMMUNICATION_THREADS){
-					print(3,"Keine Verbindung mehr frei.\n");
-					if(close(Socket) == -1){
-						error("AcceptorThreadLoop: Fehler %d beim Schließen der Socket (3).\n", errno);
-					}
-				}else{
-					IncrementActiveConnections();
-					void *Argument = (void*)((uintptr)Socket & 0xFFFF);
-					ThreadHandle ConnectionThread = StartThread(HandleConnection,
-							Argument, COMMUNICATION_THREAD_STACK_SIZE, true);
-					if(ConnectionThread == INVALID_THREAD_HANDLE){
-						print(3, "Kann neuen Thread nicht anlegen.\n");
-						DecrementActiveConnections();
-						if(close(Socket) == -1){
-							error("AcceptorThreadLoop: Fehler %d beim Schließen der Socket (4).\n", errno);
-						}
-					}
-				}
+		TConnection *Connection = AssignFreeConnection();
+		if(Connection == NULL){
+			print(2, "Keine Verbindung mehr frei.\n");
+			if(close(Socket) == -1){
+				error("AcceptorThreadLoop: Fehler %d beim Schließen der Socket (1).\n", errno);
 			}
-		}catch(RESULT r){
-			error("AcceptorThreadLoop: Nicht abgefangene Exception %d.\n", r);
-		}catch(const char *str){
-			error("AcceptorThreadLoop: Nicht abgefangene Exception \"%s\".\n", str);
-		}catch(...){
-			error("AcceptorThreadLoop: Nicht abgefangene Exception unbekannten Typs.\n");
+			continue;
 		}
-	}
 
-	AcceptorThreadID = 0;
-	if(ActiveConnections > 0){
-		print(3, "Warte auf Beendigung von %d Communication-Threads...\n", ActiveConnections);
-		while(ActiveConnections > 0){
-			DelayThread(1, 0);
+		Connection->Connect(Socket);
+
+		if(fcntl(Socket, F_SETFL, O_NONBLOCK) == -1){
+			error("AcceptorThreadLoop: F_SETFL fehlgeschlagen für Socket %d.\n", Socket);
+			if(close(Socket) == -1){
+				error("AcceptorThreadLoop: Fehler %d beim Schließen der Socket (2).\n", errno);
+			}
+			Connection->Free();
+			continue;
+		}
+
+		// NOTE(fusion): In some systems, the accepted socket will inherit TCP_NODELAY
+		// from the acceptor, making this next call redundant then. Nevertheless it is
+		// probably better to set it anyways to be sure.
+		int NoDelay = 1;
+		if(setsockopt(Socket, IPPROTO_TCP, TCP_NODELAY, &NoDelay, sizeof(NoDelay)) == -1){
+			error("AcceptorThreadLoop: Failed to set TCP_NODELAY=1 on socket %d.\n", Socket);
+			if(close(Socket) == -1){
+				error("AcceptorThreadLoop: Fehler %d beim Schließen der Socket (3).\n", errno);
+			}
+			Connection->Free();
+			continue;
 		}
+
+		// NOTE(fusion): The network thread will register the socket with its
+		// epoll instance and take it from here.
+		IncrementActiveConnections();
+		Connection->NetworkThread = NextNetworkThread;
+		NextNetworkThread = (NextNetworkThread + 1) % NETWORK_THREADS;
+		WakeConnection(Connection);
 	}
 
 	return 0;
@@ -1546,27 +1791,103 @@ int AcceptorThreadLoop(void *Unused){
 
 // Initialization
 // =============================================================================
-void CheckThreadlibVersion(void){
-	// TODO(fusion): We'll probably remove `OwnStacks` support anyway but it
-	// seems to be using this file `/etc/image-release` as an heuristic to
-	// enable it. Not sure what this file is about.
-	UseOwnStacks = FileExists("/etc/image-release");
-	if(UseOwnStacks){
-		print(2, "Verwende eigene Stacks.\n");
-	}else{
-		print(2, "Verwende verkleinerte Bibliotheks-Stacks.\n");
+void InitNetworkThreads(void){
+	NextNetworkThread = 0;
+	for(int i = 0; i < NETWORK_THREADS; i += 1){
+		TNetworkThread *Thread = &NetworkThreads[i];
+		Thread->Thread = INVALID_THREAD_HANDLE;
+		Thread->Terminate = false;
+		Thread->FirstWakeConnection = NULL;
+		Thread->NumberOfConnections = 0;
+
+		Thread->EpollFD = epoll_create1(0);
+		if(Thread->EpollFD == -1){
+			error("InitNetworkThreads: Fehler %d bei epoll_create1.\n", errno);
+			throw "cannot create epoll instance";
+		}
+
+		Thread->EventFD = eventfd(0, EFD_NONBLOCK);
+		if(Thread->EventFD == -1){
+			error("InitNetworkThreads: Fehler %d bei eventfd.\n", errno);
+			throw "cannot create eventfd";
+		}
+
+		struct epoll_event Event = {};
+		Event.events = EPOLLIN | EPOLLET;
+		Event.data.ptr = NULL;
+		if(epoll_ctl(Thread->EpollFD, EPOLL_CTL_ADD, Thread->EventFD, &Event) == -1){
+			error("InitNetworkThreads: Fehler %d bei epoll_ctl.\n", errno);
+			throw "cannot register eventfd";
+		}
+
+		Thread->Thread = StartThread(NetworkThreadLoop, Thread, false);
+		if(Thread->Thread == INVALID_THREAD_HANDLE){
+			throw "cannot start network thread";
+		}
+	}
+
+	LoginOrderPointerWrite = 0;
+	LoginOrderPointerRead = 0;
+	for(int i = 0; i < LOGIN_THREADS; i += 1){
+		LoginThreads[i] = StartThread(LoginThreadLoop, NULL, false);
+		if(LoginThreads[i] == INVALID_THREAD_HANDLE){
+			throw "cannot start login thread";
+		}
+	}
+
+	print(2, "%d Netzwerk-Threads und %d Login-Threads gestartet.\n",
+			NETWORK_THREADS, LOGIN_THREADS);
+}
+
+void ExitNetworkThreads(void){
+	// NOTE(fusion): Login threads go first since they hand connections back to
+	// network threads when they're done with them.
+	for(int i = 0; i < LOGIN_THREADS; i += 1){
+		if(LoginThreads[i] != INVALID_THREAD_HANDLE){
+			LoginOrder(NULL);
+		}
+	}
+
+	for(int i = 0; i < LOGIN_THREADS; i += 1){
+		if(LoginThreads[i] != INVALID_THREAD_HANDLE){
+			JoinThread(LoginThreads[i]);
+			LoginThreads[i] = INVALID_THREAD_HANDLE;
+		}
+	}
+
+	if(ActiveConnections > 0){
+		print(3, "Schließe %d verbleibende Verbindungen...\n", ActiveConnections);
+	}
+
+	for(int i = 0; i < NETWORK_THREADS; i += 1){
+		TNetworkThread *Thread = &NetworkThreads[i];
+		if(Thread->Thread != INVALID_THREAD_HANDLE){
+			NetworkWakeMutex.down();
+			Thread->Terminate = true;
+			NetworkWakeMutex.up();
+			WakeNetworkThread(Thread);
+			JoinThread(Thread->Thread);
+			Thread->Thread = INVALID_THREAD_HANDLE;
+		}
+
+		if(Thread->EventFD != -1){
+			close(Thread->EventFD);
+			Thread->EventFD = -1;
+		}
+
+		if(Thread->EpollFD != -1){
+			close(Thread->EpollFD);
+			Thread->EpollFD = -1;
+		}
 	}
 }
 
 void InitCommunication(void){
-	CheckThreadlibVersion();
-	InitCommunicationThreadStacks();
 	InitLoadHistory();
 
 	WaitinglistHead = NULL;
 	TCPSocket = -1;
 	AcceptorThread = INVALID_THREAD_HANDLE;
-	AcceptorThreadID = 0;
 	ActiveConnections = 0;
 	QueryManagerConnectionPool.init();
 
@@ -1580,6 +1901,8 @@ void InitCommunication(void){
 		throw "cannot open socket";
 	}
 
+	InitNetworkThreads();
+
 	AcceptorThread = StartThread(AcceptorThreadLoop, NULL, false);
 	if(AcceptorThread == INVALID_THREAD_HANDLE){
 		throw "cannot start acceptor thread";
@@ -1587,34 +1910,41 @@ void InitCommunication(void){
 }
 
 void ExitCommunication(void){
-	// NOTE(fusion): `SIGHUP` is used to signal the connection thread to close
-	// the connection and terminate.
+	// NOTE(fusion): Closing connections used to be signaled with `SIGHUP`. Now
+	// we just mark them and let `ProcessConnections` disconnect them from the
+	// game, after which network threads will close their sockets.
 	print(3, "Beende alle Verbindungen...\n");
 	TConnection *Connection = GetFirstConnection();
 	while(Connection != NULL){
-		tgkill(GetGameProcessID(), Connection->GetThreadID(), SIGHUP);
+		if(Connection->State != CONNECTION_ASSIGNED){
+			Connection->Close(false);
+		}
 		Connection = GetNextConnection();
 	}
 
 	ProcessConnections();
 	print(3, "Alle Verbindungen beendet.\n");
 
+	// NOTE(fusion): Shutting down the listening socket will wake the acceptor
+	// thread from `accept`. It will then notice the game is no longer running.
 	if(TCPSocket != -1){
-		if(close(TCPSocket) == -1){
-			error("ExitCommunication: Fehler %d beim Schließen der Socket.\n", errno);
-		}
-		TCPSocket = -1;
+		shutdown(TCPSocket, SHUT_RDWR);
 	}
 
 	if(AcceptorThread != INVALID_THREAD_HANDLE){
-		if(AcceptorThreadID != 0){
-			tgkill(GetGameProcessID(), AcceptorThreadID, SIGHUP);
-		}
 		JoinThread(AcceptorThread);
 		AcceptorThread = INVALID_THREAD_HANDLE;
 	}
 
+	if(TCPSocket != -1){
+		if(close(TCPSocket) == -1){
+			error("ExitCommunication: Fehler %d beim Schließen der Socket.\n", errno);
+		}
+		TCPSocket = -1;
+	}
+
+	ExitNetworkThreads();
+	DiscardCommands();
 	QueryManagerConnectionPool.exit();
 	ExitLoadHistory();
-	ExitCommunicationThreadStacks();
 }
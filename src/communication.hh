@@ -12,6 +12,13 @@ enum{
 	LOGIN_MESSAGE_WAITINGLIST	= SV_CMD_LOGIN_WAITINGLIST,
 };
 
+struct TCommand {
+	TCommand *Next;
+	TConnection *Connection;
+	uint8 *Data;
+	int Size;
+};
+
 struct TWaitinglistEntry {
     TWaitinglistEntry *Next;
     char Name[30];
@@ -21,12 +28,6 @@ struct TWaitinglistEntry {
     bool Sleeping;
 };
 
-void GetCommunicationThreadStack(int *StackNumber, void **Stack);
-void AttachCommunicationThreadStack(int StackNumber);
-void ReleaseCommunicationThreadStack(int StackNumber);
-void InitCommunicationThreadStacks(void);
-void ExitCommunicationThreadStacks(void);
-
 bool LagDetected(void);
 void NetLoad(int Amount, bool Send);
 void NetLoadSummary(void);
@@ -45,21 +46,28 @@ int GetWaitinglistPosition(const char *Name, bool FreeAccount, bool Newbie);
 int CheckWaitingTime(const char *Name, TConnection *Connection, bool FreeAccount, bool Newbie);
 
 int ReadFromSocket(TConnection *Connection, uint8 *Buffer, int Size);
-bool CallGameThread(TConnection *Connection);
 bool CheckConnection(TConnection *Connection);
 TPlayerData *PerformRegistration(TConnection *Connection, char *PlayerName,
 		uint32 AccountID, const char *PlayerPassword, bool GamemasterClient);
 bool HandleLogin(TConnection *Connection);
 bool ReceiveCommand(TConnection *Connection);
 
+bool CallGameThread(TConnection *Connection, const uint8 *Data, int Size);
+TCommand *TakeCommands(void);
+void ReleaseCommand(TCommand *Command);
+
 void IncrementActiveConnections(void);
 void DecrementActiveConnections(void);
-void CommunicationThread(int Socket);
-int HandleConnection(void *Data);
+void WakeConnection(TConnection *Connection);
+int NetworkThreadLoop(void *Pointer);
+void LoginOrder(TConnection *Connection);
+TConnection *GetLoginOrder(void);
+int LoginThreadLoop(void *Unused);
 bool OpenSocket(void);
 int AcceptorThreadLoop(void *Unused);
 
-void CheckThreadlibVersion(void);
+void InitNetworkThreads(void);
+void ExitNetworkThreads(void);
 void InitCommunication(void);
 void ExitCommunication(void);
 
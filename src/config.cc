@@ -33,6 +33,9 @@ int PremiumPlayerBuffer;
 int PremiumNewbieBuffer;
 int Beat;
 int RebootTime;
+bool SnapshotSave;
+int SnapshotTimeout;
+bool BinaryPlayerData;
 
 TDatabaseSettings ADMIN_DATABASE;
 TDatabaseSettings VOLATILE_DATABASE;
@@ -110,6 +113,9 @@ void ReadConfig(void){
 	NumberOfQueryManagers = 0;
 	Beat = 200;
 	RebootTime = 540;
+	SnapshotSave = false;
+	SnapshotTimeout = 600;
+	BinaryPlayerData = true;
 
 	// rates defaults
 	EXP_RATE = 1;
@@ -201,6 +207,12 @@ void ReadConfig(void){
 			strcpy(WorldName, Script.readString());
 		}else if(strcmp(Identifier, "beat") == 0){
 			Beat = Script.readNumber();
+		}else if(strcmp(Identifier, "snapshotsave") == 0){
+			SnapshotSave = (strcmp(Script.readIdentifier(), "on") == 0);
+		}else if(strcmp(Identifier, "snapshottimeout") == 0){
+			SnapshotTimeout = Script.readNumber();
+		}else if(strcmp(Identifier, "playerdataformat") == 0){
+			BinaryPlayerData = (strcmp(Script.readIdentifier(), "text") != 0);
 		}else if(strcmp(Identifier, "admindatabase") == 0){
 			Script.readSymbol('(');
 			strcpy(ADMIN_DATABASE.Product, Script.readIdentifier());
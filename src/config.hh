@@ -48,6 +48,9 @@ extern int PremiumPlayerBuffer;
 extern int PremiumNewbieBuffer;
 extern int Beat;
 extern int RebootTime;
+extern bool SnapshotSave;
+extern int SnapshotTimeout;
+extern bool BinaryPlayerData;
 extern TDatabaseSettings ADMIN_DATABASE;
 extern TDatabaseSettings VOLATILE_DATABASE;
 extern TDatabaseSettings WEB_DATABASE;
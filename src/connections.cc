@@ -6,7 +6,6 @@
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
-#include <signal.h>
 
 static Semaphore ConnectionMutex(1);
 static int ConnectionIterator;
@@ -79,66 +78,6 @@ void TConnection::EmergencyPing(void){
 	}
 }
 
-pid_t TConnection::GetThreadID(void){
-	if(this->State == CONNECTION_FREE){
-		error("TConnection::GetThreadID: Verbindung ist nicht zugewiesen.\n");
-		return 0;
-	}
-
-	return this->ThreadID;
-}
-
-bool TConnection::SetLoginTimer(int Timeout){
-	if(this->State == CONNECTION_FREE){
-		error("TConnection::SetLoginTimer: Verbindung ist nicht zugewiesen.\n");
-		return false;
-	}
-
-	if(this->LoginTimer != 0){
-		error("TConnection::SetLoginTimer: Timer already set.\n");
-		return false;
-	}
-
-	struct sigevent SigEvent = {};
-	SigEvent.sigev_notify = SIGEV_THREAD_ID;
-	SigEvent.sigev_signo = SIGALRM;
-	SigEvent.sigev_notify_thread_id = this->ThreadID;
-	if(timer_create(CLOCK_MONOTONIC, &SigEvent, &this->LoginTimer) == -1){
-		error("TConnection::SetLoginTimer: Failed to create timer: (%d) %s\n",
-				errno, strerrordesc_np(errno));
-		return false;
-	}
-
-	struct itimerspec TimerSpec = {};
-	TimerSpec.it_value.tv_sec = Timeout;
-	if(timer_settime(this->LoginTimer, 0, &TimerSpec, NULL) == -1){
-		error("TConnection::SetLoginTimer: Failed to start timer: (%d) %s\n",
-				errno, strerrordesc_np(errno));
-		return false;
-	}
-
-	return true;
-}
-
-void TConnection::StopLoginTimer(void){
-	if(this->State == CONNECTION_FREE){
-		error("TConnection::SetLoginTimer: Verbindung ist nicht zugewiesen.\n");
-		return;
-	}
-
-	if(this->LoginTimer == 0){
-		error("TConnection::StopLoginTimer: Timer not set.\n");
-		return;
-	}
-
-	if(timer_delete(this->LoginTimer) == -1){
-		error("TConnection::StopLoginTimer: Failed to delete timer: (%d) %s\n",
-				errno, strerrordesc_np(errno));
-	}
-
-	this->LoginTimer = 0;
-}
-
 int TConnection::GetSocket(void){
 	if(this->State == CONNECTION_FREE || this->State == CONNECTION_ASSIGNED){
 		error("TConnection::GetSocket: Verbindung ist nicht angeschlossen.\n");
@@ -167,8 +106,21 @@ void TConnection::Assign(void){
 	}
 
 	this->State = CONNECTION_ASSIGNED;
-	this->ThreadID = gettid();
-	this->LoginTimer = 0;
+	this->InSizeRead = 0;
+	this->InDataRead = 0;
+	this->InDataDiscard = 0;
+	this->PendingCommands = 0;
+	this->PendingData = NULL;
+	this->PendingSize = 0;
+	this->PendingPosition = 0;
+	this->PendingSince = 0;
+	this->NetworkThread = -1;
+	this->Registered = false;
+	this->LoginPending = false;
+	this->WakePending = false;
+	this->NextWakeConnection = NULL;
+	this->LoginDeadline = 0;
+	this->CloseTime = 0;
 }
 
 void TConnection::Connect(int Socket){
@@ -313,10 +265,13 @@ void TConnection::Disconnect(void){
 		error("TConnection::Close: Ungültiger Verbindungszustand %d.\n", this->State);
 	}
 
+	// NOTE(fusion): This used to send `SIGHUP` to the connection thread which
+	// would then call `Close(false)`. The owning network thread will notice the
+	// connection is no longer live on its next tick and close the socket.
 	this->ClearKnownCreatureTable(true);
 	this->ConnectionIsOk = false;
+	this->ClosingIsDelayed = false;
 	this->State = CONNECTION_DISCONNECTED;
-	tgkill(GetGameProcessID(), this->ThreadID, SIGHUP);
 }
 
 TPlayer *TConnection::GetPlayer(void){
@@ -6,6 +6,8 @@
 #include "enums.hh"
 #include "map.hh"
 
+#include <atomic>
+
 struct TConnection;
 struct TPlayer;
 
@@ -137,10 +139,11 @@ enum ServerCommand: int {
 	SV_CMD_BUDDY_OFFLINE			= 212,
 };
 
-// TODO(fusion): The maximum number of connections should probably be kept in
-// sync with the maximum number of communication threads, or maybe it is the
-// same constant.
-#define MAX_CONNECTIONS 1100
+// NOTE(fusion): Connections are multiplexed over a small fixed set of network
+// threads (see `NetworkThreadLoop`) so this is no longer tied to the number of
+// threads we're able to spawn. The actual number of players is still limited
+// by `MaxPlayers`.
+#define MAX_CONNECTIONS 4096
 
 struct TKnownCreature {
 	KNOWNCREATURESTATE State;
@@ -154,9 +157,6 @@ struct TConnection {
 	void Process(void);
 	void ResetTimer(int Command);
 	void EmergencyPing(void);
-	pid_t GetThreadID(void);
-	bool SetLoginTimer(int Timeout);
-	void StopLoginTimer(void);
 	int GetSocket(void);
 	const char *GetIPAddress(void);
 	void Free(void);
@@ -194,8 +194,12 @@ struct TConnection {
 	// =================
 	uint8 InData[2048];
 	int InDataSize;
-	bool SigIOPending;
-	bool WaitingForACK;
+	uint8 InPacket[2048];
+	uint8 InSize[2];
+	int InSizeRead;
+	int InDataRead;
+	int InDataDiscard;
+	std::atomic<int> PendingCommands;
 	uint8 OutData[16384];
 	int NextToSend;
 	int NextToCommit;
@@ -203,10 +207,19 @@ struct TConnection {
 	bool Overflow;
 	bool WillingToSend;
 	TConnection *NextSendingConnection;
+	uint8 *PendingData;
+	int PendingSize;
+	int PendingPosition;
+	uint64 PendingSince;
 	uint32 RandomSeed;
 	CONNECTIONSTATE State;
-	pid_t ThreadID;
-	timer_t LoginTimer;
+	int NetworkThread;
+	bool Registered;
+	std::atomic<bool> LoginPending;
+	bool WakePending;
+	TConnection *NextWakeConnection;
+	uint64 LoginDeadline;
+	uint64 CloseTime;
 	int Socket;
 	char IPAddress[16];
 	TXTEASymmetricKey SymmetricKey;
@@ -225,6 +238,14 @@ struct TConnection {
 	TKnownCreature KnownCreatureTable[150];
 };
 
+// NOTE(fusion): Encoded packet shared by all viewers of the same event. It is
+// filled in by the first viewer and then copied as is into the output buffer of
+// every following viewer, instead of encoding the same data over and over.
+struct TPacketFragment {
+	uint8 Data[256];
+	int Size;
+};
+
 // connections.cc
 TConnection *AssignFreeConnection(void);
 TConnection *GetFirstConnection(void);
@@ -250,10 +271,19 @@ void SendRow(TConnection *Connection, int Direction);
 void SendFloors(TConnection *Connection, bool Up);
 void SendFieldData(TConnection *Connection, int x, int y, int z);
 void SendAddField(TConnection *Connection, int x, int y, int z, Object Obj);
+void SendAddField(TConnection *Connection, int x, int y, int z, Object Obj,
+		TPacketFragment *Fragment);
 void SendChangeField(TConnection *Connection, int x, int y, int z, Object Obj);
+void SendChangeField(TConnection *Connection, int x, int y, int z, Object Obj,
+		TPacketFragment *Fragment);
 void SendDeleteField(TConnection *Connection, int x, int y, int z, Object Obj);
+void SendDeleteField(TConnection *Connection, int x, int y, int z, Object Obj,
+		TPacketFragment *Fragment);
 void SendMoveCreature(TConnection *Connection,
 		uint32 CreatureID, int DestX, int DestY, int DestZ);
+void SendMoveCreature(TConnection *Connection,
+		uint32 CreatureID, int DestX, int DestY, int DestZ,
+		TPacketFragment *Fragment);
 void SendContainer(TConnection *Connection, int ContainerNr);
 void SendCloseContainer(TConnection *Connection, int ContainerNr);
 void SendCreateInContainer(TConnection *Connection, int ContainerNr, Object Obj);
@@ -266,9 +296,15 @@ void SendTradeOffer(TConnection *Connection, const char *Name, bool OwnOffer, Ob
 void SendCloseTrade(TConnection *Connection);
 void SendAmbiente(TConnection *Connection);
 void SendGraphicalEffect(TConnection *Connection, int x, int y, int z, int Type);
+void SendGraphicalEffect(TConnection *Connection, int x, int y, int z, int Type,
+		TPacketFragment *Fragment);
 void SendTextualEffect(TConnection *Connection, int x, int y, int z, int Color, const char *Text);
+void SendTextualEffect(TConnection *Connection, int x, int y, int z, int Color, const char *Text,
+		TPacketFragment *Fragment);
 void SendMissileEffect(TConnection *Connection, int OrigX, int OrigY, int OrigZ,
 		int DestX, int DestY, int DestZ, int Type);
+void SendMissileEffect(TConnection *Connection, int OrigX, int OrigY, int OrigZ,
+		int DestX, int DestY, int DestZ, int Type, TPacketFragment *Fragment);
 void SendMarkCreature(TConnection *Connection, uint32 CreatureID, int Color);
 void SendCreatureHealth(TConnection *Connection, uint32 CreatureID);
 void SendCreatureLight(TConnection *Connection, uint32 CreatureID);
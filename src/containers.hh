@@ -225,6 +225,191 @@ struct priority_queue{
 	int Entries;
 };
 
+// NOTE(fusion): Hierarchical timing wheel with one millisecond per tick. Four
+// levels of 256 slots cover the whole 32-bit key range and entries are moved
+// down a level each time the wheel enters the block of ticks they belong to, so
+// insertion and removal are constant time. Entries with the same key are taken
+// out in insertion order. Entries that were cascaded are always older than the
+// ones inserted directly into the slot they land in, which is why cascading puts
+// them in front.
+//	Each entry is addressed by the handle returned from `insert`, which stays
+// valid until the entry is removed or taken out with `next`.
+template<typename T>
+struct timing_wheel_entry{
+	uint32 Key;
+	T Data;
+	int Slot;
+	int Prev;
+	int Next;
+};
+
+template<typename T>
+struct timing_wheel{
+	NONCOPYABLE(timing_wheel)
+
+	timing_wheel(int capacity, int increment){
+		Entry = new vector<timing_wheel_entry<T>>(0, capacity - 1, increment);
+		for(int i = 0; i < NARRAY(Head); i += 1){
+			Head[i] = -1;
+			Tail[i] = -1;
+		}
+		FirstFree = -1;
+		Used = 0;
+		Entries = 0;
+		Base = 0;
+	}
+
+	~timing_wheel(void){
+		delete Entry;
+	}
+
+	int insert(uint32 Key, T Data){
+		int Index = this->FirstFree;
+		if(Index != -1){
+			this->FirstFree = this->Entry->at(Index)->Next;
+		}else{
+			Index = this->Used;
+			this->Used += 1;
+		}
+
+		timing_wheel_entry<T> *Current = this->Entry->at(Index);
+		Current->Key = Key;
+		Current->Data = Data;
+		this->link(Index, false);
+		this->Entries += 1;
+		return Index;
+	}
+
+	void remove(int Handle){
+		if(Handle < 0 || Handle >= this->Used || this->Entry->at(Handle)->Slot == -1){
+			error("timing_wheel::remove: Ungueltiger Eintrag %d.\n", Handle);
+			return;
+		}
+
+		this->unlink(Handle);
+		timing_wheel_entry<T> *Current = this->Entry->at(Handle);
+		Current->Next = this->FirstFree;
+		this->FirstFree = Handle;
+		this->Entries -= 1;
+	}
+
+	// NOTE(fusion): Takes out the next entry with a key up to `Time`, if any.
+	bool next(uint32 Time, T *Data){
+		while(this->Entries > 0){
+			int Index = this->Head[this->Base & 0xFF];
+			if(Index != -1){
+				*Data = this->Entry->at(Index)->Data;
+				this->remove(Index);
+				return true;
+			}
+
+			if(this->Base == Time){
+				return false;
+			}
+
+			// NOTE(fusion): Entries on higher levels for the same key were
+			// always inserted earlier, so they're cascaded last to end up in
+			// front of anything already sitting in the lower slot.
+			this->Base += 1;
+			if((this->Base & 0xFF) == 0){
+				this->cascade(1);
+				if((this->Base & 0xFFFF) == 0){
+					this->cascade(2);
+					if((this->Base & 0xFFFFFF) == 0){
+						this->cascade(3);
+					}
+				}
+			}
+		}
+
+		// NOTE(fusion): An empty wheel can skip ahead right away.
+		this->Base = Time;
+		return false;
+	}
+
+	void link(int Index, bool Front){
+		timing_wheel_entry<T> *Current = this->Entry->at(Index);
+		uint32 Key = Current->Key;
+		uint32 Delta = Key - this->Base;
+		if(Delta >= 0x80000000U){
+			// NOTE(fusion): Keys in the past are due right away.
+			Key = this->Base;
+			Delta = 0;
+		}
+
+		int Slot;
+		if(Delta < 0x100U){
+			Slot = (int)(Key & 0xFF);
+		}else if(Delta < 0x10000U){
+			Slot = 256 + (int)((Key >> 8) & 0xFF);
+		}else if(Delta < 0x1000000U){
+			Slot = 512 + (int)((Key >> 16) & 0xFF);
+		}else{
+			Slot = 768 + (int)((Key >> 24) & 0xFF);
+		}
+
+		Current->Slot = Slot;
+		if(Front){
+			Current->Prev = -1;
+			Current->Next = this->Head[Slot];
+			if(this->Head[Slot] != -1){
+				this->Entry->at(this->Head[Slot])->Prev = Index;
+			}else{
+				this->Tail[Slot] = Index;
+			}
+			this->Head[Slot] = Index;
+		}else{
+			Current->Prev = this->Tail[Slot];
+			Current->Next = -1;
+			if(this->Tail[Slot] != -1){
+				this->Entry->at(this->Tail[Slot])->Next = Index;
+			}else{
+				this->Head[Slot] = Index;
+			}
+			this->Tail[Slot] = Index;
+		}
+	}
+
+	void unlink(int Index){
+		timing_wheel_entry<T> *Current = this->Entry->at(Index);
+		int Slot = Current->Slot;
+		if(Current->Prev != -1){
+			this->Entry->at(Current->Prev)->Next = Current->Next;
+		}else{
+			this->Head[Slot] = Current->Next;
+		}
+
+		if(Current->Next != -1){
+			this->Entry->at(Current->Next)->Prev = Current->Prev;
+		}else{
+			this->Tail[Slot] = Current->Prev;
+		}
+		Current->Slot = -1;
+	}
+
+	void cascade(int Level){
+		int Slot = Level * 256 + (int)((this->Base >> (Level * 8)) & 0xFF);
+		int Index = this->Tail[Slot];
+		this->Head[Slot] = -1;
+		this->Tail[Slot] = -1;
+		while(Index != -1){
+			int Prev = this->Entry->at(Index)->Prev;
+			this->link(Index, true);
+			Index = Prev;
+		}
+	}
+
+	// DATA
+	// =================
+	vector<timing_wheel_entry<T>> *Entry;
+	int Head[4 * 256];
+	int Tail[4 * 256];
+	int FirstFree;
+	int Used;
+	int Entries;
+	uint32 Base;
+};
+
 template<typename T>
 struct matrix{
 	NONCOPYABLE(matrix)
@@ -342,6 +527,21 @@ struct matrix3d{
 		delete[] this->entry;
 	}
 
+	T *boundedAt(int x, int y, int z){
+		int xoffset = x - this->xmin;
+		int yoffset = y - this->ymin;
+		int zoffset = z - this->zmin;
+		if(xoffset < 0 || xoffset >= this->dx
+				|| yoffset < 0 || yoffset >= this->dy
+				|| zoffset < 0 || zoffset >= this->dz){
+			return NULL;
+		}else{
+			return &this->entry[zoffset * this->dx * this->dy
+								+ yoffset * this->dx
+								+ xoffset];
+		}
+	}
+
 	T *at(int x, int y, int z){
 		int xoffset = x - this->xmin;
 		int yoffset = y - this->ymin;
@@ -429,11 +429,16 @@ enum : int {
 	FIND_ALL		= FIND_PLAYERS | FIND_NPCS | FIND_MONSTERS,
 };
 
+#define MAX_CHAIN_FLOORS 16
+
 struct TFindCreatures {
 	TFindCreatures(int RadiusX, int RadiusY, int CenterX, int CenterY, int Mask);
+	TFindCreatures(int RadiusX, int RadiusY, int CenterX, int CenterY, int MinZ, int MaxZ, int Mask);
 	TFindCreatures(int RadiusX, int RadiusY, uint32 CreatureID, int Mask);
 	TFindCreatures(int RadiusX, int RadiusY, Object Obj, int Mask);
-	void initSearch(int RadiusX, int RadiusY, int CenterX, int CenterY, int Mask);
+	void initSearch(int RadiusX, int RadiusY, int CenterX, int CenterY,
+			int MinZ, int MaxZ, int Mask);
+	void loadBlock(void);
 	uint32 getNext(void);
 
 	// DATA
@@ -442,9 +447,12 @@ struct TFindCreatures {
 	int starty;
 	int endx;
 	int endy;
+	int minz;
+	int maxz;
 	int blockx;
 	int blocky;
-	uint32 ActID;
+	uint32 ActID[MAX_CHAIN_FLOORS];
+	uint64 ActStamp[MAX_CHAIN_FLOORS];
 	uint32 SkipID;
 	int Mask;
 	bool finished;
@@ -518,6 +526,8 @@ struct TCreature: TSkillBase {
 	void DelID(void);
 	void SetInCrList(void);
 	void DelInCrList(void);
+	void SetInSkillList(void);
+	void DelInSkillList(void);
 	void StartLogout(bool Force, bool StopFight);
 	int LogoutPossible(void);
 	void BlockLogout(int Delay, bool BlockProtectionZone);
@@ -545,6 +555,8 @@ struct TCreature: TSkillBase {
 	void ToDoYield(void);
 	void ToDoWait(int Delay);
 	void ToDoWaitUntil(uint32 Time);
+	void ToDoWakeup(uint32 Time);
+	void ToDoCancelWakeup(void);
 	void ToDoGo(int DestX, int DestY, int DestZ, bool MustReach, int MaxSteps);
 	void ToDoRotate(int Direction);
 	void ToDoMove(int ObjX, int ObjY, int ObjZ, ObjectType Type, uint8 RNum,
@@ -603,7 +615,10 @@ struct TCreature: TSkillBase {
 	TCombat Combat;
 	uint32 ID;
 	TCreature *NextHashEntry;
+	uint32 PrevChainCreature;
 	uint32 NextChainCreature;
+	uint64 ChainStamp;
+	int SkillListIndex;
 	char Name[31];
 	char Murderer[31];
 	TOutfit OrgOutfit;
@@ -641,6 +656,7 @@ struct TCreature: TSkillBase {
 	int ActToDo;
 	int NrToDo;
 	uint32 NextWakeup;
+	int WakeupTimer;
 	bool Stop;
 	bool LockToDo;
 	uint8 Profession;
@@ -713,6 +729,20 @@ struct TBehaviour {
 	vector<TBehaviourAction> Action;
 	int Conditions;
 	int Actions;
+	int Keyword;
+	int NextBehaviour;
+};
+
+// NOTE(fusion): Behaviours whose first text condition can only be preceded by
+// conditions without side effects are chained by that text, in ascending order
+// starting at `FirstBehaviour`. Keywords themselves are chained by their first
+// lowercase character, starting at `TBehaviourDatabase::FirstKeyword`. All other
+// behaviours are chained from `TBehaviourDatabase::FirstGenericBehaviour`.
+struct TBehaviourKeyword {
+	uint32 Text;
+	int FirstBehaviour;
+	int NextKeyword;
+	uint32 MatchStamp;
 };
 
 struct TBehaviourDatabase {
@@ -724,12 +754,18 @@ struct TBehaviourDatabase {
 	TBehaviourNode *readTerm(TReadScriptFile *Script);
 	int evaluate(TNPC *Npc, TBehaviourNode *Node, int *Parameters);
 
+	void indexKeywords(void);
 	void react(TNPC *Npc, const char *Text, SITUATION Situation);
 
 	// DATA
 	// =================
 	vector<TBehaviour> Behaviour;
 	int Behaviours;
+	vector<TBehaviourKeyword> Keyword;
+	int Keywords;
+	int FirstKeyword[256];
+	int FirstGenericBehaviour;
+	uint32 MatchStamp;
 };
 
 struct TNPC: TNonplayer {
@@ -930,22 +966,25 @@ struct TPlayer: TCreature {
 	int NumberOfMutings;
 	uint32 Addressees[20];
 	uint32 AddresseesTimes[20];
+	TPlayer *NextNameHash;
 };
 
 // crmain.cc
 // =============================================================================
 #define MAX_RACES 512
 extern TRaceData RaceData[MAX_RACES];
-extern priority_queue<uint32, uint32> ToDoQueue;
+extern timing_wheel<uint32> ToDoQueue;
 
 bool IsCreaturePlayer(uint32 CreatureID);
 TCreature *GetCreature(uint32 CreatureID);
 TCreature *GetCreature(Object Obj);
-void InsertChainCreature(TCreature *Creature, int CoordX, int CoordY);
+void GetSpectatorFloors(int FloorZ, int *MinZ, int *MaxZ);
+void InsertChainCreature(TCreature *Creature, int CoordX, int CoordY, int CoordZ);
 void DeleteChainCreature(TCreature *Creature);
-void MoveChainCreature(TCreature *Creature, int CoordX, int CoordY);
+void MoveChainCreature(TCreature *Creature, int CoordX, int CoordY, int CoordZ);
 void ProcessCreatures(void);
 void ProcessSkills(void);
+void SkillSummary(void);
 void MoveCreatures(int Delay);
 
 void AddKillStatistics(int AttackerRace, int DefenderRace);
@@ -1002,6 +1041,8 @@ void ExitNonplayer(void);
 
 // crplayer.cc
 // =============================================================================
+typedef void TSnapshotWaitFunction(void);
+
 int GetNumberOfPlayers(void);
 TPlayer *GetPlayer(uint32 CharacterID);
 TPlayer *GetPlayer(const char *Name);
@@ -1027,7 +1068,12 @@ void IncreasePlayerPoolSlotSticky(TPlayerData *Slot);
 void DecreasePlayerPoolSlotSticky(TPlayerData *Slot);
 void DecreasePlayerPoolSlotSticky(uint32 CharacterID);
 void ReleasePlayerPoolSlot(TPlayerData *Slot);
+void SetSnapshotWaitFunction(TSnapshotWaitFunction *Function);
 void SavePlayerPoolSlots(void);
+int LockPlayerPoolSnapshot(void);
+bool SavePlayerPoolSnapshot(void);
+void UnlockPlayerPoolSnapshot(bool Saved);
+void PlayerPoolSummary(void);
 void InitPlayerPool(void);
 void ExitPlayerPool(void);
 
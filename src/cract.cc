@@ -6,38 +6,47 @@
 
 // TShortway
 // =============================================================================
+// NOTE(fusion): Path finding only runs on the game thread so all searches share
+// a single node arena that grows to the largest window seen. Search state is
+// reset lazily with a generation stamp instead of clearing the whole window for
+// every search. The expand list is a binary heap ordered the same way the old
+// sorted list was, including its tie break where the most recently inserted
+// node comes first, so the chosen paths don't change.
+//	Passability is only checked for nodes the search actually reaches, plus the
+// few needed to find the smallest passable waypoints value for the heuristic.
 struct TShortwayPoint {
-	TShortwayPoint(void){
-		this->x = 0;
-		this->y = 0;
-		this->Waypoints = -1;
-		this->Waylength = -1;
-		this->Heuristic = -1;
-		this->Predecessor = NULL;
-		this->NextToExpand = NULL;
-	}
-
 	int x;
 	int y;
 	int Waypoints;
+	int Passable;
 	int Waylength;
 	int Heuristic;
+	int HeapIndex;
+	uint32 InsertStamp;
+	uint32 Generation;
 	TShortwayPoint *Predecessor;
-	TShortwayPoint *NextToExpand;
 };
 
 struct TShortway{
 	TShortway(TCreature *Creature, int VisibleX, int VisibleY);
-	~TShortway(void);
+	TShortwayPoint *GetPoint(int X, int Y);
+	TShortwayPoint *GetSearchPoint(int X, int Y);
+	int GetWaypoints(TShortwayPoint *Node);
 	void FillMap(void);
-	void ClearMap(void);
+	void SiftUp(int Index);
+	void SiftDown(int Index);
+	void InsertToExpand(TShortwayPoint *Node);
+	TShortwayPoint *RemoveFirstToExpand(void);
 	void Expand(TShortwayPoint *Node);
 	bool Calculate(int DestX, int DestY, bool MustReach, int MaxSteps);
 
 	// DATA
 	// =================
-	matrix<TShortwayPoint> *Map;
-	TShortwayPoint *FirstToExpand;
+	TShortwayPoint *Map;
+	TShortwayPoint **ToExpand;
+	int ToExpandCount;
+	uint32 InsertCounter;
+	uint32 Generation;
 	TCreature *Creature;
 	int VisibleX;
 	int VisibleY;
@@ -47,7 +56,20 @@ struct TShortway{
 	int MinWaypoints;
 };
 
+static TShortwayPoint *ShortwayMap;
+static TShortwayPoint **ShortwayHeap;
+static int ShortwayMapSize;
+static uint32 ShortwayGeneration;
+
+static bool ExpandBefore(const TShortwayPoint *A, const TShortwayPoint *B){
+	return A->Heuristic < B->Heuristic
+		|| (A->Heuristic == B->Heuristic && A->InsertStamp > B->InsertStamp);
+}
+
 TShortway::TShortway(TCreature *Creature, int VisibleX, int VisibleY){
+	this->Map = NULL;
+	this->ToExpand = NULL;
+
 	if(Creature == NULL){
 		error("TShortway::TShortway: Übergebene Kreatur ist NULL.\n");
 		return;
@@ -58,71 +80,189 @@ TShortway::TShortway(TCreature *Creature, int VisibleX, int VisibleY){
 		return;
 	}
 
+	int MapSize = (2 * VisibleX + 3) * (2 * VisibleY + 3);
+	if(MapSize > ShortwayMapSize){
+		free(ShortwayMap);
+		free(ShortwayHeap);
+		ShortwayMap = (TShortwayPoint*)calloc(MapSize, sizeof(TShortwayPoint));
+		ShortwayHeap = (TShortwayPoint**)malloc(MapSize * sizeof(TShortwayPoint*));
+		ShortwayMapSize = MapSize;
+	}
+
+	this->Map = ShortwayMap;
+	this->ToExpand = ShortwayHeap;
+	this->ToExpandCount = 0;
+	this->InsertCounter = 0;
+	this->Generation = 0;
 	this->Creature = Creature;
 	this->VisibleX = VisibleX;
 	this->VisibleY = VisibleY;
 	this->StartX = Creature->posx;
 	this->StartY = Creature->posy;
 	this->StartZ = Creature->posz;
-	this->Map = new matrix<TShortwayPoint>(
-				-(VisibleX + 1), +(VisibleX + 1),
-				-(VisibleY + 1), +(VisibleY + 1));
 	this->FillMap();
 }
 
-TShortway::~TShortway(void){
-	if(this->Map != NULL){
-		delete this->Map;
-	}
+TShortwayPoint *TShortway::GetPoint(int X, int Y){
+	int SizeX = 2 * this->VisibleX + 3;
+	return &this->Map[(X + this->VisibleX + 1) + (Y + this->VisibleY + 1) * SizeX];
 }
 
-void TShortway::FillMap(void){
-	this->MinWaypoints = 1000;
+TShortwayPoint *TShortway::GetSearchPoint(int X, int Y){
+	TShortwayPoint *Node = this->GetPoint(X, Y);
+	if(Node->Generation != this->Generation){
+		Node->Waylength = INT_MAX;
+		Node->Heuristic = INT_MAX;
+		Node->HeapIndex = -1;
+		Node->Predecessor = NULL;
+		Node->Generation = this->Generation;
+	}
+	return Node;
+}
 
-	for(int X = -this->VisibleX; X <= this->VisibleX; X += 1)
-	for(int Y = -this->VisibleY; Y <= this->VisibleY; Y += 1){
-		int FieldX = this->StartX + X;
-		int FieldY = this->StartY + Y;
+int TShortway::GetWaypoints(TShortwayPoint *Node){
+	if(Node->Waypoints > 0 && Node->Passable == 0){
+		int FieldX = this->StartX + Node->x;
+		int FieldY = this->StartY + Node->y;
 		int FieldZ = this->StartZ;
+		if(this->Creature->MovePossible(FieldX, FieldY, FieldZ, false, false)){
+			Node->Passable = 1;
+		}else{
+			Node->Passable = -1;
+		}
+	}
 
-		int Waypoints = -1;
-		Object Obj = GetFirstObject(FieldX, FieldY, FieldZ);
-		if(Obj.exists()){
-			ObjectType ObjType = Obj.getObjectType();
-			if(ObjType.getFlag(BANK) && !ObjType.getFlag(UNPASS)){
-				Waypoints = (int)ObjType.getAttribute(WAYPOINTS);
-				if(Waypoints == 0){
-					error("TShortway::FillMap: Ungültiger Wegpunkte-Wert %d für Bank %d.\n",
-							Waypoints, ObjType.TypeID);
-					Waypoints = -1;
-				}
-
-				if(!this->Creature->MovePossible(FieldX, FieldY, FieldZ, false, false)){
-					Waypoints = -1;
-				}
+	return (Node->Passable >= 0) ? Node->Waypoints : -1;
+}
 
-				if(Waypoints > 0 && Waypoints < this->MinWaypoints){
-					this->MinWaypoints = Waypoints;
+void TShortway::FillMap(void){
+	for(int X = -(this->VisibleX + 1); X <= (this->VisibleX + 1); X += 1)
+	for(int Y = -(this->VisibleY + 1); Y <= (this->VisibleY + 1); Y += 1){
+		int Waypoints = -1;
+		if(std::abs(X) <= this->VisibleX && std::abs(Y) <= this->VisibleY){
+			int FieldX = this->StartX + X;
+			int FieldY = this->StartY + Y;
+			int FieldZ = this->StartZ;
+			Object Obj = GetFirstObject(FieldX, FieldY, FieldZ);
+			if(Obj.exists()){
+				ObjectType ObjType = Obj.getObjectType();
+				if(ObjType.getFlag(BANK) && !ObjType.getFlag(UNPASS)){
+					Waypoints = (int)ObjType.getAttribute(WAYPOINTS);
+					if(Waypoints == 0){
+						error("TShortway::FillMap: Ungültiger Wegpunkte-Wert %d für Bank %d.\n",
+								Waypoints, ObjType.TypeID);
+						Waypoints = -1;
+					}
 				}
 			}
 		}
 
-		TShortwayPoint *Node = this->Map->at(X, Y);
+		TShortwayPoint *Node = this->GetPoint(X, Y);
 		Node->x = X;
 		Node->y = Y;
 		Node->Waypoints = Waypoints;
+		Node->Passable = 0;
+	}
+
+	// NOTE(fusion): `MinWaypoints` is the smallest waypoints value of any field
+	// the creature could move onto. Instead of checking every field, check only
+	// fields with the smallest remaining value until one of them is passable.
+	this->MinWaypoints = 1000;
+	while(true){
+		int Candidate = this->MinWaypoints;
+		for(int X = -this->VisibleX; X <= this->VisibleX; X += 1)
+		for(int Y = -this->VisibleY; Y <= this->VisibleY; Y += 1){
+			TShortwayPoint *Node = this->GetPoint(X, Y);
+			if(Node->Waypoints > 0 && Node->Passable >= 0 && Node->Waypoints < Candidate){
+				Candidate = Node->Waypoints;
+			}
+		}
+
+		if(Candidate == this->MinWaypoints){
+			break;
+		}
+
+		for(int X = -this->VisibleX; X <= this->VisibleX; X += 1)
+		for(int Y = -this->VisibleY; Y <= this->VisibleY; Y += 1){
+			TShortwayPoint *Node = this->GetPoint(X, Y);
+			if(Node->Waypoints == Candidate && this->GetWaypoints(Node) != -1){
+				this->MinWaypoints = Candidate;
+				return;
+			}
+		}
 	}
 }
 
-void TShortway::ClearMap(void){
-	for(int X = -this->VisibleX; X <= this->VisibleX; X += 1)
-	for(int Y = -this->VisibleY; Y <= this->VisibleY; Y += 1){
-		TShortwayPoint *Node = this->Map->at(X, Y);
-		Node->Waylength = INT_MAX;
-		Node->Heuristic = INT_MAX;
-		Node->Predecessor = NULL;
-		Node->NextToExpand = NULL;
+void TShortway::SiftUp(int Index){
+	TShortwayPoint *Node = this->ToExpand[Index];
+	while(Index > 0){
+		int Parent = (Index - 1) / 2;
+		if(!ExpandBefore(Node, this->ToExpand[Parent])){
+			break;
+		}
+
+		this->ToExpand[Index] = this->ToExpand[Parent];
+		this->ToExpand[Index]->HeapIndex = Index;
+		Index = Parent;
+	}
+
+	this->ToExpand[Index] = Node;
+	Node->HeapIndex = Index;
+}
+
+void TShortway::SiftDown(int Index){
+	TShortwayPoint *Node = this->ToExpand[Index];
+	while(true){
+		int Child = Index * 2 + 1;
+		if(Child >= this->ToExpandCount){
+			break;
+		}
+
+		if((Child + 1) < this->ToExpandCount
+				&& ExpandBefore(this->ToExpand[Child + 1], this->ToExpand[Child])){
+			Child += 1;
+		}
+
+		if(!ExpandBefore(this->ToExpand[Child], Node)){
+			break;
+		}
+
+		this->ToExpand[Index] = this->ToExpand[Child];
+		this->ToExpand[Index]->HeapIndex = Index;
+		Index = Child;
 	}
+
+	this->ToExpand[Index] = Node;
+	Node->HeapIndex = Index;
+}
+
+void TShortway::InsertToExpand(TShortwayPoint *Node){
+	// NOTE(fusion): A node's heuristic can only decrease while it is waiting to
+	// be expanded, and it also becomes the most recent insertion, so moving it
+	// up is enough to update its position.
+	this->InsertCounter += 1;
+	Node->InsertStamp = this->InsertCounter;
+	if(Node->HeapIndex == -1){
+		Node->HeapIndex = this->ToExpandCount;
+		this->ToExpand[this->ToExpandCount] = Node;
+		this->ToExpandCount += 1;
+	}
+	this->SiftUp(Node->HeapIndex);
+}
+
+TShortwayPoint *TShortway::RemoveFirstToExpand(void){
+	if(this->ToExpandCount == 0){
+		return NULL;
+	}
+
+	TShortwayPoint *First = this->ToExpand[0];
+	First->HeapIndex = -1;
+	this->ToExpandCount -= 1;
+	if(this->ToExpandCount > 0){
+		this->ToExpand[0] = this->ToExpand[this->ToExpandCount];
+		this->SiftDown(0);
+	}
+	return First;
 }
 
 void TShortway::Expand(TShortwayPoint *Node){
@@ -131,10 +271,9 @@ void TShortway::Expand(TShortwayPoint *Node){
 		return;
 	}
 
-	this->FirstToExpand = Node->NextToExpand;
-
-	int MinNeighborWaylength = Node->Waylength + Node->Waypoints;
-	if(MinNeighborWaylength >= this->Map->at(0, 0)->Waylength){
+	int Waypoints = this->GetWaypoints(Node);
+	int MinNeighborWaylength = Node->Waylength + Waypoints;
+	if(MinNeighborWaylength >= this->GetSearchPoint(0, 0)->Waylength){
 		return;
 	}
 
@@ -144,36 +283,24 @@ void TShortway::Expand(TShortwayPoint *Node){
 			continue;
 		}
 
-		TShortwayPoint *Neighbor = this->Map->at(Node->x + OffsetX, Node->y + OffsetY);
+		TShortwayPoint *Neighbor = this->GetSearchPoint(Node->x + OffsetX, Node->y + OffsetY);
 
 		// NOTE(fusion): The minimum neighbor waylength already contains the cost
 		// of a single step. Diagonal steps are three times more expensive so we
 		// add waypoints two more times.
 		int NeighborWaylength = MinNeighborWaylength;
 		if(OffsetX != 0 && OffsetY != 0){
-			NeighborWaylength += Node->Waypoints * 2;
+			NeighborWaylength += Waypoints * 2;
 		}
 
 		if(NeighborWaylength < Neighbor->Waylength){
 			Neighbor->Waylength = NeighborWaylength;
 			Neighbor->Predecessor = Node;
-			if((Neighbor->x != 0 || Neighbor->y != 0) && Neighbor->Waypoints != -1){
-				// NOTE(fusion): Remove from expand list if it was already expanded upon.
-				if(Neighbor->Heuristic != INT_MAX){
-					TShortwayPoint *Prev = NULL;
-					TShortwayPoint *Cur = this->FirstToExpand;
-					while(Cur != NULL && Cur != Neighbor){
-						Prev = Cur;
-						Cur = Cur->NextToExpand;
-					}
-
-					if(Cur != Neighbor){
-						error("TShortway::Expand: Knoten steht nicht in der ExpandList.\n");
-					}else if(Prev == NULL){
-						this->FirstToExpand = Neighbor->NextToExpand;
-					}else{
-						Prev->NextToExpand = Neighbor->NextToExpand;
-					}
+			if((Neighbor->x != 0 || Neighbor->y != 0) && this->GetWaypoints(Neighbor) != -1){
+				// NOTE(fusion): A node that was already expanded upon is no longer
+				// in the expand list and is simply inserted again.
+				if(Neighbor->Heuristic != INT_MAX && Neighbor->HeapIndex == -1){
+					error("TShortway::Expand: Knoten steht nicht in der ExpandList.\n");
 				}
 
 				// NOTE(fusion): Compute heuristic using the manhattan distance.
@@ -181,23 +308,7 @@ void TShortway::Expand(TShortwayPoint *Node){
 				Neighbor->Heuristic = Neighbor->Waylength
 						+ Neighbor->Waypoints * 1
 						+ this->MinWaypoints * (Distance - 1);
-
-				// NOTE(fusion): Insert into expand list.
-				{
-					TShortwayPoint *Prev = NULL;
-					TShortwayPoint *Cur = this->FirstToExpand;
-					while(Cur != NULL && Cur->Heuristic < Neighbor->Heuristic){
-						Prev = Cur;
-						Cur = Cur->NextToExpand;
-					}
-
-					if(Prev == NULL){
-						this->FirstToExpand = Neighbor;
-					}else{
-						Prev->NextToExpand = Neighbor;
-					}
-					Neighbor->NextToExpand = Cur;
-				}
+				this->InsertToExpand(Neighbor);
 			}
 		}
 	}
@@ -223,16 +334,29 @@ bool TShortway::Calculate(int DestX, int DestY, bool MustReach, int MaxSteps){
 		return false;
 	}
 
+	// NOTE(fusion): Start a new search generation, which invalidates the search
+	// state of every node. Stamps are only cleared when the counter wraps.
+	ShortwayGeneration += 1;
+	if(ShortwayGeneration == 0){
+		for(int i = 0; i < ShortwayMapSize; i += 1){
+			ShortwayMap[i].Generation = 0;
+		}
+		ShortwayGeneration = 1;
+	}
+	this->Generation = ShortwayGeneration;
+	this->ToExpandCount = 0;
+	this->InsertCounter = 0;
+
 	// NOTE(fusion): Find shortest path from the destination to the origin.
-	this->ClearMap();
-	this->FirstToExpand = this->Map->at(DestX, DestY);
-	this->FirstToExpand->Waylength = 0;
-	while(this->FirstToExpand != NULL){
-		this->Expand(this->FirstToExpand);
+	TShortwayPoint *Dest = this->GetSearchPoint(DestX, DestY);
+	Dest->Waylength = 0;
+	this->InsertToExpand(Dest);
+	while(this->ToExpandCount > 0){
+		this->Expand(this->RemoveFirstToExpand());
 	}
 
 	// NOTE(fusion): Check if the origin was reached from the destination.
-	TShortwayPoint *Node = this->Map->at(0, 0);
+	TShortwayPoint *Node = this->GetSearchPoint(0, 0);
 	if(Node->Waylength == INT_MAX){
 		return false;
 	}
@@ -745,8 +869,7 @@ void TCreature::Execute(void){
 					SendSnapback(this->Connection);
 				}
 			}else{
-				this->NextWakeup = ServerMilliseconds + Delay;
-				ToDoQueue.insert(this->NextWakeup, this->ID);
+				this->ToDoWakeup(ServerMilliseconds + Delay);
 			}
 			break;
 		}
@@ -962,9 +1085,23 @@ void TCreature::ToDoStart(void){
 			Delay = 1;
 		}
 
-		uint32 NextWakeup = ServerMilliseconds + Delay;
-		ToDoQueue.insert(NextWakeup, this->ID);
-		this->NextWakeup = NextWakeup;
+		this->ToDoWakeup(ServerMilliseconds + Delay);
+	}
+}
+
+// NOTE(fusion): A creature only ever needs its latest wakeup, so scheduling a
+// new one replaces any that is still pending instead of leaving it in the queue
+// to be skipped by `Execute`.
+void TCreature::ToDoWakeup(uint32 Time){
+	this->ToDoCancelWakeup();
+	this->NextWakeup = Time;
+	this->WakeupTimer = ToDoQueue.insert(Time, this->ID);
+}
+
+void TCreature::ToDoCancelWakeup(void){
+	if(this->WakeupTimer != -1){
+		ToDoQueue.remove(this->WakeupTimer);
+		this->WakeupTimer = -1;
 	}
 }
 
@@ -1333,7 +1470,7 @@ void TCreature::NotifyGo(void){
 
 	int DestX, DestY, DestZ;
 	GetObjectCoordinates(this->CrObject, &DestX, &DestY, &DestZ);
-	MoveChainCreature(this, DestX, DestY);
+	MoveChainCreature(this, DestX, DestY, DestZ);
 
 	int OrigX = this->posx;
 	int OrigY = this->posy;
@@ -1394,6 +1531,10 @@ void TCreature::NotifyGo(void){
 	}
 
 	if(this->Type == PLAYER){
+		// NOTE(fusion): Have the reader thread load swapped out sectors around
+		// the player before they're actually accessed.
+		PrefetchSectors(DestX, DestY, DestZ);
+
 		// NOTE(fusion): Check open containers.
 		for(int ContainerNr = 0;
 				ContainerNr < NARRAY(TPlayer::OpenContainer);
@@ -1486,7 +1627,7 @@ void TCreature::NotifyTurn(Object DestCon){
 }
 
 void TCreature::NotifyCreate(void){
-    InsertChainCreature(this, 0, 0);
+	InsertChainCreature(this, this->posx, this->posy, this->posz);
 }
 
 void TCreature::NotifyDelete(void){
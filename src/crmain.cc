@@ -9,14 +9,21 @@
 #include <dirent.h>
 
 TRaceData RaceData[MAX_RACES];
-priority_queue<uint32, uint32> ToDoQueue(5000, 1000);
+timing_wheel<uint32> ToDoQueue(5000, 1000);
 
 static TCreature *HashList[1000];
-static matrix<uint32> *FirstChainCreature;
+static matrix3d<uint32> *FirstChainCreature;
+static uint64 ChainStampCounter;
 static vector<TCreature*> CreatureList(0, 10000, 1000, NULL);
 static int FirstFreeCreature;
+static vector<TCreature*> SkillCreatureList(0, 1000, 1000, NULL);
+static int FirstFreeSkillCreature;
 static uint32 NextCreatureID;
 
+static int SkillRounds;
+static int SkillTicks;
+static int SkillMaxTicks;
+
 static int KilledCreatures[MAX_RACES];
 static int KilledPlayers[MAX_RACES];
 
@@ -24,8 +31,19 @@ static priority_queue<uint32, TAttackWave*> AttackWaveQueue(100, 100);
 
 // TFindCreatures
 // =============================================================================
+// NOTE(fusion): Creatures are chained per 16x16 block and floor. Each creature
+// carries the stamp of when it entered its block, and each chain is ordered by
+// it, newest first. Merging the chains of a block by stamp gives the same order
+// as the old single chain per block did, so searches return the same creatures
+// in the same order, while searches restricted to a range of floors don't have
+// to visit creatures on any other floor.
 TFindCreatures::TFindCreatures(int RadiusX, int RadiusY, int CenterX, int CenterY, int Mask){
-	this->initSearch(RadiusX, RadiusY, CenterX, CenterY, Mask);
+	this->initSearch(RadiusX, RadiusY, CenterX, CenterY, SectorZMin, SectorZMax, Mask);
+}
+
+TFindCreatures::TFindCreatures(int RadiusX, int RadiusY, int CenterX, int CenterY,
+		int MinZ, int MaxZ, int Mask){
+	this->initSearch(RadiusX, RadiusY, CenterX, CenterY, MinZ, MaxZ, Mask);
 }
 
 TFindCreatures::TFindCreatures(int RadiusX, int RadiusY, uint32 CreatureID, int Mask){
@@ -36,7 +54,7 @@ TFindCreatures::TFindCreatures(int RadiusX, int RadiusY, uint32 CreatureID, int
 		return;
 	}
 
-	this->initSearch(RadiusX, RadiusY, Creature->posx, Creature->posy, Mask);
+	this->initSearch(RadiusX, RadiusY, Creature->posx, Creature->posy, SectorZMin, SectorZMax, Mask);
 	this->SkipID = Creature->ID;
 }
 
@@ -49,23 +67,48 @@ TFindCreatures::TFindCreatures(int RadiusX, int RadiusY, Object Obj, int Mask){
 
 	int ObjX, ObjY, ObjZ;
 	GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
-	this->initSearch(RadiusX, RadiusY, ObjX, ObjY, Mask);
+	this->initSearch(RadiusX, RadiusY, ObjX, ObjY, SectorZMin, SectorZMax, Mask);
 }
 
-void TFindCreatures::initSearch(int RadiusX, int RadiusY, int CenterX, int CenterY, int Mask){
+void TFindCreatures::initSearch(int RadiusX, int RadiusY, int CenterX, int CenterY,
+		int MinZ, int MaxZ, int Mask){
 	this->startx = CenterX - RadiusX;
 	this->starty = CenterY - RadiusY;
 	this->endx = CenterX + RadiusX;
 	this->endy = CenterY + RadiusY;
+	this->minz = std::max<int>(MinZ, SectorZMin);
+	this->maxz = std::min<int>(MaxZ, SectorZMax);
 	// NOTE(fusion): See `TFindCreatures::getNext` for an explanation on the -1.
 	this->blockx = (this->startx / 16) - 1;
 	this->blocky = (this->starty / 16);
-	this->ActID = 0;
+	for(int i = 0; i < MAX_CHAIN_FLOORS; i += 1){
+		this->ActID[i] = 0;
+		this->ActStamp[i] = 0;
+	}
 	this->SkipID = 0;
 	this->Mask = Mask;
 	this->finished = false;
 }
 
+void TFindCreatures::loadBlock(void){
+	for(int FloorZ = this->minz; FloorZ <= this->maxz; FloorZ += 1){
+		int Floor = FloorZ - this->minz;
+		this->ActID[Floor] = 0;
+
+		uint32 *FirstID = FirstChainCreature->boundedAt(this->blockx, this->blocky, FloorZ);
+		if(FirstID != NULL && *FirstID != 0){
+			TCreature *Creature = GetCreature(*FirstID);
+			if(Creature == NULL){
+				error("TFindCreatures::loadBlock: Kreatur existiert nicht.\n");
+				continue;
+			}
+
+			this->ActID[Floor] = Creature->ID;
+			this->ActStamp[Floor] = Creature->ChainStamp;
+		}
+	}
+}
+
 uint32 TFindCreatures::getNext(void){
 	if(this->finished){
 		return 0;
@@ -74,8 +117,16 @@ uint32 TFindCreatures::getNext(void){
 	int StartBlockX = this->startx / 16;
 	int EndBlockX = this->endx / 16;
 	int EndBlockY = this->endy / 16;
+	int Floors = this->maxz - this->minz + 1;
 	while(true){
-		while(this->ActID == 0){
+		int Floor = -1;
+		for(int i = 0; i < Floors; i += 1){
+			if(this->ActID[i] != 0 && (Floor == -1 || this->ActStamp[i] > this->ActStamp[Floor])){
+				Floor = i;
+			}
+		}
+
+		if(Floor == -1){
 			this->blockx += 1;
 			if(this->blockx > EndBlockX){
 				this->blockx = StartBlockX;
@@ -86,22 +137,28 @@ uint32 TFindCreatures::getNext(void){
 				}
 			}
 
-			uint32 *FirstID = FirstChainCreature->boundedAt(this->blockx, this->blocky);
-			if(FirstID != NULL){
-				this->ActID = *FirstID;
-			}else{
-				this->ActID = 0;
-			}
+			this->loadBlock();
+			continue;
 		}
 
-		TCreature *Creature = GetCreature(this->ActID);
+		TCreature *Creature = GetCreature(this->ActID[Floor]);
 		if(Creature == NULL){
 			error("TFindCreatures::getNext: Kreatur existiert nicht.\n");
-			this->ActID = 0;
+			this->ActID[Floor] = 0;
 			continue;
 		}
 
-		this->ActID = Creature->NextChainCreature;
+		this->ActID[Floor] = 0;
+		if(Creature->NextChainCreature != 0){
+			TCreature *Next = GetCreature(Creature->NextChainCreature);
+			if(Next == NULL){
+				error("TFindCreatures::getNext: Kreatur existiert nicht.\n");
+			}else{
+				this->ActID[Floor] = Next->ID;
+				this->ActStamp[Floor] = Next->ChainStamp;
+			}
+		}
+
 		if(Creature->ID == this->SkipID
 				|| Creature->posx < this->startx || Creature->posx > this->endx
 				|| Creature->posy < this->starty || Creature->posy > this->endy
@@ -125,7 +182,10 @@ TCreature::TCreature(void) :
 	this->Combat.Master = this;
 	this->ID = 0;
 	this->NextHashEntry = NULL;
-	this->NextChainCreature =  0;
+	this->PrevChainCreature = 0;
+	this->NextChainCreature = 0;
+	this->ChainStamp = 0;
+	this->SkillListIndex = -1;
 	this->Name[0] = 0;
 	this->Murderer[0] = 0;
 	this->OrgOutfit = {};
@@ -161,6 +221,7 @@ TCreature::TCreature(void) :
 	this->ActToDo = 0;
 	this->NrToDo = 0;
 	this->NextWakeup = 0;
+	this->WakeupTimer = -1;
 	this->Stop = false;
 	this->LockToDo = false;
 	this->Connection = NULL;
@@ -263,12 +324,14 @@ TCreature::~TCreature(void){
 	}
 
 	this->ToDoClear();
+	this->ToDoCancelWakeup();
 
 	if(this->Type == PLAYER && this->Connection != NULL){
 		this->Connection->Logout(30, true);
 	}
 
 	this->DelInCrList();
+	this->DelInSkillList();
 
 	if(this->ID != 0){
 		this->DelID();
@@ -369,6 +432,30 @@ void TCreature::DelInCrList(void){
 	}
 }
 
+// NOTE(fusion): Creatures with running skill timers are kept in a separate list
+// so `ProcessSkills` doesn't have to go through all creatures each round. They
+// are added by `TSkillBase::SetTimer` and only taken out by `ProcessSkills` once
+// their last timer has expired, or when they're destroyed.
+void TCreature::SetInSkillList(void){
+	if(this->SkillListIndex == -1){
+		this->SkillListIndex = FirstFreeSkillCreature;
+		*SkillCreatureList.at(FirstFreeSkillCreature) = this;
+		FirstFreeSkillCreature += 1;
+	}
+}
+
+void TCreature::DelInSkillList(void){
+	int Index = this->SkillListIndex;
+	if(Index != -1){
+		TCreature *Last = *SkillCreatureList.at(FirstFreeSkillCreature - 1);
+		*SkillCreatureList.at(Index) = Last;
+		Last->SkillListIndex = Index;
+		*SkillCreatureList.at(FirstFreeSkillCreature - 1) = NULL;
+		FirstFreeSkillCreature -= 1;
+		this->SkillListIndex = -1;
+	}
+}
+
 void TCreature::StartLogout(bool Force, bool StopFight){
 	this->LoggingOut = true;
 	if(Force || LagDetected()){
@@ -956,7 +1043,57 @@ TCreature *GetCreature(Object Obj){
 	return GetCreature(Obj.getCreatureID());
 }
 
-void InsertChainCreature(TCreature *Creature, int CoordX, int CoordY){
+// NOTE(fusion): Returns the range of floors from which `FloorZ` can be seen,
+// according to `TCreature::CanSeeFloor`.
+void GetSpectatorFloors(int FloorZ, int *MinZ, int *MaxZ){
+	if(FloorZ <= 7){
+		*MinZ = 0;
+		*MaxZ = std::max<int>(7, FloorZ + 2);
+	}else{
+		*MinZ = std::max<int>(8, FloorZ - 2);
+		*MaxZ = FloorZ + 2;
+	}
+}
+
+static void LinkChainCreature(TCreature *Creature, int CoordX, int CoordY, int CoordZ){
+	// NOTE(fusion): Chains are ordered by stamp, newest first, so a creature
+	// that entered its block just now goes to the front. A creature that only
+	// changed floors keeps its stamp and has to be put back in order.
+	int ChainX = CoordX / 16;
+	int ChainY = CoordY / 16;
+	uint32 *FirstID = FirstChainCreature->at(ChainX, ChainY, CoordZ);
+	uint32 PrevID = 0;
+	uint32 NextID = *FirstID;
+	while(NextID != 0){
+		TCreature *Next = GetCreature(NextID);
+		if(Next == NULL){
+			error("LinkChainCreature: Kreatur existiert nicht.\n");
+			NextID = 0;
+			break;
+		}
+
+		if(Next->ChainStamp < Creature->ChainStamp){
+			break;
+		}
+
+		PrevID = NextID;
+		NextID = Next->NextChainCreature;
+	}
+
+	Creature->PrevChainCreature = PrevID;
+	Creature->NextChainCreature = NextID;
+	if(PrevID == 0){
+		*FirstID = Creature->ID;
+	}else{
+		GetCreature(PrevID)->NextChainCreature = Creature->ID;
+	}
+
+	if(NextID != 0){
+		GetCreature(NextID)->PrevChainCreature = Creature->ID;
+	}
+}
+
+void InsertChainCreature(TCreature *Creature, int CoordX, int CoordY, int CoordZ){
 	if(Creature == NULL){
 		// TODO(fusion): Maybe a typo on the name of the function? I thought it
 		// could be some type of macro because there was no function name mismatch
@@ -965,19 +1102,9 @@ void InsertChainCreature(TCreature *Creature, int CoordX, int CoordY){
 		return;
 	}
 
-	if(CoordX == 0){
-		CoordX = Creature->posx;
-	}
-
-	if(CoordY == 0){
-		CoordY = Creature->posy;
-	}
-
-	int ChainX = CoordX / 16;
-	int ChainY = CoordY / 16;
-	uint32 *FirstID = FirstChainCreature->at(ChainX, ChainY);
-	Creature->NextChainCreature = *FirstID;
-	*FirstID = Creature->ID;
+	ChainStampCounter += 1;
+	Creature->ChainStamp = ChainStampCounter;
+	LinkChainCreature(Creature, CoordX, CoordY, CoordZ);
 }
 
 void DeleteChainCreature(TCreature *Creature){
@@ -986,40 +1113,38 @@ void DeleteChainCreature(TCreature *Creature){
 		return;
 	}
 
-	// NOTE(fusion): All creatures in each 16x16 region form a creature linked
-	// list, despite its current floor. Whether that is a good idea is a whole
-	// other matter.
 	int ChainX = Creature->posx / 16;
 	int ChainY = Creature->posy / 16;
-	uint32 *FirstID = FirstChainCreature->at(ChainX, ChainY);
-
-	if(*FirstID == Creature->ID){
+	uint32 *FirstID = FirstChainCreature->at(ChainX, ChainY, Creature->posz);
+	if(Creature->PrevChainCreature == 0){
+		if(*FirstID != Creature->ID){
+			error("DeleteChainCreature: Kreatur nicht gefunden.\n");
+			return;
+		}
 		*FirstID = Creature->NextChainCreature;
 	}else{
-		uint32 CurrentID = *FirstID;
-		while(true){
-			if(CurrentID == 0){
-				error("DeleteChainCreature: Kreatur nicht gefunden.\n");
-				return;
-			}
-
-			TCreature *Current = GetCreature(CurrentID);
-			if(Current == NULL){
-				error("DeleteChainCreature: Kreatur existiert nicht.\n");
-				return;
-			}
-
-			if(Current->NextChainCreature == Creature->ID){
-				Current->NextChainCreature = Creature->NextChainCreature;
-				break;
-			}
+		TCreature *Prev = GetCreature(Creature->PrevChainCreature);
+		if(Prev == NULL){
+			error("DeleteChainCreature: Kreatur existiert nicht.\n");
+			return;
+		}
+		Prev->NextChainCreature = Creature->NextChainCreature;
+	}
 
-			CurrentID = Current->NextChainCreature;
+	if(Creature->NextChainCreature != 0){
+		TCreature *Next = GetCreature(Creature->NextChainCreature);
+		if(Next == NULL){
+			error("DeleteChainCreature: Kreatur existiert nicht.\n");
+		}else{
+			Next->PrevChainCreature = Creature->PrevChainCreature;
 		}
 	}
+
+	Creature->PrevChainCreature = 0;
+	Creature->NextChainCreature = 0;
 }
 
-void MoveChainCreature(TCreature *Creature, int CoordX, int CoordY){
+void MoveChainCreature(TCreature *Creature, int CoordX, int CoordY, int CoordZ){
 	if(Creature == NULL){
 		error("DeleteChainCreature: Übegebene Kreatur existiert nicht.\n");
 		return;
@@ -1032,7 +1157,10 @@ void MoveChainCreature(TCreature *Creature, int CoordX, int CoordY){
 
 	if(NewChainX != OldChainX || NewChainY != OldChainY){
 		DeleteChainCreature(Creature);
-		InsertChainCreature(Creature, CoordX, CoordY);
+		InsertChainCreature(Creature, CoordX, CoordY, CoordZ);
+	}else if(CoordZ != Creature->posz){
+		DeleteChainCreature(Creature);
+		LinkChainCreature(Creature, CoordX, CoordY, CoordZ);
 	}
 }
 
@@ -1092,30 +1220,51 @@ void ProcessCreatures(void){
 }
 
 void ProcessSkills(void){
-	for(int Index = 0; Index < FirstFreeCreature; Index += 1){
-		TCreature *Creature = *CreatureList.at(Index);
+	int Ticks = 0;
+	int Index = 0;
+	while(Index < FirstFreeSkillCreature){
+		TCreature *Creature = *SkillCreatureList.at(Index);
 		if(Creature == NULL){
 			error("ProcessSkills: Kreatur %d existiert nicht.\n", Index);
-			continue;
+			break;
 		}
 
+		Ticks += Creature->FirstFreeTimer;
 		Creature->ProcessSkills();
+
+		// NOTE(fusion): Same swap and pop as in `ProcessCreatures`, so the
+		// current index has to be processed again.
+		if(Creature->FirstFreeTimer == 0){
+			Creature->DelInSkillList();
+		}else{
+			Index += 1;
+		}
+	}
+
+	SkillRounds += 1;
+	SkillTicks += Ticks;
+	if(SkillMaxTicks < Ticks){
+		SkillMaxTicks = Ticks;
+	}
+}
+
+void SkillSummary(void){
+	if(SkillRounds > 0){
+		Log("game", "%d Skill-Ticks in %d Runden (%d max, %d Kreaturen mit Timern).\n",
+				SkillTicks, SkillRounds, SkillMaxTicks, FirstFreeSkillCreature);
 	}
+	SkillRounds = 0;
+	SkillTicks = 0;
+	SkillMaxTicks = 0;
 }
 
 void MoveCreatures(int Delay){
 	ServerMilliseconds += Delay;
-	while(ToDoQueue.Entries > 0){
-		auto Entry = *ToDoQueue.Entry->at(1);
-		uint32 ExecutionTime = Entry.Key;
-		uint32 CreatureID = Entry.Data;
-		if(ExecutionTime > ServerMilliseconds){
-			break;
-		}
-
-		ToDoQueue.deleteMin();
+	uint32 CreatureID;
+	while(ToDoQueue.next(ServerMilliseconds, &CreatureID)){
 		TCreature *Creature = GetCreature(CreatureID);
 		if(Creature != NULL){
+			Creature->WakeupTimer = -1;
 			Creature->Execute();
 		}
 	}
@@ -2117,10 +2266,18 @@ void ProcessMonsterRaids(void){
 void InitCr(void){
 	NextCreatureID = 0x40000000;
 	FirstFreeCreature = 0;
-	FirstChainCreature = new matrix<uint32>(
+	FirstFreeSkillCreature = 0;
+	if((SectorZMax - SectorZMin + 1) > MAX_CHAIN_FLOORS){
+		error("InitCr: Zu viele Stockwerke (%d..%d).\n", SectorZMin, SectorZMax);
+		throw "too many floors";
+	}
+
+	FirstChainCreature = new matrix3d<uint32>(
 				SectorXMin * 2, SectorXMax * 2 + 1,
 				SectorYMin * 2, SectorYMax * 2 + 1,
+				SectorZMin, SectorZMax,
 				0);
+	ChainStampCounter = 0;
 
 	LoadRaces();
 	LoadMonsterRaids();
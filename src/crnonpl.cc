@@ -225,6 +225,8 @@ TBehaviour::TBehaviour(void) :
 {
 	this->Conditions = 0;
 	this->Actions = 0;
+	this->Keyword = -1;
+	this->NextBehaviour = -1;
 }
 
 TBehaviour::~TBehaviour(void){
@@ -269,11 +271,15 @@ void TBehaviour::operator=(const TBehaviour &Other){
 	for(int i = 0; i < Other.Actions; i += 1){
 		*this->Action.at(i) = Other.Action.copyAt(i);
 	}
+
+	this->Keyword = Other.Keyword;
+	this->NextBehaviour = Other.NextBehaviour;
 }
 
 
 TBehaviourDatabase::TBehaviourDatabase(TReadScriptFile *Script) :
-		Behaviour(0, 50, 25)
+		Behaviour(0, 50, 25),
+		Keyword(0, 50, 25)
 {
 	this->Behaviours = 0;
 	Script->readSymbol('{');
@@ -521,6 +527,8 @@ TBehaviourDatabase::TBehaviourDatabase(TReadScriptFile *Script) :
 
 		this->Behaviours += 1;
 	}
+
+	this->indexKeywords();
 }
 
 TBehaviourNode *TBehaviourDatabase::readValue(TReadScriptFile *Script){
@@ -836,6 +844,91 @@ int TBehaviourDatabase::evaluate(TNPC *Npc, TBehaviourNode *Node, int *Parameter
 	return Result;
 }
 
+// NOTE(fusion): Random numbers and unset parameters (which log an error) are the
+// only things an expression can do besides computing a value.
+static bool IsPureBehaviourNode(TBehaviourNode *Node){
+	if(Node == NULL){
+		return true;
+	}
+
+	if(Node->Type == BEHAVIOUR_NODE_RANDOM || Node->Type == BEHAVIOUR_NODE_PARAMETER){
+		return false;
+	}
+
+	return IsPureBehaviourNode(Node->Left) && IsPureBehaviourNode(Node->Right);
+}
+
+void TBehaviourDatabase::indexKeywords(void){
+	for(int i = 0; i < NARRAY(this->FirstKeyword); i += 1){
+		this->FirstKeyword[i] = -1;
+	}
+	this->Keywords = 0;
+	this->FirstGenericBehaviour = -1;
+	this->MatchStamp = 0;
+
+	// NOTE(fusion): A behaviour is skipped when its keyword isn't in the text, so
+	// everything before the keyword must fail or pass without leaving any trace.
+	// Behaviours are prepended in reverse so chains end up ascending.
+	for(int BehaviourNr = this->Behaviours - 1;
+			BehaviourNr >= 0;
+			BehaviourNr -= 1){
+		TBehaviour *Behaviour = this->Behaviour.at(BehaviourNr);
+		TBehaviourCondition *KeywordCondition = NULL;
+		for(int ConditionNr = 0;
+				ConditionNr < Behaviour->Conditions;
+				ConditionNr += 1){
+			TBehaviourCondition *Condition = Behaviour->Condition.at(ConditionNr);
+			if(Condition->Type == BEHAVIOUR_CONDITION_TEXT){
+				KeywordCondition = Condition;
+				break;
+			}else if(Condition->Type != BEHAVIOUR_CONDITION_PROPERTY
+					&& (Condition->Type != BEHAVIOUR_CONDITION_EXPRESSION
+						|| !IsPureBehaviourNode(Condition->Expression))){
+				break;
+			}
+		}
+
+		const char *Pattern = NULL;
+		if(KeywordCondition != NULL){
+			Pattern = GetDynamicString(KeywordCondition->Text);
+			if(Pattern == NULL || Pattern[0] == 0 || strcmp(Pattern, "$") == 0){
+				Pattern = NULL;
+			}
+		}
+
+		if(Pattern == NULL){
+			Behaviour->Keyword = -1;
+			Behaviour->NextBehaviour = this->FirstGenericBehaviour;
+			this->FirstGenericBehaviour = BehaviourNr;
+			continue;
+		}
+
+		int KeywordNr = 0;
+		while(KeywordNr < this->Keywords){
+			TBehaviourKeyword *Keyword = this->Keyword.at(KeywordNr);
+			if(stricmp(GetDynamicString(Keyword->Text), Pattern) == 0){
+				break;
+			}
+			KeywordNr += 1;
+		}
+
+		TBehaviourKeyword *Keyword = this->Keyword.at(KeywordNr);
+		if(KeywordNr == this->Keywords){
+			uint8 First = (uint8)toLower(Pattern[0]);
+			Keyword->Text = KeywordCondition->Text;
+			Keyword->FirstBehaviour = -1;
+			Keyword->NextKeyword = this->FirstKeyword[First];
+			Keyword->MatchStamp = 0;
+			this->FirstKeyword[First] = KeywordNr;
+			this->Keywords += 1;
+		}
+
+		Behaviour->Keyword = KeywordNr;
+		Behaviour->NextBehaviour = Keyword->FirstBehaviour;
+		Keyword->FirstBehaviour = BehaviourNr;
+	}
+}
+
 // NOTE(fusion): These smaller functions were inside `TBehaviourDatabase::react`
 // but I figured it would be better to pull them out for readability.
 static bool CheckBehaviourProperty(int Property, SITUATION Situation, TPlayer *Interlocutor){
@@ -989,12 +1082,77 @@ void TBehaviourDatabase::react(TNPC *Npc, const char *Text, SITUATION Situation)
 		return;
 	}
 
+	// NOTE(fusion): Collect the behaviour chains of all keywords found at any word
+	// start in `Text`, the same places `SearchForWord` would look at. Merging them
+	// with the generic chain visits behaviours in their original order, minus
+	// those that would fail on their keyword anyway. If there are too many chains
+	// we simply go through all behaviours.
+	this->MatchStamp += 1;
+	if(this->MatchStamp == 0){
+		for(int KeywordNr = 0; KeywordNr < this->Keywords; KeywordNr += 1){
+			this->Keyword.at(KeywordNr)->MatchStamp = 0;
+		}
+		this->MatchStamp = 1;
+	}
+
+	int Chain[32];
+	int Chains = 0;
+	bool FullScan = false;
+	if(this->FirstGenericBehaviour != -1){
+		Chain[Chains] = this->FirstGenericBehaviour;
+		Chains += 1;
+	}
+
+	bool WordStart = true;
+	for(int i = 0; Text[i] != 0 && !FullScan; i += 1){
+		if(!isAlpha(Text[i]) && !isDigit(Text[i])){
+			WordStart = true;
+		}else if(WordStart){
+			int KeywordNr = this->FirstKeyword[(uint8)toLower(Text[i])];
+			while(KeywordNr != -1){
+				TBehaviourKeyword *Keyword = this->Keyword.at(KeywordNr);
+				if(Keyword->MatchStamp != this->MatchStamp
+						&& MatchWordAt(GetDynamicString(Keyword->Text), &Text[i])){
+					Keyword->MatchStamp = this->MatchStamp;
+					if(Chains >= NARRAY(Chain)){
+						FullScan = true;
+						break;
+					}
+					Chain[Chains] = Keyword->FirstBehaviour;
+					Chains += 1;
+				}
+				KeywordNr = Keyword->NextKeyword;
+			}
+			WordStart = false;
+		}
+	}
+
 	int Parameters[2] = {-1, -1};
 	int BestMatch = -1;
 	int MaxConditions = -1;
-	for(int BehaviourNr = 0;
-			BehaviourNr < this->Behaviours;
-			BehaviourNr += 1){
+	int BehaviourNr = -1;
+	while(true){
+		if(FullScan){
+			BehaviourNr += 1;
+			if(BehaviourNr >= this->Behaviours){
+				break;
+			}
+		}else{
+			int Next = -1;
+			for(int i = 0; i < Chains; i += 1){
+				if(Chain[i] != -1 && (Next == -1 || Chain[i] < Chain[Next])){
+					Next = i;
+				}
+			}
+
+			if(Next == -1){
+				break;
+			}
+
+			BehaviourNr = Chain[Next];
+			Chain[Next] = this->Behaviour.at(BehaviourNr)->NextBehaviour;
+		}
+
 		TBehaviour *Behaviour = this->Behaviour.at(BehaviourNr);
 		bool Match = true;
 		bool ShortCircuit = false;
@@ -1082,7 +1240,7 @@ void TBehaviourDatabase::react(TNPC *Npc, const char *Text, SITUATION Situation)
 	bool Repeat = false;
 	bool StartToDo = false;
 	int TalkDelay = 1000;
-	int BehaviourNr = BestMatch;
+	BehaviourNr = BestMatch;
 	do{
 		Repeat = false;
 		TBehaviour *Behaviour = this->Behaviour.at(BehaviourNr);
@@ -1411,7 +1569,9 @@ void ProcessMonsterhomes(void){
 			MaxRadius = 10;
 		}
 
-		TFindCreatures Search(MaxRadius + 9, MaxRadius + 7, MH->x, MH->y, FIND_PLAYERS);
+		int MinZ, MaxZ;
+		GetSpectatorFloors(MH->z, &MinZ, &MaxZ);
+		TFindCreatures Search(MaxRadius + 9, MaxRadius + 7, MH->x, MH->y, MinZ, MaxZ, FIND_PLAYERS);
 		while(true){
 			uint32 CharacterID = Search.getNext();
 			if(CharacterID == 0){
@@ -12,13 +12,86 @@ static Semaphore PlayerMutex(1);
 static vector<TPlayer*> PlayerList(0, 100, 10, NULL);
 static int FirstFreePlayer;
 
-static Semaphore PlayerDataPoolMutex(1);
+// NOTE(fusion): Online players are also chained into a hash table keyed on
+// their case folded name, so exact name lookups don't have to walk the whole
+// `PlayerList`. It is modified together with `PlayerList`, under `PlayerMutex`.
+constexpr int PLAYER_NAME_HASH_SIZE = 4096;
+static TPlayer *PlayerNameHash[PLAYER_NAME_HASH_SIZE];
+
+// NOTE(fusion): Pool slots are found through a hash index on `CharacterID`,
+// chained through `PlayerDataPoolNext`. Both are only touched while holding
+// `PlayerDataPoolMutex`, and threads waiting for a locked slot sleep on
+// `PlayerDataPoolReleased` until whoever holds it lets go.
+constexpr int PLAYER_POOL_HASH_SIZE = 4096;
+
+// NOTE(fusion): Slots written by the snapshot process are locked with this
+// pseudo thread id until the snapshot is over, so they can't be modified, saved,
+// or reused in the meantime. See `StartSnapshotSave` in main.cc.
+constexpr pid_t SNAPSHOT_LOCK = -1;
+
+static pthread_mutex_t PlayerDataPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t PlayerDataPoolReleased = PTHREAD_COND_INITIALIZER;
 static TPlayerData PlayerDataPool[2000];
+static int PlayerDataPoolHash[PLAYER_POOL_HASH_SIZE];
+static int PlayerDataPoolNext[NARRAY(PlayerDataPool)];
+static int PlayerPoolLookups;
+static int PlayerPoolProbes;
+static int PlayerPoolWaits;
+static uint64 PlayerPoolWaitTime;
+static uint64 PlayerPoolMaxWaitTime;
+static TSnapshotWaitFunction *SnapshotWaitFunction;
 
 static TPlayerIndexInternalNode PlayerIndexHead;
 static store<TPlayerIndexInternalNode, 100> PlayerIndexInternalNodes;
 static store<TPlayerIndexLeafNode, 100> PlayerIndexLeafNodes;
 
+// Player Name Hash
+// =============================================================================
+static int GetPlayerNameHashIndex(const char *Name, int Length){
+	// NOTE(fusion): FNV-1a over the name folded with `toLower`, the same way
+	// `stricmp` compares it.
+	uint32 Hash = 2166136261U;
+	for(int i = 0; i < Length && Name[i] != 0; i += 1){
+		Hash ^= (uint32)(uint8)toLower(Name[i]);
+		Hash *= 16777619U;
+	}
+	return (int)(Hash & (PLAYER_NAME_HASH_SIZE - 1));
+}
+
+static void InsertPlayerName(TPlayer *Player){
+	int HashIndex = GetPlayerNameHashIndex(Player->Name, (int)strlen(Player->Name));
+	Player->NextNameHash = PlayerNameHash[HashIndex];
+	PlayerNameHash[HashIndex] = Player;
+}
+
+static bool RemovePlayerName(TPlayer *Player){
+	int HashIndex = GetPlayerNameHashIndex(Player->Name, (int)strlen(Player->Name));
+	TPlayer **Link = &PlayerNameHash[HashIndex];
+	while(*Link != NULL){
+		if(*Link == Player){
+			*Link = Player->NextNameHash;
+			Player->NextNameHash = NULL;
+			return true;
+		}
+		Link = &(*Link)->NextNameHash;
+	}
+	return false;
+}
+
+// NOTE(fusion): Looks for the online player whose whole name matches the first
+// `Length` characters of `Name`, ignoring case.
+static TPlayer *FindPlayerName(const char *Name, int Length){
+	TPlayer *Player = PlayerNameHash[GetPlayerNameHashIndex(Name, Length)];
+	while(Player != NULL){
+		if(stricmp(Player->Name, Name, Length) == 0
+				&& (int)strlen(Player->Name) == Length){
+			break;
+		}
+		Player = Player->NextNameHash;
+	}
+	return Player;
+}
+
 // TPlayer
 // =============================================================================
 TPlayer::TPlayer(TConnection *Connection, uint32 CharacterID):
@@ -39,6 +112,7 @@ TPlayer::TPlayer(TConnection *Connection, uint32 CharacterID):
 	this->DepotSpace = 0;
 	this->ConstructError = NOERROR;
 	this->PlayerData = NULL;
+	this->NextNameHash = NULL;
 	this->TradeObject = NONE;
 	this->TradePartner = 0;
 	this->TradeAccepted = false;
@@ -428,6 +502,7 @@ void TPlayer::SetInList(void){
 	PlayerMutex.down();
 	*PlayerList.at(FirstFreePlayer) = this;
 	FirstFreePlayer += 1;
+	InsertPlayerName(this);
 	PlayerMutex.up();
 
 	NotifyBuddies(this->ID, this->Name, true);
@@ -449,6 +524,7 @@ void TPlayer::DelInList(void){
 			FirstFreePlayer -= 1;
 			*PlayerList.at(Index) = *PlayerList.at(FirstFreePlayer);
 			*PlayerList.at(FirstFreePlayer) = NULL;
+			RemovePlayerName(this);
 			PlayerMutex.up();
 
 			DecrementPlayersOnline();
@@ -752,7 +828,9 @@ void TPlayer::TakeOver(TConnection *Connection){
 	this->Connection = Connection;
 	Connection->EnterGame();
 
+	pthread_mutex_lock(&PlayerDataPoolMutex);
 	TPlayerData *PlayerData = GetPlayerPoolSlot(this->ID);
+	pthread_mutex_unlock(&PlayerDataPoolMutex);
 	if(PlayerData == NULL){
 		error("TPlayer::TakeOver: PlayerData-Slot nicht gefunden.\n");
 		return;
@@ -768,7 +846,15 @@ void TPlayer::TakeOver(TConnection *Connection){
 		error("TPlayer::TakeOver: Falscher Sticky-Wert %d.\n", PlayerData->Sticky);
 	}
 
-	strcpy(this->Name, PlayerData->Name);
+	if(strcmp(this->Name, PlayerData->Name) != 0){
+		PlayerMutex.down();
+		bool Listed = RemovePlayerName(this);
+		strcpy(this->Name, PlayerData->Name);
+		if(Listed){
+			InsertPlayerName(this);
+		}
+		PlayerMutex.up();
+	}
 	InsertPlayerIndex(&PlayerIndexHead, 0, this->Name, this->ID);
 	strcpy(this->IPAddress, Connection->GetIPAddress());
 	memcpy(this->Rights, PlayerData->Rights, sizeof(this->Rights));
@@ -1821,15 +1907,7 @@ TPlayer *GetPlayer(uint32 CharacterID){
 }
 
 TPlayer *GetPlayer(const char *Name){
-	TPlayer *Result = NULL;
-	for(int Index = 0; Index < FirstFreePlayer; Index += 1){
-		TPlayer *Player = *PlayerList.at(Index);
-		if(stricmp(Player->Name, Name) == 0){
-			Result = Player;
-			break;
-		}
-	}
-	return Result;
+	return FindPlayerName(Name, (int)strlen(Name));
 }
 
 bool IsPlayerOnline(const char *Name){
@@ -1861,21 +1939,28 @@ int IdentifyPlayer(const char *Name, bool ExactMatch, bool IgnoreGamemasters, TP
 		}
 	}
 
+	TPlayer *Exact = FindPlayerName(Name, NameLength);
+	if(Exact != NULL){
+		*OutPlayer = Exact;
+		return 0; // FOUND ?
+	}
+
+	if(ExactMatch){
+		return -1; // NOTFOUND ?
+	}
+
+	// NOTE(fusion): There is no exact match at this point, so any name that
+	// matches is strictly longer than the one given.
 	int Hits = 0;
 	for(int Index = 0; Index < FirstFreePlayer; Index += 1){
 		TPlayer *Player = *PlayerList.at(Index);
 		if(stricmp(Player->Name, Name, NameLength) == 0){
-			if(NameLength == (int)strlen(Player->Name)){
-				*OutPlayer = Player;
-				return 0; // FOUND ?
-			}else if(!ExactMatch){
-				if(IgnoreGamemasters && CheckRight(Player->ID, NO_STATISTICS)){
-					continue;
-				}
-
-				*OutPlayer = Player;
-				Hits += 1;
+			if(IgnoreGamemasters && CheckRight(Player->ID, NO_STATISTICS)){
+				continue;
 			}
+
+			*OutPlayer = Player;
+			Hits += 1;
 		}
 	}
 
@@ -2151,33 +2236,68 @@ void SendExistingRequests(TConnection *Connection){
 
 // Player Loader
 // =============================================================================
+// NOTE(fusion): Player data is stored as a binary image in ".busr" files next
+// to the ".usr" text files. The image is preferred for as long as it is at
+// least as new as the text file, so operators can still edit or drop in a text
+// file, which is then picked up on the next login and written back as an image.
+// With `PlayerDataFormat = text` in the config, saves go to the text files
+// instead, which converts characters back as they're saved.
+//	The image layout, all numbers in little endian:
+//
+//	uint32	Magic				PLAYER_IMAGE_MAGIC
+//	uint16	Version				PLAYER_IMAGE_VERSION
+//	uint32	CharacterID
+//	uint32	PayloadSize
+//	uint32	Checksum			(FNV-1a of the payload)
+//	payload:
+//		string	Name
+//		uint32	Race, Profession
+//		outfit	OriginalOutfit, CurrentOutfit		(uint32 OutfitID, uint32 Type/Colors)
+//		uint32	LastLogin, LastLogout
+//		uint32	StartX, StartY, StartZ, PosX, PosY, PosZ
+//		uint32	PlayerkillerEnd
+//		uint8	Skills, then per skill uint8 SkillNr and 14 uint32 values
+//		uint16	Spells, then per spell uint8 SpellNr
+//		uint16	Quests, then per quest uint16 QuestNr and uint32 Value
+//		uint16	Races, then per race uint16 Race and uint32 Kills
+//		uint8	Murders, then per murder uint32 Timestamp
+//		uint32	InventorySize, uint8 Inventory[InventorySize]
+//		uint8	Depots, then per depot uint8 DepotNr, uint32 Size, uint8 Content[Size]
+//
+//	Inventory and depots are the same object streams we keep in memory (see
+// `LoadObjects`), so they're copied as is.
+constexpr uint32 PLAYER_IMAGE_MAGIC = 0x52535542; // "BUSR"
+constexpr uint16 PLAYER_IMAGE_VERSION = 1;
+constexpr int PLAYER_IMAGE_HEADER_SIZE = 18;
+
 void PlayerDataPath(char *Buffer, int BufferSize, uint32 CharacterID){
 	snprintf(Buffer, BufferSize, "%s/%02u/%u.usr",
 			USERPATH, (CharacterID % 100), CharacterID);
 }
 
+void PlayerImagePath(char *Buffer, int BufferSize, uint32 CharacterID){
+	snprintf(Buffer, BufferSize, "%s/%02u/%u.busr",
+			USERPATH, (CharacterID % 100), CharacterID);
+}
+
 bool PlayerDataExists(uint32 CharacterID){
 	char FileName[4096];
+	PlayerImagePath(FileName, sizeof(FileName), CharacterID);
+	if(FileExists(FileName)){
+		return true;
+	}
+
 	PlayerDataPath(FileName, sizeof(FileName), CharacterID);
 	return FileExists(FileName);
 }
 
-bool LoadPlayerData(TPlayerData *Slot){
-	if(Slot == NULL){
-		error("LoadPlayerData: Slot ist NULL.\n");
-		return false;
-	}
-
-	if(Slot->CharacterID == 0){
-		error("LoadPlayerData: Slot enthält keinen Charakter.\n");
-		return false;
-	}
-
-	// IMPORTANT(fusion): This function is only called from `AssignPlayerPoolSlot`
-	// which zero initializes it before hand. Note that it would be a problem
-	// otherwise, since we shouldn't write to `CharacterID`, `Locked`, or `Sticky`
-	// outside a critical section, making `memset` not viable and turning this
-	// into an assignment fiesta for no good reason.
+static void ClearPlayerData(TPlayerData *Slot){
+	// IMPORTANT(fusion): This function is only called from `LoadPlayerData`
+	// which is only called from `AssignPlayerPoolSlot` which zero initializes
+	// it before hand. Note that it would be a problem otherwise, since we
+	// shouldn't write to `CharacterID`, `Locked`, or `Sticky` outside a critical
+	// section, making `memset` not viable and turning this into an assignment
+	// fiesta for no good reason. It's called again only to undo a failed load.
 	Slot->Race = 1;
 	Slot->Profession = PROFESSION_NONE;
 	for(int SkillNr = 0;
@@ -2187,13 +2307,380 @@ bool LoadPlayerData(TPlayerData *Slot){
 		Slot->Minimum[SkillNr] = INT_MIN;
 	}
 
-	// NOTE(fusion): First login. Use defaults.
+	memset(Slot->SpellList, 0, sizeof(Slot->SpellList));
+	memset(Slot->QuestValues, 0, sizeof(Slot->QuestValues));
+	memset(Slot->MonsterKills, 0, sizeof(Slot->MonsterKills));
+	memset(Slot->MurderTimestamps, 0, sizeof(Slot->MurderTimestamps));
+
+	delete[] Slot->Inventory;
+	Slot->Inventory = NULL;
+	Slot->InventorySize = 0;
+
+	for(int DepotNr = 0; DepotNr < MAX_DEPOTS; DepotNr += 1){
+		delete[] Slot->Depot[DepotNr];
+		Slot->Depot[DepotNr] = NULL;
+		Slot->DepotSize[DepotNr] = 0;
+	}
+}
+
+static uint32 PlayerImageChecksum(const uint8 *Data, int Size){
+	uint32 Checksum = 2166136261U;
+	for(int i = 0; i < Size; i += 1){
+		Checksum ^= Data[i];
+		Checksum *= 16777619U;
+	}
+	return Checksum;
+}
+
+static void WritePlayerImageOutfit(TWriteStream *Image, TOutfit Outfit){
+	Image->writeQuad((uint32)Outfit.OutfitID);
+	if(Outfit.OutfitID == 0){
+		Image->writeQuad((uint32)Outfit.ObjectType);
+	}else{
+		Image->writeBytes(Outfit.Colors, sizeof(Outfit.Colors));
+	}
+}
+
+static TOutfit ReadPlayerImageOutfit(TReadBuffer *Image){
+	TOutfit Outfit = {};
+	Outfit.OutfitID = (int)Image->readQuad();
+	if(Outfit.OutfitID == 0){
+		Outfit.ObjectType = (int)Image->readQuad();
+	}else{
+		Image->readBytes(Outfit.Colors, sizeof(Outfit.Colors));
+	}
+	return Outfit;
+}
+
+static void WritePlayerImageObjects(TWriteStream *Image, const uint8 *Data, int Size){
+	Image->writeQuad((uint32)Size);
+	if(Size > 0){
+		Image->writeBytes(Data, Size);
+	}
+}
+
+static uint8 *ReadPlayerImageObjects(TReadBuffer *Image, int *Size){
+	int ObjectsSize = (int)Image->readQuad();
+	if(ObjectsSize < 0 || ObjectsSize > (Image->Size - Image->Position)){
+		throw "corrupt player image";
+	}
+
+	uint8 *Objects = NULL;
+	if(ObjectsSize > 0){
+		Objects = new uint8[ObjectsSize];
+		Image->readBytes(Objects, ObjectsSize);
+	}
+	*Size = ObjectsSize;
+	return Objects;
+}
+
+static void WritePlayerImage(TWriteStream *Image, TPlayerData *Slot){
+	Image->writeString(Slot->Name);
+	Image->writeQuad((uint32)Slot->Race);
+	Image->writeQuad((uint32)Slot->Profession);
+	WritePlayerImageOutfit(Image, Slot->OriginalOutfit);
+	WritePlayerImageOutfit(Image, Slot->CurrentOutfit);
+	Image->writeQuad((uint32)Slot->LastLoginTime);
+	Image->writeQuad((uint32)Slot->LastLogoutTime);
+	Image->writeQuad((uint32)Slot->startx);
+	Image->writeQuad((uint32)Slot->starty);
+	Image->writeQuad((uint32)Slot->startz);
+	Image->writeQuad((uint32)Slot->posx);
+	Image->writeQuad((uint32)Slot->posy);
+	Image->writeQuad((uint32)Slot->posz);
+	Image->writeQuad((uint32)Slot->PlayerkillerEnd);
+
+	int Skills = 0;
+	for(int SkillNr = 0; SkillNr < NARRAY(Slot->Minimum); SkillNr += 1){
+		if(Slot->Minimum[SkillNr] != INT_MIN){
+			Skills += 1;
+		}
+	}
+
+	Image->writeByte((uint8)Skills);
+	for(int SkillNr = 0; SkillNr < NARRAY(Slot->Minimum); SkillNr += 1){
+		if(Slot->Minimum[SkillNr] == INT_MIN){
+			continue;
+		}
+
+		Image->writeByte((uint8)SkillNr);
+		Image->writeQuad((uint32)Slot->Actual[SkillNr]);
+		Image->writeQuad((uint32)Slot->Maximum[SkillNr]);
+		Image->writeQuad((uint32)Slot->Minimum[SkillNr]);
+		Image->writeQuad((uint32)Slot->DeltaAct[SkillNr]);
+		Image->writeQuad((uint32)Slot->MagicDeltaAct[SkillNr]);
+		Image->writeQuad((uint32)Slot->Cycle[SkillNr]);
+		Image->writeQuad((uint32)Slot->MaxCycle[SkillNr]);
+		Image->writeQuad((uint32)Slot->Count[SkillNr]);
+		Image->writeQuad((uint32)Slot->MaxCount[SkillNr]);
+		Image->writeQuad((uint32)Slot->AddLevel[SkillNr]);
+		Image->writeQuad((uint32)Slot->Experience[SkillNr]);
+		Image->writeQuad((uint32)Slot->FactorPercent[SkillNr]);
+		Image->writeQuad((uint32)Slot->NextLevel[SkillNr]);
+		Image->writeQuad((uint32)Slot->Delta[SkillNr]);
+	}
+
+	int Spells = 0;
+	for(int SpellNr = 0; SpellNr < NARRAY(Slot->SpellList); SpellNr += 1){
+		if(Slot->SpellList[SpellNr] != 0){
+			Spells += 1;
+		}
+	}
+
+	Image->writeWord((uint16)Spells);
+	for(int SpellNr = 0; SpellNr < NARRAY(Slot->SpellList); SpellNr += 1){
+		if(Slot->SpellList[SpellNr] != 0){
+			Image->writeByte((uint8)SpellNr);
+		}
+	}
+
+	int Quests = 0;
+	for(int QuestNr = 0; QuestNr < NARRAY(Slot->QuestValues); QuestNr += 1){
+		if(Slot->QuestValues[QuestNr] != 0){
+			Quests += 1;
+		}
+	}
+
+	Image->writeWord((uint16)Quests);
+	for(int QuestNr = 0; QuestNr < NARRAY(Slot->QuestValues); QuestNr += 1){
+		if(Slot->QuestValues[QuestNr] != 0){
+			Image->writeWord((uint16)QuestNr);
+			Image->writeQuad((uint32)Slot->QuestValues[QuestNr]);
+		}
+	}
+
+	int Races = 0;
+	for(int Race = 0; Race < NARRAY(Slot->MonsterKills); Race += 1){
+		if(Slot->MonsterKills[Race] != 0){
+			Races += 1;
+		}
+	}
+
+	Image->writeWord((uint16)Races);
+	for(int Race = 0; Race < NARRAY(Slot->MonsterKills); Race += 1){
+		if(Slot->MonsterKills[Race] != 0){
+			Image->writeWord((uint16)Race);
+			Image->writeQuad((uint32)Slot->MonsterKills[Race]);
+		}
+	}
+
+	// NOTE(fusion): Save murder timestamps for up to a month, same as the text
+	// format.
+	int Murders = 0;
+	int Now = (int)time(NULL);
+	for(int i = 0; i < NARRAY(Slot->MurderTimestamps); i += 1){
+		if((Now - Slot->MurderTimestamps[i]) < (30 * 24 * 60 * 60)){
+			Murders += 1;
+		}
+	}
+
+	Image->writeByte((uint8)Murders);
+	for(int i = 0; i < NARRAY(Slot->MurderTimestamps); i += 1){
+		if((Now - Slot->MurderTimestamps[i]) < (30 * 24 * 60 * 60)){
+			Image->writeQuad((uint32)Slot->MurderTimestamps[i]);
+		}
+	}
+
+	// NOTE(fusion): An empty inventory still has its terminator, which is also
+	// what the text loader produces for "Inventory = {}".
+	if(Slot->Inventory != NULL){
+		WritePlayerImageObjects(Image, Slot->Inventory, Slot->InventorySize);
+	}else{
+		uint8 EmptyInventory = 0xFF;
+		WritePlayerImageObjects(Image, &EmptyInventory, 1);
+	}
+
+	int Depots = 0;
+	for(int DepotNr = 0; DepotNr < MAX_DEPOTS; DepotNr += 1){
+		if(Slot->Depot[DepotNr] != NULL){
+			Depots += 1;
+		}
+	}
+
+	Image->writeByte((uint8)Depots);
+	for(int DepotNr = 0; DepotNr < MAX_DEPOTS; DepotNr += 1){
+		if(Slot->Depot[DepotNr] != NULL){
+			Image->writeByte((uint8)DepotNr);
+			WritePlayerImageObjects(Image, Slot->Depot[DepotNr], Slot->DepotSize[DepotNr]);
+		}
+	}
+}
+
+static void ReadPlayerImage(TReadBuffer *Image, TPlayerData *Slot){
+	Image->readString(Slot->Name, sizeof(Slot->Name));
+	Slot->Race = (int)Image->readQuad();
+	Slot->Profession = (int)Image->readQuad();
+	Slot->OriginalOutfit = ReadPlayerImageOutfit(Image);
+	Slot->CurrentOutfit = ReadPlayerImageOutfit(Image);
+	Slot->LastLoginTime = (time_t)(int)Image->readQuad();
+	Slot->LastLogoutTime = (time_t)(int)Image->readQuad();
+	Slot->startx = (int)Image->readQuad();
+	Slot->starty = (int)Image->readQuad();
+	Slot->startz = (int)Image->readQuad();
+	Slot->posx = (int)Image->readQuad();
+	Slot->posy = (int)Image->readQuad();
+	Slot->posz = (int)Image->readQuad();
+	Slot->PlayerkillerEnd = (int)Image->readQuad();
+
+	int Skills = (int)Image->readByte();
+	for(int i = 0; i < Skills; i += 1){
+		int SkillNr = (int)Image->readByte();
+		if(SkillNr >= NARRAY(Slot->Minimum)){
+			throw "illegal skill number";
+		}
+
+		Slot->Actual[SkillNr] = (int)Image->readQuad();
+		Slot->Maximum[SkillNr] = (int)Image->readQuad();
+		Slot->Minimum[SkillNr] = (int)Image->readQuad();
+		Slot->DeltaAct[SkillNr] = (int)Image->readQuad();
+		Slot->MagicDeltaAct[SkillNr] = (int)Image->readQuad();
+		Slot->Cycle[SkillNr] = (int)Image->readQuad();
+		Slot->MaxCycle[SkillNr] = (int)Image->readQuad();
+		Slot->Count[SkillNr] = (int)Image->readQuad();
+		Slot->MaxCount[SkillNr] = (int)Image->readQuad();
+		Slot->AddLevel[SkillNr] = (int)Image->readQuad();
+		Slot->Experience[SkillNr] = (int)Image->readQuad();
+		Slot->FactorPercent[SkillNr] = (int)Image->readQuad();
+		Slot->NextLevel[SkillNr] = (int)Image->readQuad();
+		Slot->Delta[SkillNr] = (int)Image->readQuad();
+	}
+
+	int Spells = (int)Image->readWord();
+	for(int i = 0; i < Spells; i += 1){
+		int SpellNr = (int)Image->readByte();
+		Slot->SpellList[SpellNr] = 1;
+	}
+
+	int Quests = (int)Image->readWord();
+	for(int i = 0; i < Quests; i += 1){
+		int QuestNr = (int)Image->readWord();
+		if(QuestNr >= NARRAY(Slot->QuestValues)){
+			throw "illegal quest number";
+		}
+		Slot->QuestValues[QuestNr] = (int)Image->readQuad();
+	}
+
+	int Races = (int)Image->readWord();
+	for(int i = 0; i < Races; i += 1){
+		int Race = (int)Image->readWord();
+		if(Race >= NARRAY(Slot->MonsterKills)){
+			throw "illegal race number";
+		}
+		Slot->MonsterKills[Race] = (int)Image->readQuad();
+	}
+
+	int Murders = (int)Image->readByte();
+	if(Murders > NARRAY(Slot->MurderTimestamps)){
+		throw "too many murders";
+	}
+
+	int FirstMurder = NARRAY(Slot->MurderTimestamps) - Murders;
+	for(int i = 0; i < Murders; i += 1){
+		Slot->MurderTimestamps[FirstMurder + i] = (int)Image->readQuad();
+	}
+
+	Slot->Inventory = ReadPlayerImageObjects(Image, &Slot->InventorySize);
+	if(Slot->Inventory == NULL){
+		throw "missing inventory";
+	}
+
+	int Depots = (int)Image->readByte();
+	for(int i = 0; i < Depots; i += 1){
+		int DepotNr = (int)Image->readByte();
+		if(DepotNr >= MAX_DEPOTS || Slot->Depot[DepotNr] != NULL){
+			throw "illegal depot number";
+		}
+
+		Slot->Depot[DepotNr] = ReadPlayerImageObjects(Image, &Slot->DepotSize[DepotNr]);
+	}
+}
+
+static bool LoadPlayerImage(TPlayerData *Slot, const char *FileName){
+	uint8 *Data = NULL;
+	bool Result = false;
+	try{
+		TReadBinaryFile File;
+		File.open(FileName);
+		int Size = File.getSize();
+		if(Size < PLAYER_IMAGE_HEADER_SIZE){
+			File.error("player image too small");
+		}
+		Data = new uint8[Size];
+		File.readBytes(Data, Size);
+		File.close();
+
+		TReadBuffer Image(Data, Size);
+		if(Image.readQuad() != PLAYER_IMAGE_MAGIC){
+			throw "invalid player image";
+		}
+
+		if(Image.readWord() != PLAYER_IMAGE_VERSION){
+			throw "unsupported player image version";
+		}
+
+		if(Image.readQuad() != Slot->CharacterID){
+			throw "player image character mismatch";
+		}
+
+		int PayloadSize = (int)Image.readQuad();
+		uint32 Checksum = Image.readQuad();
+		if(PayloadSize != (Image.Size - Image.Position)){
+			throw "player image size mismatch";
+		}
+
+		if(Checksum != PlayerImageChecksum(&Image.Data[Image.Position], PayloadSize)){
+			throw "player image checksum mismatch";
+		}
+
+		ReadPlayerImage(&Image, Slot);
+		if(!Image.eof()){
+			throw "trailing data in player image";
+		}
+
+		Result = true;
+	}catch(const char *str){
+		error("LoadPlayerData: Kann Abbild des Spielers %u nicht laden.\n",
+				Slot->CharacterID);
+		error("# Fehler: %s\n", str);
+	}catch(const std::bad_alloc &e){
+		error("LoadPlayerData: Kein Speicher frei beim Laden von Spieler %u.\n",
+				Slot->CharacterID);
+	}
+
+	delete[] Data;
+	return Result;
+}
+
+static bool SavePlayerImage(TPlayerData *Slot){
+	bool Result = false;
 	char FileName[4096];
-	PlayerDataPath(FileName, sizeof(FileName), Slot->CharacterID);
-	if(!FileExists(FileName)){
-		return true;
+	char TempFileName[4096];
+	PlayerImagePath(FileName, sizeof(FileName), Slot->CharacterID);
+	snprintf(TempFileName, sizeof(TempFileName), "%s.tmp", FileName);
+	try{
+		TDynamicWriteBuffer Payload(KB(16));
+		WritePlayerImage(&Payload, Slot);
+
+		TWriteBinaryFile File;
+		File.open(TempFileName);
+		File.writeQuad(PLAYER_IMAGE_MAGIC);
+		File.writeWord(PLAYER_IMAGE_VERSION);
+		File.writeQuad(Slot->CharacterID);
+		File.writeQuad((uint32)Payload.Position);
+		File.writeQuad(PlayerImageChecksum(Payload.Data, Payload.Position));
+		File.writeBytes(Payload.Data, Payload.Position);
+		File.close();
+		ReplaceFile(TempFileName, FileName);
+		Result = true;
+	}catch(const char *str){
+		error("SavePlayerData: Kann Abbild des Spielers %u nicht schreiben.\n", Slot->CharacterID);
+		error("# Fehler: %s\n", str);
+		unlink(TempFileName);
 	}
+	return Result;
+}
 
+static bool LoadPlayerText(TPlayerData *Slot, const char *FileName){
 	bool Result = false;
 	try{
 		// TODO(fusion): Same thing as house loaders. Data is expected to be in
@@ -2448,35 +2935,71 @@ bool LoadPlayerData(TPlayerData *Slot){
 				Slot->CharacterID);
 	}
 
-	if(!Result){
-		delete[] Slot->Inventory;
-		Slot->Inventory = NULL;
-		Slot->InventorySize = 0;
-
-		for(int DepotNr = 0; DepotNr < MAX_DEPOTS; DepotNr += 1){
-			delete[] Slot->Depot[DepotNr];
-			Slot->Depot[DepotNr] = NULL;
-			Slot->DepotSize[DepotNr] = 0;
-		}
-	}
-
 	return Result;
 }
 
-void SavePlayerData(TPlayerData *Slot){
+bool LoadPlayerData(TPlayerData *Slot){
 	if(Slot == NULL){
-		error("SavePlayerData: Slot ist NULL.\n");
-		return;
+		error("LoadPlayerData: Slot ist NULL.\n");
+		return false;
 	}
 
 	if(Slot->CharacterID == 0){
-		error("SavePlayerData: Slot enthält keinen Charakter.\n");
-		return;
+		error("LoadPlayerData: Slot enthält keinen Charakter.\n");
+		return false;
+	}
+
+	ClearPlayerData(Slot);
+
+	char FileName[4096];
+	char ImageFileName[4096];
+	timespec TextTime, ImageTime;
+	PlayerDataPath(FileName, sizeof(FileName), Slot->CharacterID);
+	PlayerImagePath(ImageFileName, sizeof(ImageFileName), Slot->CharacterID);
+	bool HasText = GetFileModificationTime(FileName, &TextTime);
+	bool HasImage = GetFileModificationTime(ImageFileName, &ImageTime);
+
+	// NOTE(fusion): First login. Use defaults.
+	if(!HasText && !HasImage){
+		return true;
+	}
+
+	bool UseImage = HasImage
+		&& (!HasText
+			|| ImageTime.tv_sec > TextTime.tv_sec
+			|| (ImageTime.tv_sec == TextTime.tv_sec
+				&& ImageTime.tv_nsec >= TextTime.tv_nsec));
+
+	uint64 StartTime = GetMonotonicMicroseconds();
+	bool Result = false;
+	if(UseImage){
+		Result = LoadPlayerImage(Slot, ImageFileName);
+		if(!Result && HasText){
+			error("LoadPlayerData: Verwende Textdatei für Spieler %u.\n",
+					Slot->CharacterID);
+			ClearPlayerData(Slot);
+			UseImage = false;
+		}
+	}
+
+	if(!UseImage){
+		Result = LoadPlayerText(Slot, FileName);
 	}
 
+	if(!Result){
+		ClearPlayerData(Slot);
+	}
+
+	print(3, "Daten für Spieler %u in %u us geladen (%s).\n", Slot->CharacterID,
+			(uint32)(GetMonotonicMicroseconds() - StartTime), (UseImage ? "busr" : "usr"));
+	return Result;
+}
+
+static bool SavePlayerText(TPlayerData *Slot){
 	// TODO(fusion): This is prone to problems if we don't backup user files.
 	// Even if we did automatic backups, would only this user get rolled back?
 	// This is probably one of the sources of whole day rollbacks.
+	bool Result = false;
 	char FileName[4096];
 	PlayerDataPath(FileName, sizeof(FileName), Slot->CharacterID);
 	try{
@@ -2687,30 +3210,123 @@ void SavePlayerData(TPlayerData *Slot){
 		Script.writeText("}");
 		Script.writeLn();
 		Script.close();
-
+		Result = true;
 	}catch(const char *str){
 		error("SavePlayerData: Kann Gegenstände des Spielers %u nicht schreiben.\n", Slot->CharacterID);
 		error("# Fehler: %s\n", str);
 		unlink(FileName);
 	}
+	return Result;
+}
+
+bool SavePlayerData(TPlayerData *Slot){
+	if(Slot == NULL){
+		error("SavePlayerData: Slot ist NULL.\n");
+		return false;
+	}
+
+	if(Slot->CharacterID == 0){
+		error("SavePlayerData: Slot enthält keinen Charakter.\n");
+		return false;
+	}
+
+	uint64 StartTime = GetMonotonicMicroseconds();
+	bool Result;
+	if(BinaryPlayerData){
+		Result = SavePlayerImage(Slot);
+	}else{
+		Result = SavePlayerText(Slot);
+	}
+
+	if(Result){
+		print(3, "Daten für Spieler %u in %u us gespeichert (%s).\n", Slot->CharacterID,
+				(uint32)(GetMonotonicMicroseconds() - StartTime), (BinaryPlayerData ? "busr" : "usr"));
+	}
+	return Result;
 }
 
 void UnlinkPlayerData(uint32 CharacterID){
 	char FileName[4096];
 	PlayerDataPath(FileName, sizeof(FileName), CharacterID);
 	unlink(FileName);
+	PlayerImagePath(FileName, sizeof(FileName), CharacterID);
+	unlink(FileName);
 }
 
 // Player Pool
 // =============================================================================
+static int GetPlayerPoolHashIndex(uint32 CharacterID){
+	return (int)(CharacterID & (PLAYER_POOL_HASH_SIZE - 1));
+}
+
+static void InsertPlayerPoolSlot(TPlayerData *Slot){
+	int SlotIndex = (int)(Slot - PlayerDataPool);
+	int HashIndex = GetPlayerPoolHashIndex(Slot->CharacterID);
+	PlayerDataPoolNext[SlotIndex] = PlayerDataPoolHash[HashIndex];
+	PlayerDataPoolHash[HashIndex] = SlotIndex;
+}
+
+static void RemovePlayerPoolSlot(TPlayerData *Slot){
+	int SlotIndex = (int)(Slot - PlayerDataPool);
+	int *Link = &PlayerDataPoolHash[GetPlayerPoolHashIndex(Slot->CharacterID)];
+	while(*Link != -1){
+		if(*Link == SlotIndex){
+			*Link = PlayerDataPoolNext[SlotIndex];
+			PlayerDataPoolNext[SlotIndex] = -1;
+			return;
+		}
+		Link = &PlayerDataPoolNext[*Link];
+	}
+
+	error("RemovePlayerPoolSlot: Slot von Charakter %u nicht im Index.\n", Slot->CharacterID);
+}
+
+// NOTE(fusion): Waits on `PlayerDataPoolReleased`. The mutex must be held and
+// the caller has to look its slot up again afterwards, since it may have been
+// freed or reused in the meantime.
+static void WaitPlayerPoolSlot(void){
+	uint64 StartTime = GetMonotonicMicroseconds();
+	pthread_cond_wait(&PlayerDataPoolReleased, &PlayerDataPoolMutex);
+	uint64 Time = GetMonotonicMicroseconds() - StartTime;
+	PlayerPoolWaits += 1;
+	PlayerPoolWaitTime += Time;
+	if(PlayerPoolMaxWaitTime < Time){
+		PlayerPoolMaxWaitTime = Time;
+	}
+}
+
+// NOTE(fusion): Snapshot locks are only released by the game thread, once it
+// notices the snapshot process is done, so the game thread must never sleep on
+// such a slot. It finishes the snapshot through `SnapshotWaitFunction` instead,
+// which may take until the snapshot timeout. Returns false if the caller should
+// wait as usual. The mutex must be held and is released in the meantime.
+static bool WaitPlayerPoolSnapshot(TPlayerData *Slot){
+	if(Slot->Locked != SNAPSHOT_LOCK
+			|| SnapshotWaitFunction == NULL
+			|| gettid() != GetGameThreadID()){
+		return false;
+	}
+
+	print(2, "Slot von Charakter %u ist für Schnappschuss gesperrt.\n", Slot->CharacterID);
+	pthread_mutex_unlock(&PlayerDataPoolMutex);
+	SnapshotWaitFunction();
+	pthread_mutex_lock(&PlayerDataPoolMutex);
+	return true;
+}
+
+void SetSnapshotWaitFunction(TSnapshotWaitFunction *Function){
+	SnapshotWaitFunction = Function;
+}
+
 void SavePlayerPoolSlot(TPlayerData *Slot){
 	if(Slot == NULL){
 		error("SavePlayerPoolSlot: Slot existiert nicht.\n");
 		return;
 	}
 
-	if(Slot->Dirty){
-		SavePlayerData(Slot);
+	// NOTE(fusion): Keep the slot dirty if it couldn't be saved, so it is tried
+	// again with the next save.
+	if(Slot->Dirty && SavePlayerData(Slot)){
 		Slot->Dirty = false;
 	}
 }
@@ -2746,9 +3362,11 @@ void FreePlayerPoolSlot(TPlayerData *Slot){
 		delete[] Slot->Depot[DepotNr];
 	}
 
+	RemovePlayerPoolSlot(Slot);
 	Slot->CharacterID = 0;
 }
 
+// NOTE(fusion): The caller must hold `PlayerDataPoolMutex`.
 TPlayerData *GetPlayerPoolSlot(uint32 CharacterID){
 	if(CharacterID == 0){
 		error("GetPlayerPoolSlot: CharacterID ist Null.\n");
@@ -2756,11 +3374,15 @@ TPlayerData *GetPlayerPoolSlot(uint32 CharacterID){
 	}
 
 	TPlayerData *Slot = NULL;
-	for(int i = 0; i < NARRAY(PlayerDataPool); i += 1){
-		if(PlayerDataPool[i].CharacterID == CharacterID){
-			Slot = &PlayerDataPool[i];
+	int SlotIndex = PlayerDataPoolHash[GetPlayerPoolHashIndex(CharacterID)];
+	PlayerPoolLookups += 1;
+	while(SlotIndex != -1){
+		PlayerPoolProbes += 1;
+		if(PlayerDataPool[SlotIndex].CharacterID == CharacterID){
+			Slot = &PlayerDataPool[SlotIndex];
 			break;
 		}
+		SlotIndex = PlayerDataPoolNext[SlotIndex];
 	}
 	return Slot;
 }
@@ -2777,8 +3399,8 @@ TPlayerData *AssignPlayerPoolSlot(uint32 CharacterID, bool DontWait){
 	// with some guard class.
 
 	TPlayerData *Slot = NULL;
+	pthread_mutex_lock(&PlayerDataPoolMutex);
 	while(true){
-		PlayerDataPoolMutex.down();
 		Slot = GetPlayerPoolSlot(CharacterID);
 		if(Slot == NULL){
 			break;
@@ -2786,18 +3408,19 @@ TPlayerData *AssignPlayerPoolSlot(uint32 CharacterID, bool DontWait){
 
 		if(Slot->Locked == 0){
 			Slot->Locked = gettid();
-			PlayerDataPoolMutex.up();
+			pthread_mutex_unlock(&PlayerDataPoolMutex);
 			return Slot;
 		}
 
 		if(DontWait){
 			Slot->Sticky += 1;
-			PlayerDataPoolMutex.up();
+			pthread_mutex_unlock(&PlayerDataPoolMutex);
 			return Slot;
 		}
 
-		PlayerDataPoolMutex.up();
-		DelayThread(0, 100);
+		if(!WaitPlayerPoolSnapshot(Slot)){
+			WaitPlayerPoolSlot();
+		}
 	}
 
 	// NOTE(fusion): Player data for `CharacterID` isn't loaded so we need to
@@ -2838,7 +3461,7 @@ TPlayerData *AssignPlayerPoolSlot(uint32 CharacterID, bool DontWait){
 	}
 
 	if(Slot == NULL){
-		PlayerDataPoolMutex.up();
+		pthread_mutex_unlock(&PlayerDataPoolMutex);
 		error("AssignPlayerPoolSlot: Kein Slot mehr frei.\n");
 		return NULL;
 	}
@@ -2846,7 +3469,8 @@ TPlayerData *AssignPlayerPoolSlot(uint32 CharacterID, bool DontWait){
 	memset(Slot, 0, sizeof(TPlayerData));
 	Slot->CharacterID = CharacterID;
 	Slot->Locked = gettid();
-	PlayerDataPoolMutex.up();
+	InsertPlayerPoolSlot(Slot);
+	pthread_mutex_unlock(&PlayerDataPoolMutex);
 
 	print(3, "Lade Daten für Spieler %u.\n", CharacterID);
 
@@ -2855,8 +3479,12 @@ TPlayerData *AssignPlayerPoolSlot(uint32 CharacterID, bool DontWait){
 	}
 
 	if(!LoadPlayerData(Slot)){
+		pthread_mutex_lock(&PlayerDataPoolMutex);
+		RemovePlayerPoolSlot(Slot);
 		Slot->CharacterID = 0;
 		Slot->Locked = 0;
+		pthread_cond_broadcast(&PlayerDataPoolReleased);
+		pthread_mutex_unlock(&PlayerDataPoolMutex);
 		Slot = NULL;
 	}
 
@@ -2873,29 +3501,29 @@ TPlayerData *AttachPlayerPoolSlot(uint32 CharacterID, bool DontWait){
 
 	// TODO(fusion): Same as `AssignPlayerPoolSlot`.
 
+	pthread_mutex_lock(&PlayerDataPoolMutex);
 	while(true){
-		TPlayerData *Slot = NULL;
-		PlayerDataPoolMutex.down();
-		Slot = GetPlayerPoolSlot(CharacterID);
+		TPlayerData *Slot = GetPlayerPoolSlot(CharacterID);
 		if(Slot == NULL){
-			PlayerDataPoolMutex.up();
+			pthread_mutex_unlock(&PlayerDataPoolMutex);
 			error("AttachPlayerPoolSlot: Daten des Charakters sind nicht vorhanden.\n");
 			return NULL;
 		}
 
 		if(Slot->Locked == 0){
 			Slot->Locked = gettid();
-			PlayerDataPoolMutex.up();
+			pthread_mutex_unlock(&PlayerDataPoolMutex);
 			return Slot;
 		}
 
 		if(DontWait){
-			PlayerDataPoolMutex.up();
+			pthread_mutex_unlock(&PlayerDataPoolMutex);
 			return NULL;
 		}
 
-		PlayerDataPoolMutex.up();
-		DelayThread(0, 100);
+		if(!WaitPlayerPoolSnapshot(Slot)){
+			WaitPlayerPoolSlot();
+		}
 	}
 }
 
@@ -2906,21 +3534,22 @@ void AttachPlayerPoolSlot(TPlayerData *Slot, bool DontWait){
 	}
 
 	print(3, "Attache Slot von Spieler %u.\n", Slot->CharacterID);
+	pthread_mutex_lock(&PlayerDataPoolMutex);
 	while(true){
-		PlayerDataPoolMutex.down();
 		if(Slot->Locked == 0){
 			Slot->Locked = gettid();
-			PlayerDataPoolMutex.up();
+			pthread_mutex_unlock(&PlayerDataPoolMutex);
 			return;
 		}
 
 		if(DontWait){
-			PlayerDataPoolMutex.up();
+			pthread_mutex_unlock(&PlayerDataPoolMutex);
 			return;
 		}
 
-		PlayerDataPoolMutex.up();
-		DelayThread(0,100);
+		if(!WaitPlayerPoolSnapshot(Slot)){
+			WaitPlayerPoolSlot();
+		}
 	}
 }
 
@@ -2930,9 +3559,9 @@ void IncreasePlayerPoolSlotSticky(TPlayerData *Slot){
 		return;
 	}
 
-	PlayerDataPoolMutex.down();
+	pthread_mutex_lock(&PlayerDataPoolMutex);
 	Slot->Sticky += 1;
-	PlayerDataPoolMutex.up();
+	pthread_mutex_unlock(&PlayerDataPoolMutex);
 }
 
 void DecreasePlayerPoolSlotSticky(TPlayerData *Slot){
@@ -2941,9 +3570,9 @@ void DecreasePlayerPoolSlotSticky(TPlayerData *Slot){
 		return;
 	}
 
-	PlayerDataPoolMutex.down();
+	pthread_mutex_lock(&PlayerDataPoolMutex);
 	Slot->Sticky -= 1;
-	PlayerDataPoolMutex.up();
+	pthread_mutex_unlock(&PlayerDataPoolMutex);
 }
 
 void DecreasePlayerPoolSlotSticky(uint32 CharacterID){
@@ -2952,14 +3581,14 @@ void DecreasePlayerPoolSlotSticky(uint32 CharacterID){
 		return;
 	}
 
-	PlayerDataPoolMutex.down();
+	pthread_mutex_lock(&PlayerDataPoolMutex);
 	TPlayerData *Slot = GetPlayerPoolSlot(CharacterID);
 	if(Slot != NULL){
 		Slot->Sticky -= 1;
 	}else{
 		error("DecreasePlayerPoolSlotSticky: Slot von Spieler %u nicht gefunden.\n", CharacterID);
 	}
-	PlayerDataPoolMutex.up();
+	pthread_mutex_unlock(&PlayerDataPoolMutex);
 }
 
 void ReleasePlayerPoolSlot(TPlayerData *Slot){
@@ -2979,7 +3608,10 @@ void ReleasePlayerPoolSlot(TPlayerData *Slot){
 		return;
 	}
 
+	pthread_mutex_lock(&PlayerDataPoolMutex);
 	Slot->Locked = 0;
+	pthread_cond_broadcast(&PlayerDataPoolReleased);
+	pthread_mutex_unlock(&PlayerDataPoolMutex);
 }
 
 void SavePlayerPoolSlots(void){
@@ -3007,8 +3639,79 @@ void SavePlayerPoolSlots(void){
 	}
 }
 
+int LockPlayerPoolSnapshot(void){
+	time_t Now = time(NULL);
+	int Count = 0;
+	pthread_mutex_lock(&PlayerDataPoolMutex);
+	for(int i = 0; i < NARRAY(PlayerDataPool); i += 1){
+		TPlayerData *Slot = &PlayerDataPool[i];
+		if(Slot->CharacterID == 0
+				|| Slot->Locked != 0
+				|| Slot->Sticky > 0
+				|| !Slot->Dirty
+				|| (Now - Slot->LastLogoutTime) < 900){
+			continue;
+		}
+
+		Slot->Locked = SNAPSHOT_LOCK;
+		Count += 1;
+	}
+	pthread_mutex_unlock(&PlayerDataPoolMutex);
+	return Count;
+}
+
+// NOTE(fusion): This runs in the snapshot process, which has no other threads
+// and must not touch `PlayerDataPoolMutex` because it may have been held by one
+// of them at the time of the fork. It returns whether all slots were saved, so
+// the game process doesn't clear `Dirty` for slots that failed.
+bool SavePlayerPoolSnapshot(void){
+	print(3, "Speichere Spielerdaten (Schnappschuss)...\n");
+	bool Result = true;
+	for(int i = 0; i < NARRAY(PlayerDataPool); i += 1){
+		TPlayerData *Slot = &PlayerDataPool[i];
+		if(Slot->Locked == SNAPSHOT_LOCK && !SavePlayerData(Slot)){
+			Result = false;
+		}
+	}
+	return Result;
+}
+
+void UnlockPlayerPoolSnapshot(bool Saved){
+	pthread_mutex_lock(&PlayerDataPoolMutex);
+	for(int i = 0; i < NARRAY(PlayerDataPool); i += 1){
+		TPlayerData *Slot = &PlayerDataPool[i];
+		if(Slot->Locked == SNAPSHOT_LOCK){
+			if(Saved){
+				Slot->Dirty = false;
+			}
+			Slot->Locked = 0;
+		}
+	}
+	pthread_cond_broadcast(&PlayerDataPoolReleased);
+	pthread_mutex_unlock(&PlayerDataPoolMutex);
+}
+
+void PlayerPoolSummary(void){
+	if(PlayerPoolLookups > 0 || PlayerPoolWaits > 0){
+		Log("game", "%d Slot-Suchen mit %d Vergleichen, %d mal gewartet (%u us gesamt, %u us max).\n",
+				PlayerPoolLookups, PlayerPoolProbes, PlayerPoolWaits,
+				(uint32)PlayerPoolWaitTime, (uint32)PlayerPoolMaxWaitTime);
+	}
+	PlayerPoolLookups = 0;
+	PlayerPoolProbes = 0;
+	PlayerPoolWaits = 0;
+	PlayerPoolWaitTime = 0;
+	PlayerPoolMaxWaitTime = 0;
+}
+
 void InitPlayerPool(void){
 	memset(PlayerDataPool, 0, sizeof(PlayerDataPool));
+	for(int i = 0; i < NARRAY(PlayerDataPoolHash); i += 1){
+		PlayerDataPoolHash[i] = -1;
+	}
+	for(int i = 0; i < NARRAY(PlayerDataPoolNext); i += 1){
+		PlayerDataPoolNext[i] = -1;
+	}
 }
 
 void ExitPlayerPool(void){
@@ -3033,7 +3736,9 @@ void ExitPlayerPool(void){
 		}
 
 		AttachPlayerPoolSlot(Slot, false);
+		pthread_mutex_lock(&PlayerDataPoolMutex);
 		FreePlayerPoolSlot(Slot);
+		pthread_mutex_unlock(&PlayerDataPoolMutex);
 		ReleasePlayerPoolSlot(Slot);
 	}
 	print(1, "Alle Spielerdaten gespeichert.\n");
@@ -1247,6 +1247,9 @@ bool TSkillBase::SetTimer(uint16 SkNr, int Cycle, int Count, int MaxCount, int A
 		ASSERT(this->FirstFreeTimer < NARRAY(this->TimerList));
 		this->TimerList[this->FirstFreeTimer] = Skill;
 		this->FirstFreeTimer += 1;
+		if(Skill->Master != NULL){
+			Skill->Master->SetInSkillList();
+		}
 	}
 
 	return Result;
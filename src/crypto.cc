@@ -111,3 +111,100 @@ void TXTEASymmetricKey::decrypt(uint8 *Data){
 	*(uint32*)(&Data[0]) = V0;
 	*(uint32*)(&Data[4]) = V1;
 }
+
+// NOTE(fusion): Buffer versions of the functions above. Round keys are computed
+// once per buffer instead of once per block and `XTEA_LANES` independent blocks
+// are processed side by side, which lets the compiler interleave, and possibly
+// vectorize, their rounds. The output is the same as processing each block with
+// the single block versions.
+#define XTEA_LANES 4
+
+static void XTEAKeySchedule(const uint32 *Key, uint32 *K0, uint32 *K1){
+	uint32 Sum = 0x00000000UL;
+	uint32 Delta = 0x9E3779B9UL;
+	for(int i = 0; i < 32; i += 1){
+		K0[i] = Sum + Key[Sum & 3];
+		Sum += Delta;
+		K1[i] = Sum + Key[(Sum >> 11) & 3];
+	}
+}
+
+template<int Lanes>
+static void XTEAEncryptBlocks(uint8 *Data, const uint32 *K0, const uint32 *K1){
+	uint32 V0[Lanes], V1[Lanes];
+	for(int j = 0; j < Lanes; j += 1){
+		memcpy(&V0[j], &Data[j * 8 + 0], 4);
+		memcpy(&V1[j], &Data[j * 8 + 4], 4);
+	}
+
+	for(int i = 0; i < 32; i += 1){
+		for(int j = 0; j < Lanes; j += 1){
+			V0[j] += (((V1[j] << 4) ^ (V1[j] >> 5)) + V1[j]) ^ K0[i];
+		}
+		for(int j = 0; j < Lanes; j += 1){
+			V1[j] += (((V0[j] << 4) ^ (V0[j] >> 5)) + V0[j]) ^ K1[i];
+		}
+	}
+
+	for(int j = 0; j < Lanes; j += 1){
+		memcpy(&Data[j * 8 + 0], &V0[j], 4);
+		memcpy(&Data[j * 8 + 4], &V1[j], 4);
+	}
+}
+
+template<int Lanes>
+static void XTEADecryptBlocks(uint8 *Data, const uint32 *K0, const uint32 *K1){
+	uint32 V0[Lanes], V1[Lanes];
+	for(int j = 0; j < Lanes; j += 1){
+		memcpy(&V0[j], &Data[j * 8 + 0], 4);
+		memcpy(&V1[j], &Data[j * 8 + 4], 4);
+	}
+
+	for(int i = 31; i >= 0; i -= 1){
+		for(int j = 0; j < Lanes; j += 1){
+			V1[j] -= (((V0[j] << 4) ^ (V0[j] >> 5)) + V0[j]) ^ K1[i];
+		}
+		for(int j = 0; j < Lanes; j += 1){
+			V0[j] -= (((V1[j] << 4) ^ (V1[j] >> 5)) + V1[j]) ^ K0[i];
+		}
+	}
+
+	for(int j = 0; j < Lanes; j += 1){
+		memcpy(&Data[j * 8 + 0], &V0[j], 4);
+		memcpy(&Data[j * 8 + 4], &V1[j], 4);
+	}
+}
+
+void TXTEASymmetricKey::encrypt(uint8 *Data, int Size){
+	ASSERT((Size % 8) == 0);
+	uint32 K0[32], K1[32];
+	XTEAKeySchedule(m_SymmetricKey, K0, K1);
+
+	int Offset = 0;
+	while((Size - Offset) >= (XTEA_LANES * 8)){
+		XTEAEncryptBlocks<XTEA_LANES>(&Data[Offset], K0, K1);
+		Offset += XTEA_LANES * 8;
+	}
+
+	while(Offset < Size){
+		XTEAEncryptBlocks<1>(&Data[Offset], K0, K1);
+		Offset += 8;
+	}
+}
+
+void TXTEASymmetricKey::decrypt(uint8 *Data, int Size){
+	ASSERT((Size % 8) == 0);
+	uint32 K0[32], K1[32];
+	XTEAKeySchedule(m_SymmetricKey, K0, K1);
+
+	int Offset = 0;
+	while((Size - Offset) >= (XTEA_LANES * 8)){
+		XTEADecryptBlocks<XTEA_LANES>(&Data[Offset], K0, K1);
+		Offset += XTEA_LANES * 8;
+	}
+
+	while(Offset < Size){
+		XTEADecryptBlocks<1>(&Data[Offset], K0, K1);
+		Offset += 8;
+	}
+}
@@ -19,6 +19,8 @@ struct TXTEASymmetricKey{
 	void init(TReadBuffer *Buffer);
 	void encrypt(uint8 *Data); // single 8 bytes block
 	void decrypt(uint8 *Data); // single 8 bytes block
+	void encrypt(uint8 *Data, int Size); // multiple of 8 bytes
+	void decrypt(uint8 *Data, int Size); // multiple of 8 bytes
 
 	// DATA
 	// =================
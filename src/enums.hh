@@ -269,6 +269,13 @@ enum FLAG: int {
 	SPECIALOBJECT			= 65,
 };
 
+enum SNAPSHOTSTATE: int {
+	SNAPSHOT_IDLE		= 0,
+	SNAPSHOT_RUNNING	= 1,
+	SNAPSHOT_DONE		= 2,
+	SNAPSHOT_FAILED		= 3,
+};
+
 enum GAMESTATE: int {
 	GAME_STARTING	= 0,
 	GAME_RUNNING	= 1,
@@ -6,7 +6,6 @@
 #include "writer.hh"
 
 #include <fstream>
-#include <sstream>
 
 struct TSpellList {
 	uint8 Syllable[MAX_SPELL_SYLLABLES];
@@ -84,6 +83,25 @@ static const char SpellSyllable[51][6] = {
 	"",
 };
 
+// NOTE(fusion): Spoken words are mapped to syllable numbers with a trie over the
+// letters of `SpellSyllable`, and syllable sequences are mapped to spells with a
+// trie over the syllables of `SpellList`. Both are built by `InitSpellTries` so
+// that `CheckForSpell` can recognize a spell without any string comparisons.
+struct TSyllableTrieNode {
+	uint8 Next[26];
+	uint8 SyllableNr;
+};
+
+struct TSpellTrieNode {
+	uint16 Next[NARRAY(SpellSyllable)];
+	uint8 SpellNr;
+};
+
+static TSyllableTrieNode SyllableTrie[256];
+static int NumberOfSyllableTrieNodes;
+static vector<TSpellTrieNode> SpellTrie(0, 255, 256);
+static int NumberOfSpellTrieNodes;
+
 static bool IsAggressionValid(TCreature *Actor, TCreature *Victim){
 	ASSERT(Actor != NULL && Victim != NULL);
 
@@ -3984,37 +4002,59 @@ static int TypeOfSpell(const char *Text){
 	return SpellType;
 }
 
-static int FindSpell(const uint8 *Syllable){
-	int BestMatch = 0;
-	int MinParams = 100;
-	for(int SpellNr = 0;
-			SpellNr < NARRAY(SpellList);
-			SpellNr += 1){
-		int Params = 0;
-		TSpellList *Spell = &SpellList[SpellNr];
-		for(int i = 0;
-				i < NARRAY(Spell->Syllable);
-				i += 1){
-			// NOTE(fusion): SpellSyllable[6] is "para" which refers to a spell
-			// parameter.
-			if(Spell->Syllable[i] == 6){
-				if(Syllable[i] == 0)
-					break;
-				Params += 1;
-			}else if(Spell->Syllable[i] != Syllable[i]){
-				break;
-			}
+static int GetSyllableNr(const char *Text){
+	int Node = 0;
+	for(int i = 0; Text[i] != 0; i += 1){
+		int c = toLower(Text[i]);
+		if(c < 'a' || c > 'z'){
+			return 0;
+		}
 
-			if(Spell->Syllable[i] == 0){
-				if(Params < MinParams){
-					MinParams = Params;
-					BestMatch = SpellNr;
-				}
-				break;
-			}
+		Node = SyllableTrie[Node].Next[c - 'a'];
+		if(Node == 0){
+			return 0;
+		}
+	}
+	return SyllableTrie[Node].SyllableNr;
+}
+
+static void SearchSpellTrie(int Node, const uint8 *Syllable, int Index,
+		int Params, int *BestMatch, int *MinParams){
+	if(Index >= MAX_SPELL_SYLLABLES){
+		return;
+	}
+
+	TSpellTrieNode *Current = SpellTrie.at(Node);
+	int SyllableNr = Syllable[Index];
+	if(SyllableNr == 0){
+		int SpellNr = Current->SpellNr;
+		if(SpellNr != 0 && (Params < *MinParams
+				|| (Params == *MinParams && SpellNr < *BestMatch))){
+			*MinParams = Params;
+			*BestMatch = SpellNr;
 		}
+		return;
 	}
 
+	// NOTE(fusion): SpellSyllable[6] is "para" which refers to a spell
+	// parameter and matches any syllable.
+	if(SyllableNr != 6 && Current->Next[SyllableNr] != 0){
+		SearchSpellTrie(Current->Next[SyllableNr], Syllable, Index + 1,
+				Params, BestMatch, MinParams);
+	}
+
+	if(Current->Next[6] != 0){
+		SearchSpellTrie(Current->Next[6], Syllable, Index + 1,
+				Params + 1, BestMatch, MinParams);
+	}
+}
+
+static int FindSpell(const uint8 *Syllable){
+	// NOTE(fusion): The spell with the fewest parameters wins, and the lowest
+	// spell number among those, as it did when scanning `SpellList` in order.
+	int BestMatch = 0;
+	int MinParams = 100;
+	SearchSpellTrie(0, Syllable, 0, 0, &BestMatch, &MinParams);
 	return BestMatch;
 }
 
@@ -4190,45 +4230,54 @@ int CheckForSpell(uint32 CreatureID, const char *Text){
 	// TODO(fusion): Keeping syllables in text form doesn't make sense. `SpellStr`
 	// should ideally only contain parameters.
 
-	// TODO(fusion): Did we really need to use `stringstream` here? It allocates
-	// an internal `std::string` from the input string which is just wasteful,
-	// specially for the minimal processing we're doing here.
-
 	int SyllableCount = 1;
 	uint8 Syllable[MAX_SPELL_SYLLABLES] = { (uint8)SpellType };
-	char SpellStr[MAX_SPELL_SYLLABLES][512] = {};
+	char SpellStr[MAX_SPELL_SYLLABLES][512];
+	for(int i = 0; i < MAX_SPELL_SYLLABLES; i += 1){
+		SpellStr[i][0] = 0;
+	}
 	strcpy(SpellStr[0], SpellSyllable[SpellType]);
 
-	std::istringstream IS(Text);
-	IS.get();
-	IS.get();
-	while(!IS.eof() && SyllableCount < MAX_SPELL_SYLLABLES){
-		while(isSpace(IS.peek())){
-			IS.get();
+	// NOTE(fusion): This splits the text exactly like the `std::istringstream`
+	// we used before. Unquoted words only end at a blank, quoted ones at the
+	// closing quote or the end of the text, and both are cut into pieces that
+	// fit `SpellStr`.
+	const char *Next = Text + 2;
+	while(Next[0] != 0 && SyllableCount < MAX_SPELL_SYLLABLES){
+		while(isSpace(Next[0])){
+			Next += 1;
 		}
 
 		int Index = SyllableCount;
-		if(IS.peek() == '"'){
-			IS.get();
-			IS.get(SpellStr[Index], sizeof(SpellStr[0]), '"');
-			IS.get();
+		int Length = 0;
+		if(Next[0] == '"'){
+			Next += 1;
+			while(Next[0] != 0 && Next[0] != '"'
+					&& Length < (int)sizeof(SpellStr[0]) - 1){
+				SpellStr[Index][Length] = Next[0];
+				Length += 1;
+				Next += 1;
+			}
+
+			if(Length > 0 && Next[0] != 0){
+				Next += 1;
+			}
 		}else{
-			IS.get(SpellStr[Index], sizeof(SpellStr[0]), ' ');
+			while(Next[0] != 0 && Next[0] != ' '
+					&& Length < (int)sizeof(SpellStr[0]) - 1){
+				SpellStr[Index][Length] = Next[0];
+				Length += 1;
+				Next += 1;
+			}
 		}
+		SpellStr[Index][Length] = 0;
 
 		// TODO(fusion): This could be a problem if there is a "" parameter?
-		if(SpellStr[Index][0] == 0){
+		if(Length == 0){
 			break;
 		}
 
-		for(int SyllableNr = 0;
-				SyllableNr < NARRAY(SpellSyllable);
-				SyllableNr += 1){
-			if(stricmp(SpellStr[Index], SpellSyllable[SyllableNr]) == 0){
-				Syllable[Index] = (uint8)SyllableNr;
-				break;
-			}
-		}
+		Syllable[Index] = (uint8)GetSyllableNr(SpellStr[Index]);
 
 		// NOTE(fusion): SpellSyllable[6] is "para" which refers to a spell
 		// parameter. This is setting up `Syllable` to be used by `FindSpell`.
@@ -5431,9 +5480,91 @@ static void InitSpells(void){
 	Spell->Comment = "Leave House";
 }
 
+static int NewSpellTrieNode(void){
+	int Node = NumberOfSpellTrieNodes;
+	if(Node > UINT16_MAX){
+		error("NewSpellTrieNode: Zu viele Knoten.\n");
+		throw "too many spell trie nodes";
+	}
+
+	TSpellTrieNode *Current = SpellTrie.at(Node);
+	memset(Current, 0, sizeof(TSpellTrieNode));
+	NumberOfSpellTrieNodes += 1;
+	return Node;
+}
+
+static void InitSpellTries(void){
+	NumberOfSyllableTrieNodes = 1;
+	memset(SyllableTrie, 0, sizeof(SyllableTrie));
+	for(int SyllableNr = 1;
+			SyllableNr < NARRAY(SpellSyllable);
+			SyllableNr += 1){
+		const char *Text = SpellSyllable[SyllableNr];
+		if(Text[0] == 0){
+			continue;
+		}
+
+		int Node = 0;
+		for(int i = 0; Text[i] != 0; i += 1){
+			int c = Text[i] - 'a';
+			if(c < 0 || c >= NARRAY(SyllableTrie[Node].Next)){
+				error("InitSpellTries: Ungültiges Zeichen in Silbe %s.\n", Text);
+				throw "invalid spell syllable";
+			}
+
+			if(SyllableTrie[Node].Next[c] == 0){
+				if(NumberOfSyllableTrieNodes >= NARRAY(SyllableTrie)){
+					error("InitSpellTries: Zu viele Silbenknoten.\n");
+					throw "too many spell syllables";
+				}
+				SyllableTrie[Node].Next[c] = (uint8)NumberOfSyllableTrieNodes;
+				NumberOfSyllableTrieNodes += 1;
+			}
+			Node = SyllableTrie[Node].Next[c];
+		}
+		SyllableTrie[Node].SyllableNr = (uint8)SyllableNr;
+	}
+
+	// NOTE(fusion): A spell is recorded at the node where its syllables end. If
+	// two spells share the same syllables, the lower spell number is kept. Spells
+	// that fill all syllables without an end marker could never be matched.
+	NumberOfSpellTrieNodes = 0;
+	NewSpellTrieNode();
+	for(int SpellNr = 1;
+			SpellNr < NARRAY(SpellList);
+			SpellNr += 1){
+		TSpellList *Spell = &SpellList[SpellNr];
+		if(Spell->Syllable[0] == 0){
+			continue;
+		}
+
+		int Node = 0;
+		for(int i = 0; i < NARRAY(Spell->Syllable); i += 1){
+			int SyllableNr = Spell->Syllable[i];
+			if(SyllableNr == 0){
+				TSpellTrieNode *Current = SpellTrie.at(Node);
+				if(Current->SpellNr == 0){
+					Current->SpellNr = (uint8)SpellNr;
+				}
+				break;
+			}
+
+			if(SpellTrie.at(Node)->Next[SyllableNr] == 0){
+				int Child = NewSpellTrieNode();
+				SpellTrie.at(Node)->Next[SyllableNr] = (uint16)Child;
+			}
+			Node = SpellTrie.at(Node)->Next[SyllableNr];
+		}
+	}
+
+	print(2, "Zauberspruch-Index mit %d Silben- und %d Spruchknoten aufgebaut.\n",
+			NumberOfSyllableTrieNodes, NumberOfSpellTrieNodes);
+}
+
 void InitMagic(void){
 	InitCircles();
 	InitSpells();
+	InitSpellTries();
 	InitLog("banish");
 }
 
@@ -64,7 +64,7 @@ static void SigWaitAny(void){
 }
 
 static void SigHupHandler(int signr){
-	// no-op (?)
+	ReopenProtocols();
 }
 
 static void SigAbortHandler(int signr){
@@ -242,6 +242,152 @@ void LoadWorldConfig(void){
 			HelpGameAddress[2], HelpGameAddress[3]);
 }
 
+// Snapshot Save
+// =============================================================================
+// NOTE(fusion): With `SnapshotSave` enabled, the map, house owners, and player
+// data of logged out characters are saved by a forked process working on a
+// copy-on-write image of the game state, so the game thread only pauses for the
+// fork itself. SIGCHLD is ignored and the child is reaped automatically, so it
+// reports progress and its result through shared memory instead.
+static pid_t SnapshotProcessID = 0;
+static uint32 SnapshotGeneration = 0;
+static uint64 SnapshotStartTime = 0;
+static bool SnapshotKilled = false;
+
+static void SnapshotSaveProcess(void){
+	// NOTE(fusion): Signals meant for the game server shouldn't interrupt the
+	// snapshot, which will finish on its own.
+	SigHandler(SIGHUP, SIG_IGN);
+	SigHandler(SIGINT, SIG_IGN);
+	SigHandler(SIGQUIT, SIG_IGN);
+	SigHandler(SIGTERM, SIG_IGN);
+	SigHandler(SIGPWR, SIG_IGN);
+	SigHandler(SIGABRT, SIG_DFL);
+	SigHandler(SIGXCPU, SIG_DFL);
+	SigHandler(SIGXFSZ, SIG_DFL);
+	InitSnapshotProcess();
+
+	bool Saved = false;
+	try{
+		Saved = SaveMapSnapshot(SnapshotGeneration);
+		SaveOwners();
+		if(!SavePlayerPoolSnapshot()){
+			Saved = false;
+		}
+	}catch(const char *str){
+		error("SnapshotSaveProcess: %s\n", str);
+		Saved = false;
+	}catch(...){
+		error("SnapshotSaveProcess: Unbekannte Exception.\n");
+		Saved = false;
+	}
+
+	SetSnapshotState(Saved ? SNAPSHOT_DONE : SNAPSHOT_FAILED);
+	_exit(Saved ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static bool StartSnapshotSave(void){
+	if(SnapshotProcessID != 0){
+		error("StartSnapshotSave: Schnappschuss läuft noch (Pid=%d).\n", SnapshotProcessID);
+		return false;
+	}
+
+	uint64 StartTime = GetMonotonicMicroseconds();
+	SnapshotGeneration = BeginMapSnapshot();
+	int PlayerSlots = LockPlayerPoolSnapshot();
+	SetSnapshotProgress(0, 0);
+	SetSnapshotState(SNAPSHOT_RUNNING);
+
+	// NOTE(fusion): Flush buffered output so it isn't written twice.
+	fflush(stdout);
+	pid_t Pid = fork();
+	if(Pid == 0){
+		SnapshotSaveProcess();
+	}
+
+	if(Pid < 0){
+		error("StartSnapshotSave: Kann Prozess nicht starten (Fehler %d).\n", errno);
+		SetSnapshotState(SNAPSHOT_IDLE);
+		EndMapSnapshot(SnapshotGeneration, false);
+		UnlockPlayerPoolSnapshot(false);
+		return false;
+	}
+
+	SnapshotProcessID = Pid;
+	SnapshotStartTime = GetMonotonicMilliseconds();
+	SnapshotKilled = false;
+	SetSnapshotProcessID(Pid);
+	print(1, "Schnappschuss gestartet (Pid=%d, %d Spielerdaten, Pause %u us).\n",
+			Pid, PlayerSlots, (uint32)(GetMonotonicMicroseconds() - StartTime));
+	return true;
+}
+
+static void FinishSnapshotSave(bool Saved){
+	EndMapSnapshot(SnapshotGeneration, Saved);
+	UnlockPlayerPoolSnapshot(Saved);
+	if(Saved){
+		print(1, "Schnappschuss in %d ms gespeichert.\n",
+				(int)(GetMonotonicMilliseconds() - SnapshotStartTime));
+	}else{
+		error("FinishSnapshotSave: Schnappschuss (Pid=%d) fehlgeschlagen.\n", SnapshotProcessID);
+	}
+
+	SnapshotProcessID = 0;
+	SetSnapshotProcessID(0);
+	SetSnapshotState(SNAPSHOT_IDLE);
+}
+
+static void ProcessSnapshotSave(void){
+	if(SnapshotProcessID == 0){
+		return;
+	}
+
+	// NOTE(fusion): The snapshot process inherits every lock held by other threads
+	// at the time of the fork, so it could hang forever. It is killed once it runs
+	// past `SnapshotTimeout` and then treated as failed after it is gone, leaving
+	// everything it was saving dirty for the next save. Since SIGCHLD is ignored,
+	// the process can't be waited for and is polled with `kill` instead.
+	uint64 Now = GetMonotonicMilliseconds();
+	if(!SnapshotKilled && SnapshotTimeout > 0
+			&& (Now - SnapshotStartTime) >= (uint64)SnapshotTimeout * 1000){
+		error("ProcessSnapshotSave: Schnappschuss (Pid=%d) nach %d Sekunden abgebrochen.\n",
+				SnapshotProcessID, SnapshotTimeout);
+		kill(SnapshotProcessID, SIGKILL);
+		SnapshotKilled = true;
+	}
+
+	int State = GetSnapshotState();
+	if(SnapshotKilled){
+		State = SNAPSHOT_RUNNING;
+		if(kill(SnapshotProcessID, 0) == -1 && errno == ESRCH){
+			State = SNAPSHOT_FAILED;
+		}
+	}else if(State == SNAPSHOT_RUNNING && kill(SnapshotProcessID, 0) == -1 && errno == ESRCH){
+		// NOTE(fusion): The process may have exited right after the state was
+		// read, so check once more before declaring it dead.
+		State = GetSnapshotState();
+		if(State == SNAPSHOT_RUNNING){
+			State = SNAPSHOT_FAILED;
+		}
+	}
+
+	if(State != SNAPSHOT_RUNNING){
+		FinishSnapshotSave(State == SNAPSHOT_DONE);
+	}
+}
+
+static void WaitSnapshotSave(void){
+	if(SnapshotProcessID != 0){
+		print(1, "Warte auf Schnappschuss ...\n");
+		while(SnapshotProcessID != 0){
+			ProcessSnapshotSave();
+			if(SnapshotProcessID != 0){
+				DelayThread(0, 10000);
+			}
+		}
+	}
+}
+
 static void InitAll(void){
 	try{
 		ReadConfig();
@@ -273,6 +419,7 @@ static void InitAll(void){
 }
 
 static void ExitAll(void){
+	WaitSnapshotSave();
 	EndGame();
 	ExitTime();
 	ExitCr();
@@ -348,8 +495,10 @@ static void AdvanceGame(int Delay){
 		ProcessMonsterhomes();
 		ProcessMonsterRaids();
 		ProcessCommunicationControl();
-		ProcessReaderThreadReplies(RefreshSector, SendMails);
+		ProcessReaderThreadReplies(SendMails);
 		ProcessWriterThreadReplies();
+		ProcessObjectHashTable();
+		ProcessSnapshotSave();
 		ProcessCommand();
 
 		// TODO(fusion): Shouldn't we be checking both brightness and color?
@@ -375,14 +524,22 @@ static void AdvanceGame(int Delay){
 			GetRealTime(&Hour, &Minute);
 
 			RefreshCylinders();
+			RefreshSummary();
+			SkillSummary();
+			MoveUseSummary();
+			DynamicStringSummary();
+			PlayerPoolSummary();
 			if(Minute % 5 == 0){
 				CreatePlayerList(true);
 			}
 			if(Minute % 15 == 0){
-				SavePlayerDataOrder();
+				if(!SnapshotSave || !StartSnapshotSave()){
+					SavePlayerDataOrder();
+				}
 			}
 			if(Minute == 0){
 				NetLoadSummary();
+				SwapSummary();
 			}
 			if(Minute == 55){
 				WriteKillStatistics();
@@ -421,8 +578,14 @@ static void AdvanceGame(int Delay){
 				if(Reboot){
 					RefreshMap();
 				}
-				SaveMap();
-				SaveMapOn = false;
+
+				// NOTE(fusion): With a snapshot, `SaveMapOn` stays set so that
+				// `ExitAll` waits for it and then saves whatever changed since.
+				WaitSnapshotSave();
+				if(!SnapshotSave || !StartSnapshotSave()){
+					SaveMap();
+					SaveMapOn = false;
+				}
 				EndGame();
 			}
 
@@ -460,6 +623,7 @@ static void LaunchGame(void){
 
 	SigBlock(SIGUSR1);
 	SigHandler(SIGUSR1, SigUsr1Handler);
+	SetSnapshotWaitFunction(WaitSnapshotSave);
 	StartGame();
 
 	print(1, "LaunchGame: Game-Server ist bereit (Pid=%d, Tid=%d).\n", getpid(), gettid());
@@ -3,9 +3,16 @@
 #include "config.hh"
 #include "enums.hh"
 #include "houses.hh"
+#include "reader.hh"
 #include "script.hh"
+#include "threads.hh"
+#include "writer.hh"
 
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <utime.h>
 
 int SectorXMin;
 int SectorXMax;
@@ -23,6 +30,21 @@ int VeteranStartPositionZ;
 
 static int OBCount;
 static matrix3d<TSector*> *Sector;
+static TSector *FirstLoadedSector;
+static TSector *LastLoadedSector;
+static int SwapOutCount;
+static int SwapInCount;
+static int SwapInSyncCount;
+static int SwapStagingDiscarded;
+static uint64 SwapOutTime;
+static uint64 SwapInTime;
+static uint64 SwapOutMaxTime;
+static uint64 SwapInMaxTime;
+static uint32 SaveGeneration = 1;
+static int RefreshSectorCount;
+static int RefreshFieldCount;
+static uint64 RefreshTime;
+static uint64 RefreshMaxTime;
 static TObjectBlock **ObjectBlock;
 static TObject *FirstFreeObject;
 static TObject **HashTableData;
@@ -30,6 +52,10 @@ static uint8 *HashTableType;
 static uint32 HashTableSize;
 static uint32 HashTableMask;
 static uint32 HashTableFree;
+static uint32 HashTableOldMask;
+static uint32 HashTableSplit;
+static uint32 HashTableProbes;
+static uint32 HashTableInserts;
 static uint32 ObjectCounter;
 
 static vector<TCronEntry> CronEntry(0, 256, 256);
@@ -42,6 +68,36 @@ static int Marks;
 
 static TDynamicWriteBuffer HelpBuffer(KB(64));
 
+// NOTE(fusion): The object hash table is grown incrementally, one bucket at a
+// time, similar to linear hashing. While it is being resized, buckets below
+// `HashTableSplit` have already been split and are addressed with the new mask
+// while the rest are still addressed with the old one. When not resizing, both
+// masks are the same and `HashTableSplit` is the table size.
+static inline uint32 HashTableIndex(uint32 ObjectID){
+	uint32 Index = ObjectID & HashTableOldMask;
+	if(Index < HashTableSplit){
+		Index = ObjectID & HashTableMask;
+	}
+	return Index;
+}
+
+// NOTE(fusion): Swapped out entries store the swap file number in the lower and
+// the object id in the upper half of `HashTableData`, so they can be moved when
+// splitting buckets without having to swap their sector in.
+STATIC_ASSERT(sizeof(uintptr) >= 8);
+
+static inline TObject *SwappedEntry(uint32 ObjectID, uintptr FileNumber){
+	return (TObject*)(((uintptr)ObjectID << 32) | (uintptr)(uint32)FileNumber);
+}
+
+static inline uintptr SwappedFileNumber(TObject *Entry){
+	return (uintptr)(uint32)(uintptr)Entry;
+}
+
+static inline uint32 SwappedObjectID(TObject *Entry){
+	return (uint32)((uintptr)Entry >> 32);
+}
+
 // Object
 // =============================================================================
 bool Object::exists(void){
@@ -49,9 +105,9 @@ bool Object::exists(void){
 		return false;
 	}
 
-	uint32 EntryIndex = this->ObjectID & HashTableMask;
+	uint32 EntryIndex = HashTableIndex(this->ObjectID);
 	if(HashTableType[EntryIndex] == STATUS_SWAPPED){
-		UnswapSector((uintptr)HashTableData[EntryIndex]);
+		UnswapSector(SwappedFileNumber(HashTableData[EntryIndex]));
 	}
 
 	return HashTableType[EntryIndex] == STATUS_LOADED
@@ -507,67 +563,85 @@ static void ReadMapConfig(void){
 	}
 }
 
+static void SplitHashTableBuckets(int Buckets){
+	uint32 OldSize = HashTableOldMask + 1;
+	while(HashTableOldMask != HashTableMask && Buckets > 0){
+		uint32 Index = HashTableSplit;
+		if(HashTableType[Index] == STATUS_LOADED || HashTableType[Index] == STATUS_SWAPPED){
+			uint32 ObjectID;
+			if(HashTableType[Index] == STATUS_LOADED){
+				ObjectID = HashTableData[Index]->ObjectID;
+			}else{
+				ObjectID = SwappedObjectID(HashTableData[Index]);
+			}
+
+			uint32 NewIndex = ObjectID & HashTableMask;
+			if(NewIndex != Index){
+				ASSERT(NewIndex == (Index + OldSize));
+				ASSERT(HashTableType[NewIndex] == STATUS_FREE);
+				HashTableData[NewIndex] = HashTableData[Index];
+				HashTableType[NewIndex] = HashTableType[Index];
+				HashTableType[Index] = STATUS_FREE;
+			}
+		}
+
+		HashTableSplit += 1;
+		if(HashTableSplit >= OldSize){
+			HashTableOldMask = HashTableMask;
+			HashTableSplit = HashTableSize;
+			print(2, "HashTabelle auf %u Einträge vergrößert.\n", HashTableSize);
+		}
+
+		Buckets -= 1;
+	}
+}
+
 static void ResizeHashTable(void){
+	// NOTE(fusion): Resizing the table will only make room for the new entries.
+	// Existing entries are moved to their new position by `SplitHashTableBuckets`
+	// a few buckets at a time, as the game runs.
+	if(HashTableOldMask != HashTableMask){
+		SplitHashTableBuckets(INT_MAX);
+	}
+
 	uint32 OldSize = HashTableSize;
 	uint32 NewSize = OldSize * 2;
 	ASSERT(ISPOW2(OldSize));
 	ASSERT(NewSize > OldSize);
 
-	// TODO(fusion): See note below.
-	error("FATAL ERROR in ResizeHashTable: Resizing the object hash table is"
-			" currently disabled. You may increase `Objects` in the map config"
-			" from %d to %d, to achieve the same effect.", OldSize, NewSize);
-	abort();
-
 	error("INFO: HashTabelle zu klein. Größe wird verdoppelt auf %d.\n", NewSize);
 
-	uint32 NewMask = NewSize - 1;
-	TObject **NewData = (TObject**)malloc(NewSize * sizeof(TObject*));
-	uint8 *NewType = (uint8*)malloc(NewSize * sizeof(uint8));
-	memset(NewType, 0, NewSize * sizeof(uint8));
-
-	// TODO(fusion): This rehash loop doesn't make a lot of sense. It wants to
-	// access all existing objects but doing so would cause all sectors to be
-	// swapped in at some time or another. This may be bad for performance but
-	// the real problem is that `UnswapSector` may swap out some other sector
-	// whose objects were already put into `NewType` and `NewData`, causing
-	// multiple object ids to reference the same `TObject`.
-	//	Looking at some of the logs included with this executable, it doesn't
-	// look like this function was ever called which explains why it wasn't fixed
-	// earlier.
-	//	It would be possible to do this rehashing without swapping anything out,
-	// if we stored ObjectID somewhere (maybe `HashTableData`). Doubling the size
-	// of the table means there are two possible indices for each previous entry,
-	// and we can only determine which one to actually move it with the ObjectID.
-
-	NewType[0] = STATUS_PERMANENT;
-	NewData[0] = HashTableData[0];
-	for(uint32 i = 1; i < OldSize; i += 1){
-		if(HashTableType[i] != STATUS_FREE){
-			if(HashTableType[i] == STATUS_SWAPPED){
-				UnswapSector((uintptr)HashTableData[i]);
-			}
-
-			if(HashTableType[i] == STATUS_LOADED){
-				TObject *Entry = HashTableData[i];
-				NewType[Entry->ObjectID & NewMask] = STATUS_LOADED;
-				NewData[Entry->ObjectID & NewMask] = Entry;
-			}else{
-				error("ResizeHashTable: Fehler beim Reorganisieren der HashTabelle.\n");
-			}
-		}
+	TObject **NewData = (TObject**)realloc(HashTableData, NewSize * sizeof(TObject*));
+	uint8 *NewType = (uint8*)realloc(HashTableType, NewSize * sizeof(uint8));
+	if(NewData == NULL || NewType == NULL){
+		error("FATAL ERROR in ResizeHashTable: Kann HashTabelle nicht vergrößern.\n");
+		abort();
 	}
 
-	free(HashTableData);
-	free(HashTableType);
+	memset(&NewType[OldSize], STATUS_FREE, (NewSize - OldSize) * sizeof(uint8));
 
 	HashTableData = NewData;
 	HashTableType = NewType;
+	HashTableOldMask = OldSize - 1;
+	HashTableSplit = 0;
 	HashTableSize = NewSize;
-	HashTableMask = NewMask;
+	HashTableMask = NewSize - 1;
 	HashTableFree += (NewSize - OldSize);
 }
 
+void ProcessObjectHashTable(void){
+	SplitHashTableBuckets(65536);
+
+	uint32 Load = (uint32)(((uint64)(HashTableSize - HashTableFree) * 1000) / HashTableSize);
+	uint32 ProbeLength = 100;
+	if(HashTableInserts > 0){
+		ProbeLength = (uint32)(((uint64)HashTableProbes * 100) / HashTableInserts);
+	}
+	SetHashTableStatistics(HashTableSize, Load, ProbeLength);
+	HashTableProbes = 0;
+	HashTableInserts = 0;
+}
+
 static TObject *GetFreeObjectSlot(void){
 	if(FirstFreeObject == NULL){
 		SwapSector();
@@ -609,7 +683,7 @@ void SwapObject(TWriteBinaryFile *File, Object Obj, uintptr FileNumber){
 	// NOTE(fusion): Does it make sense to swap an object that isn't loaded? We
 	// were originally calling `Object::exists` that would swap in the object's
 	// sector if it was swapped out. We should probably have an assertion here.
-	uint32 EntryIndex = Obj.ObjectID & HashTableMask;
+	uint32 EntryIndex = HashTableIndex(Obj.ObjectID);
 	if(HashTableType[EntryIndex] != STATUS_LOADED){
 		error("SwapObject: Object doesn't exist or is not currently loaded.\n");
 		return;
@@ -633,39 +707,93 @@ void SwapObject(TWriteBinaryFile *File, Object Obj, uintptr FileNumber){
 
 	PutFreeObjectSlot(Entry);
 	HashTableType[EntryIndex] = STATUS_SWAPPED;
-	HashTableData[EntryIndex] = (TObject*)FileNumber;
+	HashTableData[EntryIndex] = SwappedEntry(Obj.ObjectID, FileNumber);
 }
 
-void SwapSector(void){
-	static uintptr FileNumber = 0;
+static void LinkLoadedSector(TSector *Sec){
+	Sec->PrevLoaded = NULL;
+	Sec->NextLoaded = FirstLoadedSector;
+	if(FirstLoadedSector != NULL){
+		FirstLoadedSector->PrevLoaded = Sec;
+	}else{
+		LastLoadedSector = Sec;
+	}
+	FirstLoadedSector = Sec;
+}
+
+static void UnlinkLoadedSector(TSector *Sec){
+	if(Sec->PrevLoaded != NULL){
+		Sec->PrevLoaded->NextLoaded = Sec->NextLoaded;
+	}else{
+		FirstLoadedSector = Sec->NextLoaded;
+	}
 
-	TSector *Oldest = NULL;
-	int OldestSectorX = 0;
-	int OldestSectorY = 0;
-	int OldestSectorZ = 0;
-	uint32 OldestTimeStamp = RoundNr + 1;
+	if(Sec->NextLoaded != NULL){
+		Sec->NextLoaded->PrevLoaded = Sec->PrevLoaded;
+	}else{
+		LastLoadedSector = Sec->PrevLoaded;
+	}
 
-	ASSERT(Sector != NULL);
-	for(int SectorZ = SectorZMin; SectorZ <= SectorZMax; SectorZ += 1)
-	for(int SectorY = SectorYMin; SectorY <= SectorYMax; SectorY += 1)
-	for(int SectorX = SectorXMin; SectorX <= SectorXMax; SectorX += 1){
-		TSector *CurrentSector = *Sector->at(SectorX, SectorY, SectorZ);
-		if(CurrentSector != NULL
-				&& CurrentSector->Status == STATUS_LOADED
-				&& CurrentSector->TimeStamp < OldestTimeStamp){
-			Oldest = CurrentSector;
-			OldestSectorX = SectorX;
-			OldestSectorY = SectorY;
-			OldestSectorZ = SectorZ;
-			OldestTimeStamp = CurrentSector->TimeStamp;
+	Sec->PrevLoaded = NULL;
+	Sec->NextLoaded = NULL;
+}
+
+static void MarkSectorDirty(TSector *Sec){
+	Sec->DirtyGeneration = SaveGeneration;
+}
+
+// NOTE(fusion): Marks the sector holding `Obj` as modified. Creatures and
+// anything inside them are not part of the saved map, so changes to those are
+// ignored. This is what keeps creatures walking around from dirtying sectors.
+static void MarkObjectDirty(Object Obj){
+	while(Obj != NONE){
+		ObjectType ObjType = Obj.getObjectType();
+		if(ObjType.isCreatureContainer()){
+			return;
+		}
+
+		if(ObjType.isMapContainer()){
+			TObject *MapCon = AccessObject(Obj);
+			int SectorX = (int)MapCon->Attributes[1] / 32;
+			int SectorY = (int)MapCon->Attributes[2] / 32;
+			int SectorZ = (int)(MapCon->Attributes[3] & 0xFF);
+			if(TSector *Sec = *Sector->at(SectorX, SectorY, SectorZ)){
+				MarkSectorDirty(Sec);
+			}
+			return;
+		}
+
+		Obj = Obj.getContainer();
+	}
+}
+
+static void TouchSector(TSector *Sec){
+	// NOTE(fusion): Sectors are only compared by round, same as with the full
+	// scan this replaces, so there is no need to move it more than once a round.
+	if(Sec->TimeStamp != RoundNr){
+		Sec->TimeStamp = RoundNr;
+		if(Sec->Status == STATUS_LOADED && Sec != FirstLoadedSector){
+			UnlinkLoadedSector(Sec);
+			LinkLoadedSector(Sec);
 		}
 	}
+}
+
+void SwapSector(void){
+	static uintptr FileNumber = 0;
 
+	TSector *Oldest = LastLoadedSector;
 	if(Oldest == NULL){
 		error("FATAL ERROR in SwapSector: Es kann kein Sektor ausgelagert werden.\n");
 		abort();
 	}
 
+	uint64 StartTime = GetMonotonicMicroseconds();
+	int OldestSectorX = Oldest->SectorX;
+	int OldestSectorY = Oldest->SectorY;
+	int OldestSectorZ = Oldest->SectorZ;
+	UnlinkLoadedSector(Oldest);
+
 	char FileName[4096];
 	do{
 		FileNumber += 1;
@@ -688,46 +816,284 @@ void SwapSector(void){
 			}
 		}
 		Oldest->Status = STATUS_SWAPPED;
+		Oldest->FileNumber = (uint32)FileNumber;
 		File.close();
 	}catch(const char *str){
 		error("FATAL ERROR in SwapSector: Kann Datei \"%s\" nicht anlegen.\n", FileName);
 		error("# Fehler: %s\n", str);
 		abort();
 	}
+
+	uint64 Time = GetMonotonicMicroseconds() - StartTime;
+	SwapOutCount += 1;
+	SwapOutTime += Time;
+	SwapOutMaxTime = std::max<uint64>(SwapOutMaxTime, Time);
+	print(3, "Sektor %d/%d/%d in %u us ausgelagert.\n",
+			OldestSectorX, OldestSectorY, OldestSectorZ, (uint32)Time);
+}
+
+// NOTE(fusion): Swap files of sectors around players are read ahead of time by
+// the reader thread into staging slots, so `UnswapSector` doesn't need to block
+// the game thread on disk I/O when they're eventually accessed. A slot is owned
+// by the game thread while `FREE` or `READY` and by the reader thread while
+// `LOADING`. A request may be dropped at any time by the game thread, in which
+// case the reader thread will discard whatever it has read.
+//	Most sectors that are prefetched are never unswapped, so slots that were
+// requested or read more than `SWAP_STAGING_EXPIRY` rounds ago are dropped and,
+// when there is no free slot left, the least recently requested one that is
+// `READY` is evicted to make room for the new request.
+constexpr uint32 SWAP_STAGING_EXPIRY = 60;
+
+enum : int {
+	SWAP_STAGING_FREE		= 0,
+	SWAP_STAGING_REQUESTED	= 1,
+	SWAP_STAGING_LOADING	= 2,
+	SWAP_STAGING_READY		= 3,
+	SWAP_STAGING_CANCELLED	= 4,
+};
+
+struct TSwapStaging {
+	int State;
+	int SectorX;
+	int SectorY;
+	int SectorZ;
+	uint32 FileNumber;
+	uint32 Round;
+	uint8 *Data;
+	int Size;
+};
+
+static TSwapStaging SwapStaging[32];
+static Semaphore SwapStagingMutex(1);
+
+void PrefetchSector(int SectorX, int SectorY, int SectorZ){
+	if(SectorX < SectorXMin || SectorXMax < SectorX
+			|| SectorY < SectorYMin || SectorYMax < SectorY
+			|| SectorZ < SectorZMin || SectorZMax < SectorZ){
+		return;
+	}
+
+	ASSERT(Sector != NULL);
+	TSector *Sec = *Sector->at(SectorX, SectorY, SectorZ);
+	if(Sec == NULL || Sec->Status != STATUS_SWAPPED){
+		return;
+	}
+
+	int FreeSlot = -1;
+	int OldestSlot = -1;
+	SwapStagingMutex.down();
+	for(int i = 0; i < NARRAY(SwapStaging); i += 1){
+		TSwapStaging *Staging = &SwapStaging[i];
+		if(Staging->State == SWAP_STAGING_FREE){
+			if(FreeSlot == -1){
+				FreeSlot = i;
+			}
+			continue;
+		}
+
+		if(Staging->FileNumber == Sec->FileNumber){
+			Staging->Round = RoundNr;
+			SwapStagingMutex.up();
+			return;
+		}
+
+		// NOTE(fusion): `LOADING` and `CANCELLED` slots belong to the reader
+		// thread, which will release them on its own.
+		if(Staging->State == SWAP_STAGING_REQUESTED
+				|| Staging->State == SWAP_STAGING_READY){
+			if((RoundNr - Staging->Round) >= SWAP_STAGING_EXPIRY){
+				delete[] Staging->Data;
+				Staging->State = SWAP_STAGING_FREE;
+				Staging->Data = NULL;
+				SwapStagingDiscarded += 1;
+				if(FreeSlot == -1){
+					FreeSlot = i;
+				}
+			}else if(Staging->State == SWAP_STAGING_READY
+					&& (OldestSlot == -1 || Staging->Round < SwapStaging[OldestSlot].Round)){
+				OldestSlot = i;
+			}
+		}
+	}
+
+	if(FreeSlot == -1 && OldestSlot != -1){
+		delete[] SwapStaging[OldestSlot].Data;
+		SwapStaging[OldestSlot].State = SWAP_STAGING_FREE;
+		SwapStaging[OldestSlot].Data = NULL;
+		SwapStagingDiscarded += 1;
+		FreeSlot = OldestSlot;
+	}
+
+	if(FreeSlot != -1){
+		SwapStaging[FreeSlot].State = SWAP_STAGING_REQUESTED;
+		SwapStaging[FreeSlot].SectorX = SectorX;
+		SwapStaging[FreeSlot].SectorY = SectorY;
+		SwapStaging[FreeSlot].SectorZ = SectorZ;
+		SwapStaging[FreeSlot].FileNumber = Sec->FileNumber;
+		SwapStaging[FreeSlot].Round = RoundNr;
+		SwapStaging[FreeSlot].Data = NULL;
+		SwapStaging[FreeSlot].Size = 0;
+	}
+	SwapStagingMutex.up();
+
+	if(FreeSlot != -1 && !PrefetchSectorOrder(SectorX, SectorY, SectorZ)){
+		SwapStagingMutex.down();
+		SwapStaging[FreeSlot].State = SWAP_STAGING_FREE;
+		SwapStagingMutex.up();
+	}
 }
 
-void UnswapSector(uintptr FileNumber){
+void PrefetchSectors(int x, int y, int z){
+	int SectorX = x / 32;
+	int SectorY = y / 32;
+	for(int OffsetY = -1; OffsetY <= 1; OffsetY += 1)
+	for(int OffsetX = -1; OffsetX <= 1; OffsetX += 1){
+		PrefetchSector(SectorX + OffsetX, SectorY + OffsetY, z);
+	}
+}
+
+void LoadSwappedSector(int SectorX, int SectorY, int SectorZ){
+	// NOTE(fusion): This is called from the reader thread.
+	int Slot = -1;
+	uint32 FileNumber = 0;
+	SwapStagingMutex.down();
+	for(int i = 0; i < NARRAY(SwapStaging); i += 1){
+		if(SwapStaging[i].State == SWAP_STAGING_REQUESTED
+				&& SwapStaging[i].SectorX == SectorX
+				&& SwapStaging[i].SectorY == SectorY
+				&& SwapStaging[i].SectorZ == SectorZ){
+			SwapStaging[i].State = SWAP_STAGING_LOADING;
+			FileNumber = SwapStaging[i].FileNumber;
+			Slot = i;
+			break;
+		}
+	}
+	SwapStagingMutex.up();
+
+	if(Slot == -1){
+		return;
+	}
+
 	char FileName[4096];
-	snprintf(FileName, sizeof(FileName), "%s/%08u.swp", SAVEPATH, (uint32)FileNumber);
+	snprintf(FileName, sizeof(FileName), "%s/%08u.swp", SAVEPATH, FileNumber);
 
+	uint8 *Data = NULL;
+	int Size = 0;
 	TReadBinaryFile File;
 	try{
 		File.open(FileName);
-		int SectorX = (int)File.readQuad();
-		int SectorY = (int)File.readQuad();
-		int SectorZ = (int)File.readQuad();
+		Size = File.getSize();
+		Data = new uint8[Size];
+		File.readBytes(Data, Size);
+		File.close();
+	}catch(const char *str){
+		print(3, "LoadSwappedSector: Kann Datei \"%s\" nicht lesen (%s).\n", FileName, str);
+		delete[] Data;
+		Data = NULL;
+	}
+
+	SwapStagingMutex.down();
+	if(SwapStaging[Slot].State == SWAP_STAGING_LOADING && Data != NULL){
+		SwapStaging[Slot].State = SWAP_STAGING_READY;
+		SwapStaging[Slot].Data = Data;
+		SwapStaging[Slot].Size = Size;
+	}else{
+		SwapStaging[Slot].State = SWAP_STAGING_FREE;
+		delete[] Data;
+	}
+	SwapStagingMutex.up();
+}
+
+static uint8 *TakeStagedSwapFile(uint32 FileNumber, int *Size){
+	uint8 *Data = NULL;
+	SwapStagingMutex.down();
+	for(int i = 0; i < NARRAY(SwapStaging); i += 1){
+		if(SwapStaging[i].State == SWAP_STAGING_FREE
+				|| SwapStaging[i].FileNumber != FileNumber){
+			continue;
+		}
+
+		if(SwapStaging[i].State == SWAP_STAGING_READY){
+			Data = SwapStaging[i].Data;
+			*Size = SwapStaging[i].Size;
+			SwapStaging[i].State = SWAP_STAGING_FREE;
+			SwapStaging[i].Data = NULL;
+		}else if(SwapStaging[i].State == SWAP_STAGING_LOADING){
+			SwapStaging[i].State = SWAP_STAGING_CANCELLED;
+		}else if(SwapStaging[i].State == SWAP_STAGING_REQUESTED){
+			SwapStaging[i].State = SWAP_STAGING_FREE;
+		}
+		break;
+	}
+	SwapStagingMutex.up();
+	return Data;
+}
+
+static void ClearSwapStaging(void){
+	SwapStagingMutex.down();
+	for(int i = 0; i < NARRAY(SwapStaging); i += 1){
+		if(SwapStaging[i].State == SWAP_STAGING_READY){
+			delete[] SwapStaging[i].Data;
+			SwapStaging[i].Data = NULL;
+			SwapStaging[i].State = SWAP_STAGING_FREE;
+		}else if(SwapStaging[i].State == SWAP_STAGING_LOADING){
+			SwapStaging[i].State = SWAP_STAGING_CANCELLED;
+		}else if(SwapStaging[i].State == SWAP_STAGING_REQUESTED){
+			SwapStaging[i].State = SWAP_STAGING_FREE;
+		}
+	}
+	SwapStagingMutex.up();
+}
+
+void UnswapSector(uintptr FileNumber){
+	uint64 StartTime = GetMonotonicMicroseconds();
+	char FileName[4096];
+	snprintf(FileName, sizeof(FileName), "%s/%08u.swp", SAVEPATH, (uint32)FileNumber);
+
+	int Size = 0;
+	uint8 *Data = TakeStagedSwapFile((uint32)FileNumber, &Size);
+	if(Data == NULL){
+		TReadBinaryFile File;
+		try{
+			File.open(FileName);
+			Size = File.getSize();
+			Data = new uint8[Size];
+			File.readBytes(Data, Size);
+			File.close();
+		}catch(const char *str){
+			error("FATAL ERROR in UnswapSector: Kann Datei \"%s\" nicht lesen.\n", FileName);
+			error("# Fehler: %s\n", str);
+			abort();
+		}
+		SwapInSyncCount += 1;
+	}
+
+	TReadBuffer Buffer(Data, Size);
+	try{
+		int SectorX = (int)Buffer.readQuad();
+		int SectorY = (int)Buffer.readQuad();
+		int SectorZ = (int)Buffer.readQuad();
 		print(2, "Lagere Sector %d/%d/%d ein...\n", SectorX, SectorY, SectorZ);
 
 		ASSERT(Sector != NULL);
 		TSector *LoadingSector = *Sector->at(SectorX, SectorY, SectorZ);
 		if(LoadingSector == NULL){
 			error("UnswapSector: Sektor %d/%d/%d existiert nicht.\n", SectorX, SectorY, SectorZ);
-			File.close();
+			delete[] Data;
 			return;
 		}
 
 		if(LoadingSector->Status != STATUS_SWAPPED){
 			error("UnswapSector: Sektor %d/%d/%d ist nicht ausgelagert.\n", SectorX, SectorY, SectorZ);
-			File.close();
+			delete[] Data;
 			return;
 		}
 
-		int Size = File.getSize();
-		while(File.getPosition() < Size){
+		while(!Buffer.eof()){
 			TObject Entry;
-			File.readBytes((uint8*)&Entry, sizeof(TObject));
+			Buffer.readBytes((uint8*)&Entry, sizeof(TObject));
 
-			uint32 EntryIndex = Entry.ObjectID & HashTableMask;
+			uint32 EntryIndex = HashTableIndex(Entry.ObjectID);
 			if(HashTableType[EntryIndex] == STATUS_SWAPPED){
 				// NOTE(fusion): Make sure we only allocate the object if we confirm
 				// its status. The original code would call `readBytes` on the result
@@ -741,9 +1107,21 @@ void UnswapSector(uintptr FileNumber){
 				error("UnswapSector: Objekt %u existiert schon.\n", Entry.ObjectID);
 			}
 		}
+		// NOTE(fusion): The sector is being swapped in because something needs
+		// it, so it becomes the most recently used one.
 		LoadingSector->Status = STATUS_LOADED;
-		File.close();
+		LoadingSector->TimeStamp = RoundNr;
+		LoadingSector->FileNumber = 0;
+		LinkLoadedSector(LoadingSector);
+		delete[] Data;
 		unlink(FileName);
+
+		uint64 Time = GetMonotonicMicroseconds() - StartTime;
+		SwapInCount += 1;
+		SwapInTime += Time;
+		SwapInMaxTime = std::max<uint64>(SwapInMaxTime, Time);
+		print(3, "Sektor %d/%d/%d in %u us eingelagert.\n",
+				SectorX, SectorY, SectorZ, (uint32)Time);
 	}catch(const char *str){
 		error("FATAL ERROR in UnswapSector: Kann Datei \"%s\" nicht lesen.\n", FileName);
 		error("# Fehler: %s\n", str);
@@ -751,6 +1129,22 @@ void UnswapSector(uintptr FileNumber){
 	}
 }
 
+void SwapSummary(void){
+	Log("swap", "ausgelagert: %d Sektoren (%u us gesamt, %u us max).\n",
+			SwapOutCount, (uint32)SwapOutTime, (uint32)SwapOutMaxTime);
+	Log("swap", "eingelagert: %d Sektoren (%u us gesamt, %u us max, %d ohne Vorladen, %d Vorladungen verworfen).\n",
+			SwapInCount, (uint32)SwapInTime, (uint32)SwapInMaxTime, SwapInSyncCount,
+			SwapStagingDiscarded);
+	SwapOutCount = 0;
+	SwapInCount = 0;
+	SwapInSyncCount = 0;
+	SwapStagingDiscarded = 0;
+	SwapOutTime = 0;
+	SwapInTime = 0;
+	SwapOutMaxTime = 0;
+	SwapInMaxTime = 0;
+}
+
 void DeleteSwappedSectors(void){
 	DIR *SwapDir = opendir(SAVEPATH);
 	if(SwapDir == NULL){
@@ -929,78 +1323,383 @@ void InitSector(int SectorX, int SectorY, int SectorZ){
 	NewSector->TimeStamp = RoundNr;
 	NewSector->Status = STATUS_LOADED;
 	NewSector->MapFlags = 0;
+	NewSector->SectorX = SectorX;
+	NewSector->SectorY = SectorY;
+	NewSector->SectorZ = SectorZ;
+	NewSector->FileNumber = 0;
+	NewSector->DirtyGeneration = 0;
+	NewSector->RefreshData = NULL;
+	NewSector->RefreshSize = 0;
+	LinkLoadedSector(NewSector);
 
 	*Sector->at(SectorX, SectorY, SectorZ) = NewSector;
 }
 
-void LoadSector(const char *FileName, int SectorX, int SectorY, int SectorZ){
-	if(SectorX < SectorXMin || SectorXMax < SectorX
-			|| SectorY < SectorYMin || SectorYMax < SectorY
-			|| SectorZ < SectorZMin || SectorZMax < SectorZ){
-		return;
+// Sector Images
+// =============================================================================
+// NOTE(fusion): A sector image is the binary form of a sector file. It is what
+// gets stored in the ".bsec" files next to the ".sec" sources and is laid out
+// so it can be mapped and decoded directly, without going through the script
+// tokenizer:
+//
+//	uint32	Magic				SECTOR_IMAGE_MAGIC
+//	uint16	Version				SECTOR_IMAGE_VERSION
+//	uint16	SectorX
+//	uint16	SectorY
+//	uint8	SectorZ
+//	uint32	PayloadSize			(everything after the header)
+//	uint32	Checksum			(FNV-1a of the payload)
+//	repeated until the end of the image:
+//		uint8	OffsetX
+//		uint8	OffsetY
+//		uint8	Flags				(1 = refresh, 2 = nologout, 4 = protectionzone)
+//		uint32	ContentSize
+//		uint8	Content[ContentSize]	(object stream, see `LoadObjects`)
+//
+//	The content is the same object stream used by swap files, so both the
+// script parser and `SaveObjects` can produce it as is.
+//	Payload size and checksum are only filled in by `WriteSectorImage` and only
+// checked by `CheckSectorImage`, when an image is read back from disk. Images
+// that never leave memory keep them zeroed.
+constexpr uint32 SECTOR_IMAGE_MAGIC = 0x43455342; // "BSEC"
+constexpr uint16 SECTOR_IMAGE_VERSION = 2;
+constexpr int SECTOR_IMAGE_HEADER_SIZE = 19;
+
+enum : int {
+	SECTOR_FILE_PENDING = 0,
+	SECTOR_FILE_READY,
+	SECTOR_FILE_FAILED,
+};
+
+struct TSectorFile {
+	int SectorX;
+	int SectorY;
+	int SectorZ;
+	bool HasText;
+	bool HasBinary;
+	bool UseBinary;
+	bool Mapped;
+	int State;
+	uint8 *Data;
+	int Size;
+	char Name[256];
+	char Error[128];
+};
+
+static TDynamicWriteBuffer ImageBuffer(KB(64));
+static TSectorFile *SectorFiles;
+static int SectorFileCount;
+static int NextSectorFile;
+static bool LoadMapAbort;
+static Semaphore LoadMapMutex(1);
+static Semaphore LoadMapDone(0);
+
+static void WriteSectorImageHeader(TWriteStream *Image, int SectorX, int SectorY, int SectorZ){
+	Image->writeQuad(SECTOR_IMAGE_MAGIC);
+	Image->writeWord(SECTOR_IMAGE_VERSION);
+	Image->writeWord((uint16)SectorX);
+	Image->writeWord((uint16)SectorY);
+	Image->writeByte((uint8)SectorZ);
+	Image->writeQuad(0);
+	Image->writeQuad(0);
+}
+
+static void WriteSectorImagePoint(TWriteStream *Image, int OffsetX, int OffsetY,
+		uint8 Flags, const uint8 *Content, int ContentSize){
+	Image->writeByte((uint8)OffsetX);
+	Image->writeByte((uint8)OffsetY);
+	Image->writeByte(Flags);
+	Image->writeQuad((uint32)ContentSize);
+	if(ContentSize > 0){
+		Image->writeBytes(Content, ContentSize);
+	}
+}
+
+static void ReadSectorImageHeader(TReadBuffer *Image, int *SectorX, int *SectorY, int *SectorZ){
+	if(Image->readQuad() != SECTOR_IMAGE_MAGIC){
+		throw "invalid sector image";
+	}
+
+	if(Image->readWord() != SECTOR_IMAGE_VERSION){
+		throw "unsupported sector image version";
+	}
+
+	*SectorX = (int)Image->readWord();
+	*SectorY = (int)Image->readWord();
+	*SectorZ = (int)Image->readByte();
+	Image->readQuad(); // PayloadSize
+	Image->readQuad(); // Checksum
+}
+
+static uint32 SectorImageChecksum(const uint8 *Data, int Size){
+	uint32 Checksum = 2166136261U;
+	for(int i = 0; i < Size; i += 1){
+		Checksum ^= Data[i];
+		Checksum *= 16777619U;
+	}
+	return Checksum;
+}
+
+static void CheckSectorImage(const uint8 *Data, int Size, int SectorX, int SectorY, int SectorZ){
+	if(Size < SECTOR_IMAGE_HEADER_SIZE){
+		throw "sector image too small";
+	}
+
+	TReadBuffer Image(Data, Size);
+	int ImageX, ImageY, ImageZ;
+	ReadSectorImageHeader(&Image, &ImageX, &ImageY, &ImageZ);
+	if(ImageX != SectorX || ImageY != SectorY || ImageZ != SectorZ){
+		throw "sector image coordinates mismatch";
+	}
+
+	TReadBuffer Header(&Data[SECTOR_IMAGE_HEADER_SIZE - 8], 8);
+	int PayloadSize = (int)Header.readQuad();
+	uint32 Checksum = Header.readQuad();
+	if(PayloadSize != (Size - SECTOR_IMAGE_HEADER_SIZE)){
+		throw "sector image size mismatch";
 	}
 
-	InitSector(SectorX, SectorY, SectorZ);
+	if(Checksum != SectorImageChecksum(&Data[SECTOR_IMAGE_HEADER_SIZE], PayloadSize)){
+		throw "sector image checksum mismatch";
+	}
+}
 
-	ASSERT(Sector != NULL);
-	TSector *LoadingSector = *Sector->at(SectorX, SectorY, SectorZ);
-	ASSERT(LoadingSector != NULL);
+static void WriteSectorImage(const char *FileName, const uint8 *Data, int Size){
+	ASSERT(Size >= SECTOR_IMAGE_HEADER_SIZE);
+	int PayloadSize = Size - SECTOR_IMAGE_HEADER_SIZE;
 
+	char TempFileName[4096];
+	snprintf(TempFileName, sizeof(TempFileName), "%s.tmp", FileName);
+
+	TWriteBinaryFile File;
+	File.open(TempFileName);
+	File.writeBytes(Data, SECTOR_IMAGE_HEADER_SIZE - 8);
+	File.writeQuad((uint32)PayloadSize);
+	File.writeQuad(SectorImageChecksum(&Data[SECTOR_IMAGE_HEADER_SIZE], PayloadSize));
+	File.writeBytes(&Data[SECTOR_IMAGE_HEADER_SIZE], PayloadSize);
+	File.close();
+	ReplaceFile(TempFileName, FileName);
+}
+
+// NOTE(fusion): This is the old `LoadSector` parser, except that it produces a
+// sector image instead of creating objects. It only does read-only lookups into
+// the object type tables so it can run on the map loading threads. Each content
+// stream gets its own record, together with flags seen so far for that point.
+static void ParseSectorText(const char *FileName, int SectorX, int SectorY, int SectorZ,
+		TWriteStream *Image, TDynamicWriteBuffer *Content){
 	TReadScriptFile Script;
-	try{
-		Script.open(FileName);
-		print(1, "Lade Sektor %d/%d/%d ...\n", SectorX, SectorY, SectorZ);
+	Script.open(FileName);
+	WriteSectorImageHeader(Image, SectorX, SectorY, SectorZ);
 
-		int OffsetX = -1;
-		int OffsetY = -1;
-		while(true){
-			Script.nextToken();
-			if(Script.Token == ENDOFFILE){
-				Script.close();
-				return;
+	int OffsetX = -1;
+	int OffsetY = -1;
+	uint8 Flags = 0;
+	while(true){
+		Script.nextToken();
+		if(Script.Token == ENDOFFILE){
+			break;
+		}
+
+		if(Script.Token == SPECIAL && Script.getSpecial() == ','){
+			continue;
+		}
+
+		if(Script.Token == BYTES){
+			if(Flags != 0){
+				WriteSectorImagePoint(Image, OffsetX, OffsetY, Flags, NULL, 0);
+				Flags = 0;
 			}
 
-			if(Script.Token == SPECIAL && Script.getSpecial() == ','){
-				continue;
+			uint8 *SectorOffset = Script.getBytesequence();
+			OffsetX = (int)SectorOffset[0];
+			OffsetY = (int)SectorOffset[1];
+			if(OffsetX >= 32 || OffsetY >= 32){
+				Script.error("coordinate out of range");
 			}
+			Script.readSymbol(':');
+			continue;
+		}
 
-			if(Script.Token == BYTES){
-				uint8 *SectorOffset = Script.getBytesequence();
-				OffsetX = (int)SectorOffset[0];
-				OffsetY = (int)SectorOffset[1];
-				Script.readSymbol(':');
-				// TODO(fusion): Probably check if offsets are within bounds?
-				continue;
+		if(Script.Token != IDENTIFIER){
+			Script.error("next map point expected");
+		}
+
+		if(OffsetX == -1 || OffsetY == -1){
+			Script.error("coordinate expected");
+		}
+
+		const char *Identifier = Script.getIdentifier();
+		if(strcmp(Identifier, "refresh") == 0){
+			Flags |= 1;
+		}else if(strcmp(Identifier, "nologout") == 0){
+			Flags |= 2;
+		}else if(strcmp(Identifier, "protectionzone") == 0){
+			Flags |= 4;
+		}else if(strcmp(Identifier, "content") == 0){
+			Script.readSymbol('=');
+			Content->Position = 0;
+			LoadObjects(&Script, Content, false);
+			WriteSectorImagePoint(Image, OffsetX, OffsetY, Flags, Content->Data, Content->Position);
+			Flags = 0;
+		}else{
+			Script.error("unknown map flag");
+		}
+	}
+
+	if(Flags != 0){
+		WriteSectorImagePoint(Image, OffsetX, OffsetY, Flags, NULL, 0);
+	}
+
+	Script.close();
+}
+
+static int WriteSectorText(const char *FileName, const uint8 *Data, int Size){
+	TReadBuffer Image(Data, Size);
+	int SectorX, SectorY, SectorZ;
+	ReadSectorImageHeader(&Image, &SectorX, &SectorY, &SectorZ);
+
+	char TempFileName[4096];
+	snprintf(TempFileName, sizeof(TempFileName), "%s.tmp", FileName);
+
+	TWriteScriptFile Script;
+	Script.open(TempFileName);
+	Script.writeText("# Tibia - graphical Multi-User-Dungeon");
+	Script.writeLn();
+	Script.writeText("# Data for sector ");
+	Script.writeNumber(SectorX);
+	Script.writeText("/");
+	Script.writeNumber(SectorY);
+	Script.writeText("/");
+	Script.writeNumber(SectorZ);
+	Script.writeLn();
+	Script.writeLn();
+
+	while(!Image.eof()){
+		int OffsetX = (int)Image.readByte();
+		int OffsetY = (int)Image.readByte();
+		uint8 Flags = Image.readByte();
+		int ContentSize = (int)Image.readQuad();
+		if(ContentSize < 0 || ContentSize > (Image.Size - Image.Position)){
+			throw "corrupt sector image";
+		}
+
+		if(Flags == 0 && ContentSize == 0){
+			continue;
+		}
+
+		Script.writeNumber(OffsetX);
+		Script.writeText("-");
+		Script.writeNumber(OffsetY);
+		Script.writeText(": ");
+
+		int AttrCount = 0;
+
+		if(Flags & 1){
+			if(AttrCount > 0){
+				Script.writeText(", ");
 			}
+			Script.writeText("Refresh");
+			AttrCount += 1;
+		}
 
-			if(Script.Token != IDENTIFIER){
-				Script.error("next map point expected");
+		if(Flags & 2){
+			if(AttrCount > 0){
+				Script.writeText(", ");
 			}
+			Script.writeText("NoLogout");
+			AttrCount += 1;
+		}
 
-			if(OffsetX == -1 || OffsetY == -1){
-				Script.error("coordinate expected");
+		if(Flags & 4){
+			if(AttrCount > 0){
+				Script.writeText(", ");
 			}
+			Script.writeText("ProtectionZone");
+			AttrCount += 1;
+		}
 
-			const char *Identifier = Script.getIdentifier();
-			if(strcmp(Identifier, "refresh") == 0){
-				LoadingSector->MapFlags |= 1;
-				AccessObject(LoadingSector->MapCon[OffsetX][OffsetY])->Attributes[3] |= 0x100;
-			}else if(strcmp(Identifier, "nologout") == 0){
-				LoadingSector->MapFlags |= 2;
-				AccessObject(LoadingSector->MapCon[OffsetX][OffsetY])->Attributes[3] |= 0x200;
-			}else if(strcmp(Identifier, "protectionzone") == 0){
-				LoadingSector->MapFlags |= 4;
-				AccessObject(LoadingSector->MapCon[OffsetX][OffsetY])->Attributes[3] |= 0x400;
-			}else if(strcmp(Identifier, "content") == 0){
-				Script.readSymbol('=');
-				HelpBuffer.Position = 0;
-				LoadObjects(&Script, &HelpBuffer, false);
-				TReadBuffer ReadBuffer(HelpBuffer.Data, HelpBuffer.Position);
-				LoadObjects(&ReadBuffer, LoadingSector->MapCon[OffsetX][OffsetY]);
-			}else{
-				Script.error("unknown map flag");
+		if(ContentSize > 0){
+			if(AttrCount > 0){
+				Script.writeText(", ");
 			}
+			Script.writeText("Content=");
+			TReadBuffer Content(&Image.Data[Image.Position], ContentSize);
+			SaveObjects(&Content, &Script);
+			Image.skip(ContentSize);
+			AttrCount += 1;
 		}
+
+		Script.writeLn();
+	}
+
+	int Bytes = (int)ftell(Script.File);
+	Script.close();
+	ReplaceFile(TempFileName, FileName);
+	return Bytes;
+}
+
+static void GetSectorImageFileName(char *Buffer, int BufferSize, char *FileName){
+	int BaseLength = (int)strlen(FileName);
+	if(const char *FileExt = findLast(FileName, '.')){
+		BaseLength = (int)(FileExt - FileName);
+	}
+
+	snprintf(Buffer, BufferSize, "%.*s.bsec", BaseLength, FileName);
+}
+
+static void LoadSectorImage(const uint8 *Data, int Size, int SectorX, int SectorY, int SectorZ){
+	TReadBuffer Image(Data, Size);
+	int ImageX, ImageY, ImageZ;
+	ReadSectorImageHeader(&Image, &ImageX, &ImageY, &ImageZ);
+	if(ImageX != SectorX || ImageY != SectorY || ImageZ != SectorZ){
+		throw "sector image coordinates mismatch";
+	}
+
+	InitSector(SectorX, SectorY, SectorZ);
+
+	ASSERT(Sector != NULL);
+	TSector *LoadingSector = *Sector->at(SectorX, SectorY, SectorZ);
+	ASSERT(LoadingSector != NULL);
+
+	while(!Image.eof()){
+		int OffsetX = (int)Image.readByte();
+		int OffsetY = (int)Image.readByte();
+		uint8 Flags = Image.readByte() & 7;
+		int ContentSize = (int)Image.readQuad();
+		if(OffsetX >= 32 || OffsetY >= 32 || ContentSize < 0
+				|| ContentSize > (Image.Size - Image.Position)){
+			throw "corrupt sector image";
+		}
+
+		Object MapCon = LoadingSector->MapCon[OffsetX][OffsetY];
+		if(Flags != 0){
+			LoadingSector->MapFlags |= Flags;
+			AccessObject(MapCon)->Attributes[3] |= ((uint32)Flags << 8);
+		}
+
+		if(ContentSize > 0){
+			TReadBuffer Content(&Image.Data[Image.Position], ContentSize);
+			LoadObjects(&Content, MapCon);
+			Image.skip(ContentSize);
+		}
+	}
+
+	// NOTE(fusion): The sector matches its file now.
+	LoadingSector->DirtyGeneration = 0;
+}
+
+void LoadSector(const char *FileName, int SectorX, int SectorY, int SectorZ){
+	if(SectorX < SectorXMin || SectorXMax < SectorX
+			|| SectorY < SectorYMin || SectorYMax < SectorY
+			|| SectorZ < SectorZMin || SectorZMax < SectorZ){
+		return;
+	}
+
+	try{
+		print(1, "Lade Sektor %d/%d/%d ...\n", SectorX, SectorY, SectorZ);
+		ImageBuffer.Position = 0;
+		ParseSectorText(FileName, SectorX, SectorY, SectorZ, &ImageBuffer, &HelpBuffer);
+		LoadSectorImage(ImageBuffer.Data, ImageBuffer.Position, SectorX, SectorY, SectorZ);
 	}catch(const char *str){
 		error("LoadSector: Kann Datei \"%s\" nicht lesen.\n", FileName);
 		error("# Fehler: %s\n", str);
@@ -1008,40 +1707,366 @@ void LoadSector(const char *FileName, int SectorX, int SectorY, int SectorZ){
 	}
 }
 
-void LoadMap(void){
-	DIR *MapDir = opendir(MAPPATH);
-	if(MapDir == NULL){
-		error("LoadMap: Unterverzeichnis %s nicht gefunden\n", MAPPATH);
-		throw "Cannot load map";
+// Map Loading
+// =============================================================================
+// NOTE(fusion): Sector files are read and decoded into sector images by a small
+// pool of loading threads, while the main thread turns finished images into
+// objects in file order. Object creation, the hash table, and the cron heap are
+// not thread safe, so that last step stays single threaded. It is also short
+// since it is just a walk over an in-memory object stream.
+//	A text sector is converted into an image on the fly and the image is written
+// back as ".bsec", which is then preferred on the next start for as long as it
+// is at least as new as its ".sec" file. An image without a text file gets its
+// ".sec" regenerated so the text map remains the editable source. An image that
+// fails `CheckSectorImage` is replaced the same way from its ".sec" file, if any.
+//	Script errors share a static message buffer (see `ErrorString` in script.cc)
+// so concurrent failures may garble the reported message, but any failure will
+// still abort the load.
+static int CompareSectorFiles(const void *A, const void *B){
+	const TSectorFile *FileA = (const TSectorFile*)A;
+	const TSectorFile *FileB = (const TSectorFile*)B;
+	if(FileA->SectorZ != FileB->SectorZ){
+		return FileA->SectorZ - FileB->SectorZ;
+	}else if(FileA->SectorY != FileB->SectorY){
+		return FileA->SectorY - FileB->SectorY;
+	}else{
+		return FileA->SectorX - FileB->SectorX;
 	}
+}
 
-	print(1, "Lade Karte ...\n");
-	ObjectCounter = 0;
+static void ReleaseSectorFile(TSectorFile *File){
+	if(File->Data != NULL){
+		if(File->Mapped){
+			munmap(File->Data, (usize)File->Size);
+		}else{
+			free(File->Data);
+		}
+		File->Data = NULL;
+		File->Size = 0;
+	}
+}
 
-	int SectorCounter = 0;
+static void MapSectorImage(TSectorFile *File){
+	char FileName[4096];
+	snprintf(FileName, sizeof(FileName), "%s/%s.bsec", MAPPATH, File->Name);
+
+	int fd = open(FileName, O_RDONLY);
+	if(fd == -1){
+		throw "cannot open sector image";
+	}
+
+	struct stat Stat;
+	if(fstat(fd, &Stat) == -1 || Stat.st_size <= 0 || Stat.st_size > INT_MAX){
+		close(fd);
+		throw "invalid sector image size";
+	}
+
+	void *Data = mmap(NULL, (usize)Stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(Data == MAP_FAILED){
+		throw "cannot map sector image";
+	}
+
+	madvise(Data, (usize)Stat.st_size, MADV_SEQUENTIAL);
+	File->Data = (uint8*)Data;
+	File->Size = (int)Stat.st_size;
+	File->Mapped = true;
+
+	CheckSectorImage(File->Data, File->Size, File->SectorX, File->SectorY, File->SectorZ);
+
+	if(!File->HasText){
+		char TextFileName[4096];
+		snprintf(TextFileName, sizeof(TextFileName), "%s/%s.sec", MAPPATH, File->Name);
+		WriteSectorText(TextFileName, File->Data, File->Size);
+
+		// NOTE(fusion): Keep the image newer than the text we just generated.
+		utime(FileName, NULL);
+	}
+}
+
+static void ParseSectorFile(TSectorFile *File, TDynamicWriteBuffer *Image, TDynamicWriteBuffer *Content){
 	char FileName[4096];
+	snprintf(FileName, sizeof(FileName), "%s/%s.sec", MAPPATH, File->Name);
+
+	Image->Position = 0;
+	ParseSectorText(FileName, File->SectorX, File->SectorY, File->SectorZ, Image, Content);
+
+	File->Data = (uint8*)malloc(Image->Position);
+	File->Size = Image->Position;
+	File->Mapped = false;
+	memcpy(File->Data, Image->Data, Image->Position);
+
+	snprintf(FileName, sizeof(FileName), "%s/%s.bsec", MAPPATH, File->Name);
+	try{
+		WriteSectorImage(FileName, Image->Data, Image->Position);
+	}catch(const char *str){
+		error("LoadMap: Kann Sektorabbild %s nicht schreiben.\n", FileName);
+		error("# Fehler: %s\n", str);
+	}
+}
+
+static int LoadMapThread(void *Unused){
+	TDynamicWriteBuffer Image(KB(64));
+	TDynamicWriteBuffer Content(KB(16));
+	while(true){
+		int Index = -1;
+		LoadMapMutex.down();
+		if(!LoadMapAbort && NextSectorFile < SectorFileCount){
+			Index = NextSectorFile;
+			NextSectorFile += 1;
+		}
+		LoadMapMutex.up();
+
+		if(Index == -1){
+			break;
+		}
+
+		TSectorFile *File = &SectorFiles[Index];
+		int State = SECTOR_FILE_READY;
+		try{
+			if(File->UseBinary){
+				try{
+					MapSectorImage(File);
+				}catch(const char *str){
+					if(!File->HasText){
+						throw;
+					}
+
+					// NOTE(fusion): The image is only a cache of the text file,
+					// so fall back to it, which also writes a new image.
+					error("LoadMap: Kann Sektorabbild %s/%s.bsec nicht laden.\n",
+							MAPPATH, File->Name);
+					error("# Fehler: %s\n", str);
+					error("LoadMap: Verwende Textdatei für Sektor %d/%d/%d.\n",
+							File->SectorX, File->SectorY, File->SectorZ);
+					ReleaseSectorFile(File);
+					File->UseBinary = false;
+				}
+			}
+
+			if(!File->UseBinary){
+				ParseSectorFile(File, &Image, &Content);
+			}
+		}catch(const char *str){
+			snprintf(File->Error, sizeof(File->Error), "%s", str);
+			State = SECTOR_FILE_FAILED;
+		}
+
+		LoadMapMutex.down();
+		File->State = State;
+		LoadMapMutex.up();
+		LoadMapDone.up();
+	}
+
+	return 0;
+}
+
+static int WaitSectorFile(TSectorFile *File){
+	while(true){
+		LoadMapMutex.down();
+		int State = File->State;
+		LoadMapMutex.up();
+		if(State != SECTOR_FILE_PENDING){
+			return State;
+		}
+
+		LoadMapDone.down();
+	}
+}
+
+static void CollectSectorFiles(DIR *MapDir){
+	int Capacity = 1024;
+	SectorFiles = (TSectorFile*)malloc(Capacity * sizeof(TSectorFile));
+	SectorFileCount = 0;
 	while(dirent *DirEntry = readdir(MapDir)){
 		if(DirEntry->d_type != DT_REG){
 			continue;
 		}
 
 		// NOTE(fusion): See note in `DeleteSwappedSectors`.
-		const char *FileExt = findLast(DirEntry->d_name, '.');
-		if(FileExt == NULL || strcmp(FileExt, ".sec") != 0){
+		char *FileExt = findLast(DirEntry->d_name, '.');
+		if(FileExt == NULL){
+			continue;
+		}
+
+		bool Binary = (strcmp(FileExt, ".bsec") == 0);
+		if(!Binary && strcmp(FileExt, ".sec") != 0){
 			continue;
 		}
 
 		int SectorX, SectorY, SectorZ;
-		if(sscanf(DirEntry->d_name, "%d-%d-%d.sec", &SectorX, &SectorY, &SectorZ) == 3){
-			snprintf(FileName, sizeof(FileName), "%s/%s", MAPPATH, DirEntry->d_name);
-			LoadSector(FileName, SectorX, SectorY, SectorZ);
-			SectorCounter += 1;
+		if(sscanf(DirEntry->d_name, "%d-%d-%d.", &SectorX, &SectorY, &SectorZ) != 3){
+			continue;
 		}
+
+		if(SectorX < SectorXMin || SectorXMax < SectorX
+				|| SectorY < SectorYMin || SectorYMax < SectorY
+				|| SectorZ < SectorZMin || SectorZMax < SectorZ){
+			continue;
+		}
+
+		if(SectorFileCount >= Capacity){
+			Capacity *= 2;
+			SectorFiles = (TSectorFile*)realloc(SectorFiles, Capacity * sizeof(TSectorFile));
+		}
+
+		TSectorFile *File = &SectorFiles[SectorFileCount];
+		memset(File, 0, sizeof(TSectorFile));
+		File->SectorX = SectorX;
+		File->SectorY = SectorY;
+		File->SectorZ = SectorZ;
+		File->HasText = !Binary;
+		File->HasBinary = Binary;
+		File->State = SECTOR_FILE_PENDING;
+		snprintf(File->Name, sizeof(File->Name), "%.*s",
+				(int)(FileExt - DirEntry->d_name), DirEntry->d_name);
+		SectorFileCount += 1;
+	}
+
+	// NOTE(fusion): Merge the text and binary entries of each sector and choose
+	// which one to load. Sorting also makes the load order (and with it object
+	// ids) independent of the directory order.
+	qsort(SectorFiles, SectorFileCount, sizeof(TSectorFile), CompareSectorFiles);
+	int Count = 0;
+	for(int i = 0; i < SectorFileCount; i += 1){
+		TSectorFile *File = &SectorFiles[i];
+		if(Count > 0 && CompareSectorFiles(&SectorFiles[Count - 1], File) == 0){
+			TSectorFile *Prev = &SectorFiles[Count - 1];
+			if(strcmp(Prev->Name, File->Name) != 0){
+				error("LoadMap: Sektor %d/%d/%d ist mehrfach vorhanden (%s, %s).\n",
+						File->SectorX, File->SectorY, File->SectorZ, Prev->Name, File->Name);
+				throw "Cannot load map";
+			}
+
+			Prev->HasText = Prev->HasText || File->HasText;
+			Prev->HasBinary = Prev->HasBinary || File->HasBinary;
+			continue;
+		}
+
+		if(Count != i){
+			SectorFiles[Count] = *File;
+		}
+		Count += 1;
+	}
+	SectorFileCount = Count;
+
+	char FileName[4096];
+	for(int i = 0; i < SectorFileCount; i += 1){
+		TSectorFile *File = &SectorFiles[i];
+		File->UseBinary = !File->HasText;
+		if(File->HasText && File->HasBinary){
+			timespec TextTime, BinaryTime;
+			snprintf(FileName, sizeof(FileName), "%s/%s.sec", MAPPATH, File->Name);
+			bool TextExists = GetFileModificationTime(FileName, &TextTime);
+			snprintf(FileName, sizeof(FileName), "%s/%s.bsec", MAPPATH, File->Name);
+			bool BinaryExists = GetFileModificationTime(FileName, &BinaryTime);
+			File->UseBinary = TextExists && BinaryExists
+				&& (BinaryTime.tv_sec > TextTime.tv_sec
+					|| (BinaryTime.tv_sec == TextTime.tv_sec
+						&& BinaryTime.tv_nsec >= TextTime.tv_nsec));
+		}
+	}
+}
+
+void LoadMap(void){
+	DIR *MapDir = opendir(MAPPATH);
+	if(MapDir == NULL){
+		error("LoadMap: Unterverzeichnis %s nicht gefunden\n", MAPPATH);
+		throw "Cannot load map";
 	}
 
+	print(1, "Lade Karte ...\n");
+	ObjectCounter = 0;
+	uint64 StartTime = GetMonotonicMilliseconds();
+
+	try{
+		CollectSectorFiles(MapDir);
+	}catch(const char*){
+		closedir(MapDir);
+		free(SectorFiles);
+		SectorFiles = NULL;
+		SectorFileCount = 0;
+		throw;
+	}
 	closedir(MapDir);
-	print(1, "%d Sektoren geladen.\n", SectorCounter);
+
+	int Threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	Threads = std::max<int>(1, std::min<int>(Threads, 8));
+	Threads = std::min<int>(Threads, SectorFileCount);
+
+	NextSectorFile = 0;
+	LoadMapAbort = false;
+	ThreadHandle LoadingThread[8];
+	int LoadingThreads = 0;
+	for(int i = 0; i < Threads; i += 1){
+		ThreadHandle Handle = StartThread(LoadMapThread, NULL, false);
+		if(Handle == INVALID_THREAD_HANDLE){
+			error("LoadMap: Kann Ladethread nicht starten.\n");
+			break;
+		}
+		LoadingThread[LoadingThreads] = Handle;
+		LoadingThreads += 1;
+	}
+
+	// NOTE(fusion): Without any loading thread, just decode everything up front.
+	if(LoadingThreads == 0 && SectorFileCount > 0){
+		LoadMapThread(NULL);
+	}
+
+	bool Failed = false;
+	int BinaryCounter = 0;
+	for(int i = 0; i < SectorFileCount; i += 1){
+		TSectorFile *File = &SectorFiles[i];
+		const char *Error = NULL;
+		if(WaitSectorFile(File) == SECTOR_FILE_FAILED){
+			Error = File->Error;
+		}else{
+			try{
+				print(1, "Lade Sektor %d/%d/%d ...\n", File->SectorX, File->SectorY, File->SectorZ);
+				LoadSectorImage(File->Data, File->Size, File->SectorX, File->SectorY, File->SectorZ);
+			}catch(const char *str){
+				Error = str;
+			}
+		}
+
+		if(Error != NULL){
+			error("LoadSector: Kann Datei \"%s/%s.%s\" nicht lesen.\n",
+					MAPPATH, File->Name, (File->UseBinary ? "bsec" : "sec"));
+			error("# Fehler: %s\n", Error);
+			Failed = true;
+			break;
+		}
+
+		if(File->UseBinary){
+			BinaryCounter += 1;
+		}
+
+		ReleaseSectorFile(File);
+	}
+
+	LoadMapMutex.down();
+	LoadMapAbort = true;
+	LoadMapMutex.up();
+	for(int i = 0; i < LoadingThreads; i += 1){
+		JoinThread(LoadingThread[i]);
+	}
+
+	int SectorCounter = SectorFileCount;
+	for(int i = 0; i < SectorFileCount; i += 1){
+		ReleaseSectorFile(&SectorFiles[i]);
+	}
+	free(SectorFiles);
+	SectorFiles = NULL;
+	SectorFileCount = 0;
+
+	if(Failed){
+		throw "Cannot load sector";
+	}
+
+	print(1, "%d Sektoren geladen (%d aus Sektorabbildern).\n", SectorCounter, BinaryCounter);
 	print(1, "%d Objekte geladen.\n", ObjectCounter);
+	print(1, "Karte in %d ms mit %d Threads geladen.\n",
+			(int)(GetMonotonicMilliseconds() - StartTime), LoadingThreads);
 }
 
 void SaveObjects(Object Obj, TWriteStream *Stream, bool Stop){
@@ -1187,93 +2212,144 @@ void SaveObjects(TReadStream *Stream, TWriteScriptFile *Script){
 	}
 }
 
-void SaveSector(char *FileName, int SectorX, int SectorY, int SectorZ){
+int SaveSector(char *FileName, int SectorX, int SectorY, int SectorZ){
 	ASSERT(Sector);
 	TSector *SavingSector = *Sector->at(SectorX, SectorY, SectorZ);
 	if(!SavingSector){
-		return;
+		return 0;
 	}
 
-	bool Empty = true;
-	TWriteScriptFile Script;
+	char ImageFileName[4096];
+	GetSectorImageFileName(ImageFileName, sizeof(ImageFileName), FileName);
+
 	try{
-		Script.open(FileName);
 		print(1, "Speichere Sektor %d/%d/%d ...\n", SectorX, SectorY, SectorZ);
 
-		Script.writeText("# Tibia - graphical Multi-User-Dungeon");
-		Script.writeLn();
-		Script.writeText("# Data for sector ");
-		Script.writeNumber(SectorX);
-		Script.writeText("/");
-		Script.writeNumber(SectorY);
-		Script.writeText("/");
-		Script.writeNumber(SectorZ);
-		Script.writeLn();
-		Script.writeLn();
-
+		bool Empty = true;
+		ImageBuffer.Position = 0;
+		WriteSectorImageHeader(&ImageBuffer, SectorX, SectorY, SectorZ);
 		for(int X = 0; X < 32; X += 1){
 			for(int Y = 0; Y < 32; Y += 1){
 				Object First = Object(SavingSector->MapCon[X][Y].getAttribute(CONTENT));
 				uint8 Flags = GetMapContainerFlags(SavingSector->MapCon[X][Y]);
 				if(First != NONE || Flags != 0){
-					Script.writeNumber(X);
-					Script.writeText("-");
-					Script.writeNumber(Y);
-					Script.writeText(": ");
-
-					int AttrCount = 0;
-
-					if(Flags & 1){
-						if(AttrCount > 0){
-							Script.writeText(", ");
-						}
-						Script.writeText("Refresh");
-						AttrCount += 1;
-					}
-
-					if(Flags & 2){
-						if(AttrCount > 0){
-							Script.writeText(", ");
-						}
-						Script.writeText("NoLogout");
-						AttrCount += 1;
-					}
-
-					if(Flags & 4){
-						if(AttrCount > 0){
-							Script.writeText(", ");
-						}
-						Script.writeText("ProtectionZone");
-						AttrCount += 1;
-					}
-
+					HelpBuffer.Position = 0;
 					if(First != NONE){
-						if(AttrCount > 0){
-							Script.writeText(", ");
-						}
-						Script.writeText("Content=");
-						HelpBuffer.Position = 0;
 						SaveObjects(First, &HelpBuffer, false);
-						TReadBuffer ReadBuffer(HelpBuffer.Data, HelpBuffer.Position);
-						SaveObjects(&ReadBuffer, &Script);
-						AttrCount += 1;
 					}
 
-					Script.writeLn();
+					WriteSectorImagePoint(&ImageBuffer, X, Y, Flags,
+							HelpBuffer.Data, HelpBuffer.Position);
 					Empty = false;
 				}
 			}
 		}
 
-		Script.close();
 		if(Empty){
 			error("SaveSector: Sektor %d/%d/%d ist leer.\n", SectorX, SectorY, SectorZ);
 			unlink(FileName);
+			unlink(ImageFileName);
+			return 0;
 		}
+
+		// NOTE(fusion): Write the image last so it ends up at least as new as
+		// the text file and is picked up by `LoadMap`.
+		int Bytes = WriteSectorText(FileName, ImageBuffer.Data, ImageBuffer.Position);
+		WriteSectorImage(ImageFileName, ImageBuffer.Data, ImageBuffer.Position);
+		return Bytes + ImageBuffer.Position;
 	}catch(const char *str){
 		error("SaveSector: Kann Datei %s nicht schreiben.\n", FileName);
 		error("# Fehler: %s\n", str);
+		return -1;
+	}
+}
+
+// NOTE(fusion): Sector files store the remaining expire time of objects in the
+// cron system, which changes every round without the object itself changing.
+// Sectors holding any such object are marked as modified before a save so their
+// files don't keep stale expire times. Swapped objects are matched to their
+// sector through the swap file number, without swapping them in.
+static void MarkExpiringSectorsDirty(void){
+	vector<uint32> SwappedFiles(0, 256, 256);
+	int NumberOfSwappedFiles = 0;
+	for(int Position = 1; Position <= CronEntries; Position += 1){
+		Object Obj = CronEntry.at(Position)->Obj;
+		uint32 EntryIndex = HashTableIndex(Obj.ObjectID);
+		if(HashTableType[EntryIndex] == STATUS_SWAPPED){
+			*SwappedFiles.at(NumberOfSwappedFiles) =
+					(uint32)SwappedFileNumber(HashTableData[EntryIndex]);
+			NumberOfSwappedFiles += 1;
+		}else if(HashTableType[EntryIndex] == STATUS_LOADED
+				&& HashTableData[EntryIndex]->ObjectID == Obj.ObjectID){
+			MarkObjectDirty(Obj);
+		}
+	}
+
+	if(NumberOfSwappedFiles == 0){
+		return;
+	}
+
+	uint32 *First = SwappedFiles.at(0);
+	uint32 *Last = First + NumberOfSwappedFiles;
+	std::sort(First, Last);
+	for(int SectorZ = SectorZMin; SectorZ <= SectorZMax; SectorZ += 1)
+	for(int SectorY = SectorYMin; SectorY <= SectorYMax; SectorY += 1)
+	for(int SectorX = SectorXMin; SectorX <= SectorXMax; SectorX += 1){
+		TSector *Sec = *Sector->at(SectorX, SectorY, SectorZ);
+		if(Sec != NULL && Sec->Status == STATUS_SWAPPED
+				&& std::binary_search(First, Last, Sec->FileNumber)){
+			MarkSectorDirty(Sec);
+		}
+	}
+}
+
+// NOTE(fusion): Writes every sector modified up to `Generation` and returns
+// whether all of them could be saved.
+static bool SaveDirtySectors(uint32 Generation, bool ReportProgress){
+	uint64 StartTime = GetMonotonicMilliseconds();
+	int Total = 0;
+	for(int SectorZ = SectorZMin; SectorZ <= SectorZMax; SectorZ += 1)
+	for(int SectorY = SectorYMin; SectorY <= SectorYMax; SectorY += 1)
+	for(int SectorX = SectorXMin; SectorX <= SectorXMax; SectorX += 1){
+		TSector *Sec = *Sector->at(SectorX, SectorY, SectorZ);
+		if(Sec != NULL && Sec->DirtyGeneration != 0 && Sec->DirtyGeneration <= Generation){
+			Total += 1;
+		}
+	}
+
+	bool Result = true;
+	int SectorCounter = 0;
+	uint64 ByteCounter = 0;
+	char FileName[4096];
+	for(int SectorZ = SectorZMin; SectorZ <= SectorZMax; SectorZ += 1)
+	for(int SectorY = SectorYMin; SectorY <= SectorYMax; SectorY += 1)
+	for(int SectorX = SectorXMin; SectorX <= SectorXMax; SectorX += 1){
+		TSector *Sec = *Sector->at(SectorX, SectorY, SectorZ);
+		if(Sec == NULL || Sec->DirtyGeneration == 0 || Sec->DirtyGeneration > Generation){
+			continue;
+		}
+
+		snprintf(FileName, sizeof(FileName), "%s/%04d-%04d-%02d.sec",
+				MAPPATH, SectorX, SectorY, SectorZ);
+		int Bytes = SaveSector(FileName, SectorX, SectorY, SectorZ);
+		if(Bytes >= 0){
+			Sec->DirtyGeneration = 0;
+			SectorCounter += 1;
+			ByteCounter += (uint64)Bytes;
+		}else{
+			Result = false;
+		}
+
+		if(ReportProgress){
+			SetSnapshotProgress(SectorCounter, Total);
+		}
 	}
+
+	print(1, "%d Objekte in geänderten Sektoren gespeichert.\n", ObjectCounter);
+	print(1, "%d Sektoren mit %u KB in %d ms gespeichert.\n", SectorCounter,
+			(uint32)(ByteCounter / 1024),
+			(int)(GetMonotonicMilliseconds() - StartTime));
+	return Result;
 }
 
 void SaveMap(void){
@@ -1291,20 +2367,136 @@ void SaveMap(void){
 	print(1, "Speichere Karte ...\n");
 	ObjectCounter = 0;
 
+	// NOTE(fusion): Only sectors modified since the last save are written. The
+	// generation is advanced first, so any sector modified while saving stays
+	// dirty for the next one.
+	MarkExpiringSectorsDirty();
+	uint32 Generation = SaveGeneration;
+	SaveGeneration += 1;
+	SaveDirtySectors(Generation, false);
+	SavingMap = false;
+}
+
+// NOTE(fusion): Snapshot saves run in a forked process, see `StartSnapshotSave`
+// in main.cc. The snapshot process must not swap sectors in because that would
+// consume swap files the game process still needs, so dirty sectors that are
+// swapped out are moved to the next generation and left for a later save. The
+// snapshot process then saves everything up to the returned generation and the
+// game process clears those sectors with `EndMapSnapshot` once it succeeded.
+uint32 BeginMapSnapshot(void){
+	MarkExpiringSectorsDirty();
+	uint32 Generation = SaveGeneration;
+	SaveGeneration += 1;
+	for(int SectorZ = SectorZMin; SectorZ <= SectorZMax; SectorZ += 1)
+	for(int SectorY = SectorYMin; SectorY <= SectorYMax; SectorY += 1)
+	for(int SectorX = SectorXMin; SectorX <= SectorXMax; SectorX += 1){
+		TSector *Sec = *Sector->at(SectorX, SectorY, SectorZ);
+		if(Sec != NULL && Sec->Status != STATUS_LOADED && Sec->DirtyGeneration != 0){
+			Sec->DirtyGeneration = SaveGeneration;
+		}
+	}
+	return Generation;
+}
+
+bool SaveMapSnapshot(uint32 Generation){
+	print(1, "Speichere Karte (Schnappschuss) ...\n");
+	ObjectCounter = 0;
+	return SaveDirtySectors(Generation, true);
+}
+
+void EndMapSnapshot(uint32 Generation, bool Saved){
+	if(!Saved){
+		return;
+	}
+
+	for(int SectorZ = SectorZMin; SectorZ <= SectorZMax; SectorZ += 1)
+	for(int SectorY = SectorYMin; SectorY <= SectorYMax; SectorY += 1)
+	for(int SectorX = SectorXMin; SectorX <= SectorXMax; SectorX += 1){
+		TSector *Sec = *Sector->at(SectorX, SectorY, SectorZ);
+		if(Sec != NULL && Sec->DirtyGeneration != 0 && Sec->DirtyGeneration <= Generation){
+			Sec->DirtyGeneration = 0;
+		}
+	}
+}
+
+// Map Refresh
+// =============================================================================
+// NOTE(fusion): The refreshable points of each sector are parsed from ORIGMAP
+// once at startup and kept in memory as sector image points, so refreshing a
+// sector is just a walk over that buffer, without any file access. ORIGMAP only
+// changes through `PatchSector`, which reloads the data of the patched sector.
+static void LoadRefreshData(TSector *Sec){
+	free(Sec->RefreshData);
+	Sec->RefreshData = NULL;
+	Sec->RefreshSize = 0;
+	if((Sec->MapFlags & 0x01) == 0){
+		return;
+	}
+
 	char FileName[4096];
+	snprintf(FileName, sizeof(FileName), "%s/%04d-%04d-%02d.sec",
+			ORIGMAPPATH, Sec->SectorX, Sec->SectorY, Sec->SectorZ);
+	if(!FileExists(FileName)){
+		return;
+	}
+
+	try{
+		ImageBuffer.Position = 0;
+		ParseSectorText(FileName, Sec->SectorX, Sec->SectorY, Sec->SectorZ,
+				&ImageBuffer, &HelpBuffer);
+
+		// NOTE(fusion): `HelpBuffer` is free again once the text is parsed.
+		TReadBuffer Image(ImageBuffer.Data, ImageBuffer.Position);
+		int ImageX, ImageY, ImageZ;
+		ReadSectorImageHeader(&Image, &ImageX, &ImageY, &ImageZ);
+		HelpBuffer.Position = 0;
+		while(!Image.eof()){
+			int OffsetX = (int)Image.readByte();
+			int OffsetY = (int)Image.readByte();
+			uint8 Flags = Image.readByte();
+			int ContentSize = (int)Image.readQuad();
+			if((Flags & 0x01) != 0 && ContentSize > 0){
+				WriteSectorImagePoint(&HelpBuffer, OffsetX, OffsetY, Flags,
+						&Image.Data[Image.Position], ContentSize);
+			}
+			Image.skip(ContentSize);
+		}
+	}catch(const char *str){
+		error("LoadRefreshData: Kann Datei \"%s\" nicht lesen.\n", FileName);
+		error("# Fehler: %s\n", str);
+		return;
+	}
+
+	if(HelpBuffer.Position > 0){
+		Sec->RefreshData = (uint8*)malloc(HelpBuffer.Position);
+		Sec->RefreshSize = HelpBuffer.Position;
+		memcpy(Sec->RefreshData, HelpBuffer.Data, HelpBuffer.Position);
+	}
+}
+
+static void LoadRefreshData(void){
+	print(1, "Lade Refresh-Daten ...\n");
+	uint64 StartTime = GetMonotonicMilliseconds();
+	int SectorCounter = 0;
+	int ByteCounter = 0;
 	for(int SectorZ = SectorZMin; SectorZ <= SectorZMax; SectorZ += 1)
 	for(int SectorY = SectorYMin; SectorY <= SectorYMax; SectorY += 1)
 	for(int SectorX = SectorXMin; SectorX <= SectorXMax; SectorX += 1){
-		snprintf(FileName, sizeof(FileName), "%s/%04d-%04d-%02d.sec",
-				MAPPATH, SectorX, SectorY, SectorZ);
-		SaveSector(FileName, SectorX, SectorY, SectorZ);
+		TSector *Sec = *Sector->at(SectorX, SectorY, SectorZ);
+		if(Sec != NULL){
+			LoadRefreshData(Sec);
+			if(Sec->RefreshData != NULL){
+				SectorCounter += 1;
+				ByteCounter += Sec->RefreshSize;
+			}
+		}
 	}
 
-	print(1, "%d Objekte gespeichert.\n", ObjectCounter);
-	SavingMap = false;
+	print(1, "Refresh-Daten für %d Sektoren geladen (%d Bytes, %d ms).\n",
+			SectorCounter, ByteCounter, (int)(GetMonotonicMilliseconds() - StartTime));
 }
 
-void RefreshSector(int SectorX, int SectorY, int SectorZ, TReadStream *Stream){
+void RefreshSector(int SectorX, int SectorY, int SectorZ, bool SkipHouses){
 	// NOTE(fusion): `matrix3d::at` would return the first entry if coordinates
 	// are out of bounds which could be a problem here.
 	if(SectorX < SectorXMin || SectorXMax < SectorX
@@ -1317,36 +2509,70 @@ void RefreshSector(int SectorX, int SectorY, int SectorZ, TReadStream *Stream){
 
 	ASSERT(Sector);
 	TSector *Sec = *Sector->at(SectorX, SectorY, SectorZ);
-	if(Sec == NULL || (Sec->MapFlags & 0x01) == 0){
+	if(Sec == NULL || (Sec->MapFlags & 0x01) == 0 || Sec->RefreshData == NULL){
 		return;
 	}
 
 	print(3, "Refreshe Sektor %d/%d/%d ...\n", SectorX, SectorY, SectorZ);
+	uint64 StartTime = GetMonotonicMicroseconds();
 	try{
-		while(!Stream->eof()){
-			uint8 OffsetX = Stream->readByte();
-			uint8 OffsetY = Stream->readByte();
-			if(OffsetX < 32 && OffsetY < 32){
-				Object Con = Sec->MapCon[OffsetX][OffsetY];
+		TReadBuffer Image(Sec->RefreshData, Sec->RefreshSize);
+		while(!Image.eof()){
+			int OffsetX = (int)Image.readByte();
+			int OffsetY = (int)Image.readByte();
+			Image.readByte(); // Flags
+			int ContentSize = (int)Image.readQuad();
+			if(OffsetX >= 32 || OffsetY >= 32 || ContentSize < 0
+					|| ContentSize > (Image.Size - Image.Position)){
+				throw "corrupt refresh data";
+			}
 
-				// TODO(fusion): This loop was done a bit differently but I suppose
-				// iterating it directly is clearer and as long as we don't access
-				// the object after `DeleteObject`, it should work the same.
-				Object Obj = Object(Con.getAttribute(CONTENT));
-				while(Obj != NONE){
-					Object Next = Obj.getNextObject();
-					if(!Obj.getObjectType().isCreatureContainer()){
-						DeleteObject(Obj);
-					}
-					Obj = Next;
-				}
+			if(SkipHouses && GetHouseID(SectorX * 32 + OffsetX,
+					SectorY * 32 + OffsetY, SectorZ) != 0){
+				Image.skip(ContentSize);
+				continue;
+			}
+
+			Object Con = Sec->MapCon[OffsetX][OffsetY];
 
-				LoadObjects(Stream, Con);
+			// TODO(fusion): This loop was done a bit differently but I suppose
+			// iterating it directly is clearer and as long as we don't access
+			// the object after `DeleteObject`, it should work the same.
+			Object Obj = Object(Con.getAttribute(CONTENT));
+			while(Obj != NONE){
+				Object Next = Obj.getNextObject();
+				if(!Obj.getObjectType().isCreatureContainer()){
+					DeleteObject(Obj);
+				}
+				Obj = Next;
 			}
+
+			TReadBuffer Content(&Image.Data[Image.Position], ContentSize);
+			LoadObjects(&Content, Con);
+			Image.skip(ContentSize);
+			RefreshFieldCount += 1;
 		}
 	}catch(const char *str){
 		error("RefreshSector: Fehler beim Auslesen der Daten (%s).\n", str);
 	}
+
+	uint64 Time = GetMonotonicMicroseconds() - StartTime;
+	RefreshSectorCount += 1;
+	RefreshTime += Time;
+	if(RefreshMaxTime < Time){
+		RefreshMaxTime = Time;
+	}
+}
+
+void RefreshSummary(void){
+	if(RefreshSectorCount > 0){
+		Log("refresh", "%d Sektoren mit %d Feldern refresht (%u us gesamt, %u us max).\n",
+				RefreshSectorCount, RefreshFieldCount, (uint32)RefreshTime, (uint32)RefreshMaxTime);
+	}
+	RefreshSectorCount = 0;
+	RefreshFieldCount = 0;
+	RefreshTime = 0;
+	RefreshMaxTime = 0;
 }
 
 void PatchSector(int SectorX, int SectorY, int SectorZ, bool FullSector,
@@ -1368,6 +2594,7 @@ void PatchSector(int SectorX, int SectorY, int SectorZ, bool FullSector,
 		Sec = *Sector->at(SectorX, SectorY, SectorZ);
 		ASSERT(Sec != NULL);
 	}
+	MarkSectorDirty(Sec);
 
 	bool FieldTreated[32][32] = {};
 	bool FieldPatched[32][32] = {};
@@ -1708,6 +2935,8 @@ void PatchSector(int SectorX, int SectorY, int SectorZ, bool FullSector,
 		error("# Fehler %d: %s.\n", ErrCode, strerror(ErrCode));
 		throw "cannot patch ORIGMAP";
 	}
+
+	LoadRefreshData(Sec);
 }
 
 void InitMap(void){
@@ -1748,6 +2977,8 @@ void InitMap(void){
 	HashTableType = (uint8*)malloc(HashTableSize * sizeof(uint8));
 	memset(HashTableType, 0, HashTableSize * sizeof(uint8));
 	HashTableFree = HashTableSize - 1;
+	HashTableOldMask = HashTableMask;
+	HashTableSplit = HashTableSize;
 	// NOTE(fusion): This is probably reserved for `NONE`.
 	HashTableType[0] = STATUS_PERMANENT;
 	HashTableData[0] = GetFreeObjectSlot();
@@ -1759,6 +2990,7 @@ void InitMap(void){
 	CronEntries = 0;
 
 	LoadMap();
+	LoadRefreshData();
 }
 
 void ExitMap(bool Save){
@@ -1780,12 +3012,18 @@ void ExitMap(bool Save){
 		for(int SectorX = SectorXMin; SectorX <= SectorXMax; SectorX += 1){
 			TSector *CurrentSector = *Sector->at(SectorX, SectorY, SectorZ);
 			if(CurrentSector != NULL){
+				free(CurrentSector->RefreshData);
 				free(CurrentSector);
 			}
 		}
 		delete Sector;
+		Sector = NULL;
 	}
 
+	FirstLoadedSector = NULL;
+	LastLoadedSector = NULL;
+	ClearSwapStaging();
+
 	DeleteSwappedSectors();
 }
 
@@ -1797,9 +3035,9 @@ TObject *AccessObject(Object Obj){
 		return HashTableData[0];
 	}
 
-	uint32 EntryIndex = Obj.ObjectID & HashTableMask;
+	uint32 EntryIndex = HashTableIndex(Obj.ObjectID);
 	if(HashTableType[EntryIndex] == STATUS_SWAPPED){
-		UnswapSector((uintptr)HashTableData[EntryIndex]);
+		UnswapSector(SwappedFileNumber(HashTableData[EntryIndex]));
 	}
 
 	if(HashTableType[EntryIndex] == STATUS_LOADED
@@ -1813,20 +3051,28 @@ TObject *AccessObject(Object Obj){
 Object CreateObject(void){
 	static uint32 NextObjectID = 1;
 
-	// NOTE(fusion): Load factor of 1/16.
-	if(HashTableFree < (HashTableSize / 16)){
+	// NOTE(fusion): Since ids are searched linearly for a free entry, the number
+	// of probes grows quickly with the load factor. Start growing the table when
+	// it is 3/4 full and move a few buckets with every new object, so a resize
+	// is always finished long before the next one.
+	if(HashTableFree < (HashTableSize / 4)){
 		ResizeHashTable();
 	}
+	SplitHashTableBuckets(16);
 
 	// NOTE(fusion): If we properly manage the load factor and the number of free
 	// entries, we should have no trouble finding an empty table entry here. Use
 	// a bounded loop nevertheless, just to be safe.
+	uint32 Probes = 1;
 	for(uint32 i = 0; i < HashTableSize; i += 1){
-		if(HashTableType[NextObjectID & HashTableMask] == 0)
+		if(HashTableType[HashTableIndex(NextObjectID)] == 0)
 			break;
 		NextObjectID += 1;
+		Probes += 1;
 	}
-	ASSERT(HashTableType[NextObjectID & HashTableMask] == 0);
+	ASSERT(HashTableType[HashTableIndex(NextObjectID)] == 0);
+	HashTableProbes += Probes;
+	HashTableInserts += 1;
 
 	TObject *Entry = GetFreeObjectSlot();
 	if(Entry == NULL){
@@ -1835,8 +3081,8 @@ Object CreateObject(void){
 	}
 
 	Entry->ObjectID = NextObjectID;
-	HashTableData[NextObjectID & HashTableMask] = Entry;
-	HashTableType[NextObjectID & HashTableMask] = STATUS_LOADED;
+	HashTableData[HashTableIndex(NextObjectID)] = Entry;
+	HashTableType[HashTableIndex(NextObjectID)] = STATUS_LOADED;
 	HashTableFree -= 1;
 	IncrementObjectCounter();
 
@@ -1875,7 +3121,7 @@ static void DestroyObject(Object Obj){
 		return;
 	}
 
-	uint32 EntryIndex = Obj.ObjectID & HashTableMask;
+	uint32 EntryIndex = HashTableIndex(Obj.ObjectID);
 	if(HashTableType[EntryIndex] != STATUS_LOADED){
 		error("DestroyObject: Objekt steht nicht im Speicher.\n");
 		return;
@@ -1971,6 +3217,7 @@ void ChangeObject(Object Obj, ObjectType NewType){
 	}
 
 	CronExpire(Obj, Delay);
+	MarkObjectDirty(Obj);
 }
 
 void ChangeObject(Object Obj, INSTANCEATTRIBUTE Attribute, uint32 Value){
@@ -1980,6 +3227,7 @@ void ChangeObject(Object Obj, INSTANCEATTRIBUTE Attribute, uint32 Value){
 	}
 
 	Obj.setAttribute(Attribute, Value);
+	MarkObjectDirty(Obj);
 }
 
 int GetObjectPriority(Object Obj){
@@ -2081,6 +3329,7 @@ void PlaceObject(Object Obj, Object Con, bool Append){
 	}
 	Obj.setNextObject(Cur);
 	Obj.setContainer(Con);
+	MarkObjectDirty(Obj);
 }
 
 // NOTE(fusion): This is the opposite of `PlaceObject`.
@@ -2090,6 +3339,8 @@ void CutObject(Object Obj){
 		return;
 	}
 
+	MarkObjectDirty(Obj);
+
 	Object Con = Obj.getContainer();
 	Object Cur = GetFirstContainerObject(Con);
 	if(Cur == Obj){
@@ -2220,8 +3471,8 @@ Object SplitObject(Object Obj, int Count){
 	Object Res = Obj;
 	if((uint32)Count != Amount){
 		Res = CopyObject(Obj.getContainer(), Obj);
-		Res.setAttribute(AMOUNT, (uint32)Count);
-		Obj.setAttribute(AMOUNT, Amount - (uint32)Count);
+		ChangeObject(Res, AMOUNT, (uint32)Count);
+		ChangeObject(Obj, AMOUNT, Amount - (uint32)Count);
 	}
 	return Res;
 }
@@ -2268,7 +3519,9 @@ void MergeObjects(Object Obj, Object Dest){
 		DestAmount = 100;
 	}
 
-	Dest.setAttribute(AMOUNT, DestAmount);
+	// NOTE(fusion): `DeleteObject` only marks the sector `Obj` came from, which
+	// is not necessarily the one holding `Dest`.
+	ChangeObject(Dest, AMOUNT, DestAmount);
 	DeleteObject(Obj);
 }
 
@@ -2326,7 +3579,7 @@ Object GetMapContainer(int x, int y, int z){
 
 	int OffsetX = x % 32;
 	int OffsetY = y % 32;
-	ConSector->TimeStamp = RoundNr;
+	TouchSector(ConSector);
 	return ConSector->MapCon[OffsetX][OffsetY];
 }
 
@@ -76,6 +76,25 @@ struct TSector {
 	uint32 TimeStamp;
 	uint8 Status;
 	uint8 MapFlags;
+
+	// NOTE(fusion): Loaded sectors are kept in a list ordered by their last
+	// access, so the one to be swapped out can be found without scanning the
+	// whole map.
+	int SectorX;
+	int SectorY;
+	int SectorZ;
+	TSector *PrevLoaded;
+	TSector *NextLoaded;
+	uint32 FileNumber;
+
+	// NOTE(fusion): Save generation in which the sector was last modified, or
+	// zero if it hasn't changed since it was last loaded or saved.
+	uint32 DirtyGeneration;
+
+	// NOTE(fusion): Refreshable points of the sector's ORIGMAP file, kept in
+	// sector image point format (see map.cc).
+	uint8 *RefreshData;
+	int RefreshSize;
 };
 
 struct TDepotInfo {
@@ -120,8 +139,13 @@ uint32 CronInfo(Object Obj, bool Delete);
 uint32 CronStop(Object Obj);
 
 // NOTE(fusion): Map management functions. Most for internal use.
+void ProcessObjectHashTable(void);
 void SwapObject(TWriteBinaryFile *File, Object Obj, uintptr FileNumber);
 void SwapSector(void);
+void SwapSummary(void);
+void PrefetchSector(int SectorX, int SectorY, int SectorZ);
+void PrefetchSectors(int x, int y, int z);
+void LoadSwappedSector(int SectorX, int SectorY, int SectorZ);
 void UnswapSector(uintptr FileNumber);
 void DeleteSwappedSectors(void);
 void LoadObjects(TReadScriptFile *Script, TWriteStream *Stream, bool Skip);
@@ -131,9 +155,13 @@ void LoadSector(const char *FileName, int SectorX, int SectorY, int SectorZ);
 void LoadMap(void);
 void SaveObjects(Object Obj, TWriteStream *Stream, bool Stop);
 void SaveObjects(TReadStream *Stream, TWriteScriptFile *Script);
-void SaveSector(char *FileName, int SectorX, int SectorY, int SectorZ);
+int SaveSector(char *FileName, int SectorX, int SectorY, int SectorZ);
 void SaveMap(void);
-void RefreshSector(int SectorX, int SectorY, int SectorZ, TReadStream *Stream);
+uint32 BeginMapSnapshot(void);
+bool SaveMapSnapshot(uint32 Generation);
+void EndMapSnapshot(uint32 Generation, bool Saved);
+void RefreshSector(int SectorX, int SectorY, int SectorZ, bool SkipHouses);
+void RefreshSummary(void);
 void PatchSector(int SectorX, int SectorY, int SectorZ, bool FullSector,
 		TReadScriptFile *Script, bool SaveHouses);
 void InitMap(void);
@@ -13,8 +13,15 @@ static int NumberOfMoveUseConditions;
 static vector<TMoveUseAction> MoveUseActions(1, 1000, 1000);
 static int NumberOfMoveUseActions;
 
+static TMoveUseInstruction *MoveUseConditionCode;
+static TMoveUseInstruction *MoveUseActionCode;
+
 static TMoveUseDatabase MoveUseDatabases[5];
 
+static int MoveUseEvents;
+static int MoveUseConditionChecks;
+static int MoveUseActionCount;
+
 static vector<TDelayedMail> DelayedMail(0, 10, 10);
 static int DelayedMails;
 
@@ -50,22 +57,6 @@ void UnpackRelativeCoordinate(int Packed, int *x, int *y, int *z){
 
 // Event Execution
 // =============================================================================
-Object GetEventObject(int Nr, Object User, Object Obj1, Object Obj2, Object Temp){
-	Object Obj = NONE;
-	switch(Nr){
-		case 0: Obj = NONE; break;
-		case 1: Obj = Obj1; break;
-		case 2: Obj = Obj2; break;
-		case 3: Obj = User; break;
-		case 4: Obj = Temp; break;
-		default:{
-			error("GetEventObject: Unbekannte Nummer %d.\n", Nr);
-			break;
-		}
-	}
-	return Obj;
-}
-
 bool Compare(int Value1, int Operator, int Value2){
 	bool Result = false;
 	switch(Operator){
@@ -83,33 +74,31 @@ bool Compare(int Value1, int Operator, int Value2){
 	return Result;
 }
 
-bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
-		Object User, Object Obj1, Object Obj2, Object *Temp){
+bool CheckCondition(MoveUseEventType EventType, TMoveUseInstruction *Condition, Object *Objects){
 	bool Result = false;
-	switch(Condition->Condition){
+	switch(Condition->Opcode){
 		case MOVEUSE_CONDITION_ISPOSITION:{
-			int ObjX, ObjY, ObjZ, CoordX, CoordY, CoordZ;
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			UnpackAbsoluteCoordinate(Condition->Parameters[1], &CoordX, &CoordY, &CoordZ);
+			int ObjX, ObjY, ObjZ;
+			Object Obj = Objects[Condition->ObjNr];
 			GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
-			Result = (ObjX == CoordX && ObjY == CoordY && ObjZ == CoordZ);
+			Result = (ObjX == Condition->X && ObjY == Condition->Y && ObjZ == Condition->Z);
 			break;
 		}
 
 		case MOVEUSE_CONDITION_ISTYPE:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			Result = (Obj.getObjectType().TypeID == Condition->Parameters[1]);
+			Object Obj = Objects[Condition->ObjNr];
+			Result = (Obj.getObjectType().TypeID == Condition->Type.TypeID);
 			break;
 		}
 
 		case MOVEUSE_CONDITION_ISCREATURE:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
+			Object Obj = Objects[Condition->ObjNr];
 			Result = Obj.getObjectType().isCreatureContainer();
 			break;
 		}
 
 		case MOVEUSE_CONDITION_ISPLAYER:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
+			Object Obj = Objects[Condition->ObjNr];
 			if(Obj.getObjectType().isCreatureContainer()){
 				TCreature *Creature = GetCreature(Obj);
 				Result = (Creature && Creature->Type == PLAYER);
@@ -118,39 +107,35 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 		}
 
 		case MOVEUSE_CONDITION_HASFLAG:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			Result = Obj.getObjectType().getFlag((FLAG)Condition->Parameters[1]);
+			Object Obj = Objects[Condition->ObjNr];
+			Result = Obj.getObjectType().getFlag((FLAG)Condition->Value[0]);
 			break;
 		}
 
 		case MOVEUSE_CONDITION_HASTYPEATTRIBUTE:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			int Attribute = (int)Obj.getObjectType().getAttribute((TYPEATTRIBUTE)Condition->Parameters[1]);
-			int Operator = Condition->Parameters[2];
-			int Value = Condition->Parameters[3];
-			Result = Compare(Attribute, Operator, Value);
+			Object Obj = Objects[Condition->ObjNr];
+			int Attribute = (int)Obj.getObjectType().getAttribute((TYPEATTRIBUTE)Condition->Value[0]);
+			Result = Compare(Attribute, Condition->Operator, Condition->Value[1]);
 			break;
 		}
 
 		case MOVEUSE_CONDITION_HASINSTANCEATTRIBUTE:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			int Attribute = (int)Obj.getAttribute((INSTANCEATTRIBUTE)Condition->Parameters[1]);
-			int Operator = Condition->Parameters[2];
-			int Value = Condition->Parameters[3];
-			Result = Compare(Attribute, Operator, Value);
+			Object Obj = Objects[Condition->ObjNr];
+			int Attribute = (int)Obj.getAttribute((INSTANCEATTRIBUTE)Condition->Value[0]);
+			Result = Compare(Attribute, Condition->Operator, Condition->Value[1]);
 			break;
 		}
 
 		case MOVEUSE_CONDITION_HASTEXT:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
+			Object Obj = Objects[Condition->ObjNr];
 			const char *Attribute = GetDynamicString(Obj.getAttribute(TEXTSTRING));
-			const char *Text = GetDynamicString(Condition->Parameters[1]);
+			const char *Text = GetDynamicString(Condition->Value[0]);
 			Result = (strcmp(Attribute, Text) == 0);
 			break;
 		}
 
 		case MOVEUSE_CONDITION_ISPEACEFUL:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
+			Object Obj = Objects[Condition->ObjNr];
 			if(Obj.getObjectType().isCreatureContainer()){
 				TCreature *Creature = GetCreature(Obj);
 				Result = (Creature && Creature->IsPeaceful());
@@ -159,7 +144,7 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 		}
 
 		case MOVEUSE_CONDITION_MAYLOGOUT:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
+			Object Obj = Objects[Condition->ObjNr];
 			if(Obj.getObjectType().isCreatureContainer()){
 				TCreature *Creature = GetCreature(Obj);
 				Result = (Creature != NULL && Creature->Type == PLAYER
@@ -169,8 +154,8 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 		}
 
 		case MOVEUSE_CONDITION_HASPROFESSION:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			int Profession = Condition->Parameters[1];
+			Object Obj = Objects[Condition->ObjNr];
+			int Profession = Condition->Value[0];
 			if(Obj.getObjectType().isCreatureContainer()){
 				TCreature *Creature = GetCreature(Obj);
 				Result = (Creature != NULL && Creature->Type == PLAYER
@@ -180,22 +165,20 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 		}
 
 		case MOVEUSE_CONDITION_HASLEVEL:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			int Operator = Condition->Parameters[1];
-			int Value = Condition->Parameters[2];
+			Object Obj = Objects[Condition->ObjNr];
 			if(Obj.getObjectType().isCreatureContainer()){
 				TCreature *Creature = GetCreature(Obj);
 				if(Creature != NULL){
 					int Level = Creature->Skills[SKILL_LEVEL]->Get();
-					Result = Compare(Level, Operator, Value);
+					Result = Compare(Level, Condition->Operator, Condition->Value[0]);
 				}
 			}
 			break;
 		}
 
 		case MOVEUSE_CONDITION_HASRIGHT:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			RIGHT Right = (RIGHT)Condition->Parameters[1];
+			Object Obj = Objects[Condition->ObjNr];
+			RIGHT Right = (RIGHT)Condition->Value[0];
 			if(Obj.getObjectType().isCreatureContainer()){
 				TCreature *Creature = GetCreature(Obj);
 				Result = (Creature != NULL && Creature->Type == PLAYER
@@ -205,25 +188,23 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 		}
 
 		case MOVEUSE_CONDITION_HASQUESTVALUE:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			int QuestNr = Condition->Parameters[1];
-			int Operator = Condition->Parameters[2];
-			int Value = Condition->Parameters[3];
+			Object Obj = Objects[Condition->ObjNr];
+			int QuestNr = Condition->Value[0];
 			if(Obj.getObjectType().isCreatureContainer()){
 				TCreature *Creature = GetCreature(Obj);
 				if(Creature != NULL && Creature->Type == PLAYER){
 					int QuestValue = ((TPlayer*)Creature)->GetQuestValue(QuestNr);
-					Result = Compare(QuestValue, Operator, Value);
+					Result = Compare(QuestValue, Condition->Operator, Condition->Value[1]);
 				}
 			}
 			break;
 		}
 
 		case MOVEUSE_CONDITION_TESTSKILL:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			int SkillNr = Condition->Parameters[1];
-			int Difficulty = Condition->Parameters[2];
-			int Probability = Condition->Parameters[3];
+			Object Obj = Objects[Condition->ObjNr];
+			int SkillNr = Condition->Value[0];
+			int Difficulty = Condition->Value[1];
+			int Probability = Condition->Value[2];
 			if(Obj.getObjectType().isCreatureContainer()){
 				TCreature *Creature = GetCreature(Obj);
 				if(Creature != NULL){
@@ -239,40 +220,24 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 
 		// TODO(fusion): This also counts objects at the object's map location?
 		case MOVEUSE_CONDITION_COUNTOBJECTS:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			int Operator = Condition->Parameters[1];
-			int Value = Condition->Parameters[2];
+			Object Obj = Objects[Condition->ObjNr];
 			Object MapCon = GetMapContainer(Obj);
 			int ObjCount = CountObjectsInContainer(MapCon);
-			Result = Compare(ObjCount, Operator, Value);
+			Result = Compare(ObjCount, Condition->Operator, Condition->Value[0]);
 			break;
 		}
 
 		case MOVEUSE_CONDITION_COUNTOBJECTSONMAP:{
-			int CoordX, CoordY, CoordZ;
-			UnpackAbsoluteCoordinate(Condition->Parameters[0], &CoordX, &CoordY, &CoordZ);
-			int Operator = Condition->Parameters[1];
-			int Value = Condition->Parameters[2];
-			Object MapCon = GetMapContainer(CoordX, CoordY, CoordZ);
+			Object MapCon = GetMapContainer(Condition->X, Condition->Y, Condition->Z);
 			int ObjCount = CountObjectsInContainer(MapCon);
-			Result = Compare(ObjCount, Operator, Value);
-			break;
-		}
-
-		case MOVEUSE_CONDITION_ISOBJECTTHERE:{
-			int CoordX, CoordY, CoordZ;
-			UnpackAbsoluteCoordinate(Condition->Parameters[0], &CoordX, &CoordY, &CoordZ);
-			ObjectType Type = Condition->Parameters[1];
-			*Temp = GetFirstSpecObject(CoordX, CoordY, CoordZ, Type);
-			Result = (*Temp != NONE);
+			Result = Compare(ObjCount, Condition->Operator, Condition->Value[0]);
 			break;
 		}
 
+		case MOVEUSE_CONDITION_ISOBJECTTHERE:
 		case MOVEUSE_CONDITION_ISCREATURETHERE:{
-			int CoordX, CoordY, CoordZ;
-			UnpackAbsoluteCoordinate(Condition->Parameters[0], &CoordX, &CoordY, &CoordZ);
-			ObjectType Type = TYPEID_CREATURE_CONTAINER;
-			*Temp = GetFirstSpecObject(CoordX, CoordY, CoordZ, Type);
+			Object *Temp = &Objects[MOVEUSE_OBJECT_TEMP];
+			*Temp = GetFirstSpecObject(Condition->X, Condition->Y, Condition->Z, Condition->Type);
 			Result = (*Temp != NONE);
 			break;
 		}
@@ -280,10 +245,8 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 		// TODO(fusion): I feel this one should iterate the field because there
 		// could be more than one creature.
 		case MOVEUSE_CONDITION_ISPLAYERTHERE:{
-			int CoordX, CoordY, CoordZ;
-			UnpackAbsoluteCoordinate(Condition->Parameters[0], &CoordX, &CoordY, &CoordZ);
-			ObjectType Type = TYPEID_CREATURE_CONTAINER;
-			*Temp = GetFirstSpecObject(CoordX, CoordY, CoordZ, Type);
+			Object *Temp = &Objects[MOVEUSE_OBJECT_TEMP];
+			*Temp = GetFirstSpecObject(Condition->X, Condition->Y, Condition->Z, Condition->Type);
 			if(*Temp != NONE){
 				TCreature *Creature = GetCreature(*Temp);
 				Result = Creature && Creature->Type == PLAYER;
@@ -292,11 +255,11 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 		}
 
 		case MOVEUSE_CONDITION_ISOBJECTININVENTORY:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			ObjectType Type = Condition->Parameters[1];
-			int Count = Condition->Parameters[2];
+			Object Obj = Objects[Condition->ObjNr];
+			int Count = Condition->Value[0];
 			if(Obj.getObjectType().isCreatureContainer()){
-				*Temp = GetInventoryObject(Obj.getCreatureID(), Type, Count);
+				Object *Temp = &Objects[MOVEUSE_OBJECT_TEMP];
+				*Temp = GetInventoryObject(Obj.getCreatureID(), Condition->Type, Count);
 				Result = (*Temp != NONE);
 			}
 			break;
@@ -304,7 +267,7 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 
 		case MOVEUSE_CONDITION_ISPROTECTIONZONE:{
 			int ObjX, ObjY, ObjZ;
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
+			Object Obj = Objects[Condition->ObjNr];
 			GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
 			Result = IsProtectionZone(ObjX, ObjY, ObjZ);
 			break;
@@ -312,15 +275,15 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 
 		case MOVEUSE_CONDITION_ISHOUSE:{
 			int ObjX, ObjY, ObjZ;
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
+			Object Obj = Objects[Condition->ObjNr];
 			GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
 			Result = IsHouse(ObjX, ObjY, ObjZ);
 			break;
 		}
 
 		case MOVEUSE_CONDITION_ISHOUSEOWNER:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
-			Object Cr = GetEventObject(Condition->Parameters[1], User, Obj1, Obj2, *Temp);
+			Object Obj = Objects[Condition->ObjNr];
+			Object Cr = Objects[Condition->ObjNr2];
 			if(Cr.getObjectType().isCreatureContainer()){
 				TCreature *Creature = GetCreature(Cr);
 				if(Creature != NULL && Creature->Type == PLAYER){
@@ -334,7 +297,7 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 		}
 
 		case MOVEUSE_CONDITION_ISDRESSED:{
-			Object Obj = GetEventObject(Condition->Parameters[0], User, Obj1, Obj2, *Temp);
+			Object Obj = Objects[Condition->ObjNr];
 			ObjectType ObjType = Obj.getObjectType();
 			if(ObjType.getFlag(CLOTHES)){
 				int CurPosition = GetObjectBodyPosition(Obj);
@@ -347,12 +310,12 @@ bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
 		}
 
 		case MOVEUSE_CONDITION_RANDOM:{
-			Result = (random(1, 100) <= Condition->Parameters[0]);
+			Result = (random(1, 100) <= Condition->Value[0]);
 			break;
 		}
 
 		default:{
-			error("CheckCondition: Unbekannte Bedingung %d.\n", Condition->Condition);
+			error("CheckCondition: Unbekannte Bedingung %d.\n", Condition->Opcode);
 			return false;
 		}
 	}
@@ -943,135 +906,115 @@ void TextEffect(const char *Text, int x, int y, int z, int Radius){
 	}
 }
 
-void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
-		Object User, Object Obj1, Object Obj2, Object *Temp){
+void ExecuteAction(MoveUseEventType EventType, TMoveUseInstruction *Action, Object *Objects){
+	Object *Temp = &Objects[MOVEUSE_OBJECT_TEMP];
 	try{
-		switch(Action->Action){
+		switch(Action->Opcode){
 			case MOVEUSE_ACTION_CREATEONMAP:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				ObjectType Type = Action->Parameters[1];
-				int Value = Action->Parameters[2];
-				Object MapCon = GetMapContainer(CoordX, CoordY, CoordZ);
-				*Temp = CreateObject(MapCon, Type, Value);
+				Object MapCon = GetMapContainer(Action->X, Action->Y, Action->Z);
+				*Temp = CreateObject(MapCon, Action->Type, Action->Value[0]);
 				break;
 			}
 
 			case MOVEUSE_ACTION_CREATE:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				ObjectType Type = Action->Parameters[1];
-				int Value = Action->Parameters[2];
-				*Temp = CreateObject(Obj.getContainer(), Type, Value);
+				Object Obj = Objects[Action->ObjNr];
+				*Temp = CreateObject(Obj.getContainer(), Action->Type, Action->Value[0]);
 				break;
 			}
 
 			case MOVEUSE_ACTION_MONSTERONMAP:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				int Race = Action->Parameters[1];
-				CreateMonster(Race, CoordX, CoordY, CoordZ, 0, 0, true);
+				int Race = Action->Value[0];
+				CreateMonster(Race, Action->X, Action->Y, Action->Z, 0, 0, true);
 				break;
 			}
 
 			case MOVEUSE_ACTION_MONSTER:{
 				int ObjX, ObjY, ObjZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				int Race = Action->Parameters[1];
+				Object Obj = Objects[Action->ObjNr];
+				int Race = Action->Value[0];
 				GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
 				CreateMonster(Race, ObjX, ObjY, ObjZ, 0, 0, true);
 				break;
 			}
 
 			case MOVEUSE_ACTION_EFFECTONMAP:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				int Effect = Action->Parameters[1];
-				GraphicalEffect(CoordX, CoordY, CoordZ, Effect);
+				int Effect = Action->Value[0];
+				GraphicalEffect(Action->X, Action->Y, Action->Z, Effect);
 				break;
 			}
 
 			case MOVEUSE_ACTION_EFFECT:{
 				int ObjX, ObjY, ObjZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				int Effect = Action->Parameters[1];
+				Object Obj = Objects[Action->ObjNr];
+				int Effect = Action->Value[0];
 				GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
 				GraphicalEffect(ObjX, ObjY, ObjZ, Effect);
 				break;
 			}
 
 			case MOVEUSE_ACTION_TEXTONMAP:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				const char *Text = GetDynamicString(Action->Parameters[1]);
-				int Radius = Action->Parameters[2];
-				TextEffect(Text, CoordX, CoordY, CoordZ, Radius);
+				const char *Text = GetDynamicString(Action->Value[0]);
+				int Radius = Action->Value[1];
+				TextEffect(Text, Action->X, Action->Y, Action->Z, Radius);
 				break;
 			}
 
 			case MOVEUSE_ACTION_TEXT:{
 				int ObjX, ObjY, ObjZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				const char *Text = GetDynamicString(Action->Parameters[1]);
-				int Radius = Action->Parameters[2];
+				Object Obj = Objects[Action->ObjNr];
+				const char *Text = GetDynamicString(Action->Value[0]);
+				int Radius = Action->Value[1];
 				GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
 				TextEffect(Text, ObjX, ObjY, ObjZ, Radius);
 				break;
 			}
 
 			case MOVEUSE_ACTION_CHANGEONMAP:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				ObjectType OldType = Action->Parameters[1];
-				ObjectType NewType = Action->Parameters[2];
-				int NewValue = Action->Parameters[3];
-				*Temp = GetFirstSpecObject(CoordX, CoordY, CoordZ, OldType);
+				*Temp = GetFirstSpecObject(Action->X, Action->Y, Action->Z, Action->Type);
 				if(*Temp != NONE){
-					ChangeObject(*Temp, NewType, NewValue);
+					ChangeObject(*Temp, Action->Type2, Action->Value[0]);
 				}else{
 					error("ExecuteAction (CHANGEONMAP): Kein Objekt %d auf [%d,%d,%d].\n",
-							OldType.TypeID, CoordX, CoordY, CoordZ);
+							Action->Type.TypeID, Action->X, Action->Y, Action->Z);
 				}
 				break;
 			}
 
 			case MOVEUSE_ACTION_CHANGE:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				ObjectType NewType = Action->Parameters[1];
-				int NewValue = Action->Parameters[2];
-				ChangeObject(Obj, NewType, NewValue);
+				Object Obj = Objects[Action->ObjNr];
+				ChangeObject(Obj, Action->Type, Action->Value[0]);
 				break;
 			}
 
 			case MOVEUSE_ACTION_CHANGEREL:{
-				int ObjX, ObjY, ObjZ, RelX, RelY, RelZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				UnpackRelativeCoordinate(Action->Parameters[1], &RelX, &RelY, &RelZ);
-				ObjectType OldType = Action->Parameters[2];
-				ObjectType NewType = Action->Parameters[3];
-				int NewValue = Action->Parameters[4];
+				int ObjX, ObjY, ObjZ;
+				Object Obj = Objects[Action->ObjNr];
 				GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
-				*Temp = GetFirstSpecObject((ObjX + RelX), (ObjY + RelY), (ObjZ + RelZ), OldType);
+				ObjX += Action->X;
+				ObjY += Action->Y;
+				ObjZ += Action->Z;
+				*Temp = GetFirstSpecObject(ObjX, ObjY, ObjZ, Action->Type);
 				if(*Temp != NONE){
-					ChangeObject(*Temp, NewType, NewValue);
+					ChangeObject(*Temp, Action->Type2, Action->Value[0]);
 				}else{
 					error("ExecuteAction (CHANGEREL): Kein Objekt %d auf [%d,%d,%d].\n",
-							OldType.TypeID, (ObjX + RelX), (ObjY + RelY), (ObjZ + RelZ));
+							Action->Type.TypeID, ObjX, ObjY, ObjZ);
 				}
 				break;
 			}
 
 			case MOVEUSE_ACTION_SETATTRIBUTE:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				INSTANCEATTRIBUTE Attribute = (INSTANCEATTRIBUTE)Action->Parameters[1];
-				int Value = Action->Parameters[2];
+				Object Obj = Objects[Action->ObjNr];
+				INSTANCEATTRIBUTE Attribute = (INSTANCEATTRIBUTE)Action->Value[0];
+				int Value = Action->Value[1];
 				Change(Obj, Attribute, Value);
 				break;
 			}
 
 			case MOVEUSE_ACTION_CHANGEATTRIBUTE:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				INSTANCEATTRIBUTE Attribute = (INSTANCEATTRIBUTE)Action->Parameters[1];
-				int Amount = Action->Parameters[2];
+				Object Obj = Objects[Action->ObjNr];
+				INSTANCEATTRIBUTE Attribute = (INSTANCEATTRIBUTE)Action->Value[0];
+				int Amount = Action->Value[1];
 				// TODO(fusion): This is weird.
 				int OldValue = (int)Obj.getAttribute(Attribute);
 				int NewValue = OldValue + Amount;
@@ -1087,9 +1030,9 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_SETQUESTVALUE:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				int QuestNr = Action->Parameters[1];
-				int QuestValue = Action->Parameters[2];
+				Object Obj = Objects[Action->ObjNr];
+				int QuestNr = Action->Value[0];
+				int QuestValue = Action->Value[1];
 				ObjectType ObjType = Obj.getObjectType();
 				if(ObjType.isCreatureContainer()){
 					TCreature *Creature = GetCreature(Obj);
@@ -1105,10 +1048,10 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_DAMAGE:{
-				Object AttackerObj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				Object VictimObj = GetEventObject(Action->Parameters[1], User, Obj1, Obj2, *Temp);
-				int DamageType = Action->Parameters[2];
-				int Damage = Action->Parameters[3];
+				Object AttackerObj = Objects[Action->ObjNr];
+				Object VictimObj = Objects[Action->ObjNr2];
+				int DamageType = Action->Value[0];
+				int Damage = Action->Value[1];
 
 				TCreature *Attacker = NULL;
 				if(AttackerObj != NONE){
@@ -1140,9 +1083,7 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_SETSTART:{
-				int StartX, StartY, StartZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				UnpackAbsoluteCoordinate(Action->Parameters[1], &StartX, &StartY, &StartZ);
+				Object Obj = Objects[Action->ObjNr];
 
 				if(!Obj.getObjectType().isCreatureContainer()){
 					throw ERROR;
@@ -1153,17 +1094,17 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 					throw ERROR;
 				}
 
-				Creature->startx = StartX;
-				Creature->starty = StartY;
-				Creature->startz = StartZ;
+				Creature->startx = Action->X;
+				Creature->starty = Action->Y;
+				Creature->startz = Action->Z;
 				((TPlayer*)Creature)->SaveData();
 				break;
 			}
 
 			case MOVEUSE_ACTION_WRITENAME:{
-				Object WriterObj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				const char *Format = GetDynamicString(Action->Parameters[1]);
-				Object TargetObj = GetEventObject(Action->Parameters[2], User, Obj1, Obj2, *Temp);
+				Object WriterObj = Objects[Action->ObjNr];
+				const char *Format = GetDynamicString(Action->Value[0]);
+				Object TargetObj = Objects[Action->ObjNr2];
 
 				if(WriterObj == NONE || !WriterObj.getObjectType().isCreatureContainer()
 				|| TargetObj == NONE || !TargetObj.getObjectType().getFlag(TEXT)){
@@ -1221,8 +1162,8 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_WRITETEXT:{
-				const char *Text = GetDynamicString(Action->Parameters[0]);
-				Object Obj = GetEventObject(Action->Parameters[1], User, Obj1, Obj2, *Temp);
+				const char *Text = GetDynamicString(Action->Value[0]);
+				Object Obj = Objects[Action->ObjNr];
 
 				if(Obj == NONE || !Obj.getObjectType().getFlag(TEXT)){
 					throw ERROR;
@@ -1236,7 +1177,7 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_LOGOUT:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
+				Object Obj = Objects[Action->ObjNr];
 
 				if(Obj == NONE || !Obj.getObjectType().isCreatureContainer()){
 					throw ERROR;
@@ -1252,21 +1193,16 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_MOVEALLONMAP:{
-				int OrigX, OrigY, OrigZ, DestX, DestY, DestZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &OrigX, &OrigY, &OrigZ);
-				UnpackAbsoluteCoordinate(Action->Parameters[1], &DestX, &DestY, &DestZ);
-				Object First = GetFirstObject(OrigX, OrigY, OrigZ);
-				Object Dest = GetMapContainer(DestX, DestY, DestZ);
+				Object First = GetFirstObject(Action->X, Action->Y, Action->Z);
+				Object Dest = GetMapContainer(Action->X2, Action->Y2, Action->Z2);
 				MoveAllObjects(First, Dest, NONE, false);
 				break;
 			}
 
 			case MOVEUSE_ACTION_MOVEALL:{
-				int DestX, DestY, DestZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				UnpackAbsoluteCoordinate(Action->Parameters[1], &DestX, &DestY, &DestZ);
+				Object Obj = Objects[Action->ObjNr];
 				Object First = GetFirstContainerObject(Obj.getContainer());
-				Object Dest = GetMapContainer(DestX, DestY, DestZ);
+				Object Dest = GetMapContainer(Action->X, Action->Y, Action->Z);
 				// TODO(fusion): Why do we set the `Exclude` parameter to `First`?
 				// Maybe we just don't want to check if it is `NONE` can call
 				// `getNextObject()` like MOVETOPONMAP?
@@ -1275,100 +1211,82 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_MOVEALLREL:{
-				int ObjX, ObjY, ObjZ, RelX, RelY, RelZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				UnpackRelativeCoordinate(Action->Parameters[1], &RelX, &RelY, &RelZ);
+				int ObjX, ObjY, ObjZ;
+				Object Obj = Objects[Action->ObjNr];
 				GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
 				Object First = GetFirstContainerObject(Obj.getContainer());
-				Object Dest = GetMapContainer((ObjX + RelX), (ObjY + RelY), (ObjZ + RelZ));
+				Object Dest = GetMapContainer((ObjX + Action->X), (ObjY + Action->Y), (ObjZ + Action->Z));
 				// TODO(fusion): Same as above?
 				MoveAllObjects(First, Dest, First, false);
 				break;
 			}
 
 			case MOVEUSE_ACTION_MOVETOPONMAP:{
-				int OrigX, OrigY, OrigZ, DestX, DestY, DestZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &OrigX, &OrigY, &OrigZ);
-				ObjectType Type = Action->Parameters[1];
-				UnpackAbsoluteCoordinate(Action->Parameters[2], &DestX, &DestY, &DestZ);
-				Object Obj = GetFirstSpecObject(OrigX, OrigY, OrigZ, Type);
+				Object Obj = GetFirstSpecObject(Action->X, Action->Y, Action->Z, Action->Type);
 				if(Obj != NONE){
-					Object Dest = GetMapContainer(DestX, DestY, DestZ);
+					Object Dest = GetMapContainer(Action->X2, Action->Y2, Action->Z2);
 					MoveAllObjects(Obj.getNextObject(), Dest, NONE, true);
 				}else{
 					error("ExecuteAction (MOVETOPONMAP): Kein Objekt %d auf [%d,%d,%d].\n",
-							Type.TypeID, OrigX, OrigY, OrigZ);
+							Action->Type.TypeID, Action->X, Action->Y, Action->Z);
 				}
 				break;
 			}
 
 			case MOVEUSE_ACTION_MOVETOP:{
-				int DestX, DestY, DestZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				UnpackAbsoluteCoordinate(Action->Parameters[1], &DestX, &DestY, &DestZ);
-				Object Dest = GetMapContainer(DestX, DestY, DestZ);
+				Object Obj = Objects[Action->ObjNr];
+				Object Dest = GetMapContainer(Action->X, Action->Y, Action->Z);
 				MoveAllObjects(Obj.getNextObject(), Dest, NONE, true);
 				break;
 			}
 
 			case MOVEUSE_ACTION_MOVETOPREL:{
-				int ObjX, ObjY, ObjZ, RelX, RelY, RelZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				UnpackRelativeCoordinate(Action->Parameters[1], &RelX, &RelY, &RelZ);
+				int ObjX, ObjY, ObjZ;
+				Object Obj = Objects[Action->ObjNr];
 				GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
-				Object Dest = GetMapContainer((ObjX + RelX), (ObjY + RelY), (ObjZ + RelZ));
+				Object Dest = GetMapContainer((ObjX + Action->X), (ObjY + Action->Y), (ObjZ + Action->Z));
 				MoveAllObjects(Obj.getNextObject(), Dest, NONE, true);
 				break;
 			}
 
 			case MOVEUSE_ACTION_MOVE:{
-				int DestX, DestY, DestZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				UnpackAbsoluteCoordinate(Action->Parameters[1], &DestX, &DestY, &DestZ);
-				Object Dest = GetMapContainer(DestX, DestY, DestZ);
+				Object Obj = Objects[Action->ObjNr];
+				Object Dest = GetMapContainer(Action->X, Action->Y, Action->Z);
 				MoveOneObject(Obj, Dest);
 				break;
 			}
 
 			case MOVEUSE_ACTION_MOVEREL:{
-				int RefX, RefY, RefZ, RelX, RelY, RelZ;
-				Object MovObj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				Object RefObj = GetEventObject(Action->Parameters[1], User, Obj1, Obj2, *Temp);
-				UnpackRelativeCoordinate(Action->Parameters[2], &RelX, &RelY, &RelZ);
+				int RefX, RefY, RefZ;
+				Object MovObj = Objects[Action->ObjNr];
+				Object RefObj = Objects[Action->ObjNr2];
 				GetObjectCoordinates(RefObj, &RefX, &RefY, &RefZ);
-				Object Dest = GetMapContainer((RefX + RelX), (RefY + RelY), (RefZ + RelZ));
+				Object Dest = GetMapContainer((RefX + Action->X), (RefY + Action->Y), (RefZ + Action->Z));
 				MoveOneObject(MovObj, Dest);
 				break;
 			}
 
 			case MOVEUSE_ACTION_RETRIEVE:{
-				int ObjX, ObjY, ObjZ, OrigRelX, OrigRelY, OrigRelZ, DestRelX, DestRelY, DestRelZ;
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				UnpackRelativeCoordinate(Action->Parameters[1], &OrigRelX, &OrigRelY, &OrigRelZ);
-				UnpackRelativeCoordinate(Action->Parameters[2], &DestRelX, &DestRelY, &DestRelZ);
+				int ObjX, ObjY, ObjZ;
+				Object Obj = Objects[Action->ObjNr];
 				GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
-				Object Top = GetTopObject((ObjX + OrigRelX), (ObjY + OrigRelY), (ObjZ + OrigRelZ), false);
+				Object Top = GetTopObject((ObjX + Action->X), (ObjY + Action->Y), (ObjZ + Action->Z), false);
 				if(Top != NONE && !Top.getObjectType().getFlag(UNMOVE)){
-					Object Dest = GetMapContainer((ObjX + DestRelX), (ObjY + DestRelY), (ObjZ + DestRelZ));
+					Object Dest = GetMapContainer((ObjX + Action->X2), (ObjY + Action->Y2), (ObjZ + Action->Z2));
 					MoveOneObject(Top, Dest);
 				}
 				break;
 			}
 
 			case MOVEUSE_ACTION_DELETEALLONMAP:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				Object First = GetFirstObject(CoordX, CoordY, CoordZ);
+				Object First = GetFirstObject(Action->X, Action->Y, Action->Z);
 				// TODO(fusion): Same as `MOVEALL`.
 				DeleteAllObjects(First, First, false);
 				break;
 			}
 
 			case MOVEUSE_ACTION_DELETETOPONMAP:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				ObjectType Type = Action->Parameters[1];
-				Object First = GetFirstSpecObject(CoordX, CoordY, CoordZ, Type);
+				Object First = GetFirstSpecObject(Action->X, Action->Y, Action->Z, Action->Type);
 				// TODO(fusion): Sometimes we throw, sometimes we print an error,
 				// sometimes we ignore it, what a mess.
 				if(First == NONE){
@@ -1379,23 +1297,20 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_DELETEONMAP:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				ObjectType Type = Action->Parameters[1];
-				Object Obj = GetFirstSpecObject(CoordX, CoordY, CoordZ, Type);
+				Object Obj = GetFirstSpecObject(Action->X, Action->Y, Action->Z, Action->Type);
 				if(Obj != NONE){
 					bool IsUseEvent = (EventType == MOVEUSE_EVENT_USE
 							|| EventType == MOVEUSE_EVENT_MULTIUSE);
 					Delete(Obj, (IsUseEvent ? 1 : -1));
 				}else{
 					error("ExecuteAction (DELETEONMAP): Kein Objekt %d auf [%d,%d,%d].\n",
-							Type.TypeID, CoordX, CoordY, CoordZ);
+							Action->Type.TypeID, Action->X, Action->Y, Action->Z);
 				}
 				break;
 			}
 
 			case MOVEUSE_ACTION_DELETE:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
+				Object Obj = Objects[Action->ObjNr];
 				if(Obj == NONE){
 					throw ERROR;
 				}
@@ -1406,11 +1321,10 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_DELETEININVENTORY:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				ObjectType Type = Action->Parameters[1];
-				int Value = Action->Parameters[2];
+				Object Obj = Objects[Action->ObjNr];
+				int Value = Action->Value[0];
 				if(Obj.getObjectType().isCreatureContainer()){
-					DeleteAtCreature(Obj.getCreatureID(), Type, 1, Value);
+					DeleteAtCreature(Obj.getCreatureID(), Action->Type, 1, Value);
 				}else{
 					throw ERROR;
 				}
@@ -1418,8 +1332,8 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_DESCRIPTION:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
-				Object Cr = GetEventObject(Action->Parameters[1], User, Obj1, Obj2, *Temp);
+				Object Obj = Objects[Action->ObjNr];
+				Object Cr = Objects[Action->ObjNr2];
 				if(Cr.getObjectType().isCreatureContainer()){
 					TCreature *Creature = GetCreature(Cr);
 					if(Creature != NULL && Creature->Type == PLAYER){
@@ -1431,17 +1345,14 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_LOADDEPOT:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				ObjectType Type = Action->Parameters[1];
-				Object Cr = GetEventObject(Action->Parameters[2], User, Obj1, Obj2, *Temp);
-				int DepotNr = Action->Parameters[3];
+				Object Cr = Objects[Action->ObjNr];
+				int DepotNr = Action->Value[0];
 
 				if(!Cr.getObjectType().isCreatureContainer()){
 					throw ERROR;
 				}
 
-				Object Depot = GetFirstSpecObject(CoordX, CoordY, CoordZ, Type);
+				Object Depot = GetFirstSpecObject(Action->X, Action->Y, Action->Z, Action->Type);
 				if(Depot == NONE){
 					throw ERROR;
 				}
@@ -1451,17 +1362,14 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_SAVEDEPOT:{
-				int CoordX, CoordY, CoordZ;
-				UnpackAbsoluteCoordinate(Action->Parameters[0], &CoordX, &CoordY, &CoordZ);
-				ObjectType Type = Action->Parameters[1];
-				Object Cr = GetEventObject(Action->Parameters[2], User, Obj1, Obj2, *Temp);
-				int DepotNr = Action->Parameters[3];
+				Object Cr = Objects[Action->ObjNr];
+				int DepotNr = Action->Value[0];
 
 				if(!Cr.getObjectType().isCreatureContainer()){
 					throw ERROR;
 				}
 
-				Object Depot = GetFirstSpecObject(CoordX, CoordY, CoordZ, Type);
+				Object Depot = GetFirstSpecObject(Action->X, Action->Y, Action->Z, Action->Type);
 				if(Depot == NONE){
 					throw ERROR;
 				}
@@ -1471,7 +1379,7 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			case MOVEUSE_ACTION_SENDMAIL:{
-				Object Obj = GetEventObject(Action->Parameters[0], User, Obj1, Obj2, *Temp);
+				Object Obj = Objects[Action->ObjNr];
 				SendMail(Obj);
 				break;
 			}
@@ -1482,12 +1390,12 @@ void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
 			}
 
 			default:{
-				error("ExecuteAction: Unbekannte Aktion %d.\n", Action->Action);
+				error("ExecuteAction: Unbekannte Aktion %d.\n", Action->Opcode);
 				break;
 			}
 		}
 	}catch(RESULT r){
-		error("ExecuteAction: Exception %d (Aktion %d).\n", r, Action->Action);
+		error("ExecuteAction: Exception %d (Aktion %d).\n", r, Action->Opcode);
 	}
 }
 
@@ -1499,34 +1407,74 @@ bool HandleEvent(MoveUseEventType EventType, Object User, Object Obj1, Object Ob
 		return false;
 	}
 
+	// NOTE(fusion): Rules that can only match other object types are skipped by
+	// merging the type chain of `Obj1` with the generic chain. Skipped rules would
+	// have failed their first condition anyway, so first-match order is the same
+	// as when checking all rules in sequence. Without `Obj1` there is no type to
+	// look up and we do exactly that.
 	bool Result = false;
+	Object Objects[MOVEUSE_OBJECT_COUNT];
+	Objects[MOVEUSE_OBJECT_NULL] = NONE;
+	Objects[MOVEUSE_OBJECT_OBJ1] = Obj1;
+	Objects[MOVEUSE_OBJECT_OBJ2] = Obj2;
+	Objects[MOVEUSE_OBJECT_USER] = User;
 	RecursionDepth += 1;
 	TMoveUseDatabase *DB = &MoveUseDatabases[EventType];
-	for(int RuleNr = 1; RuleNr <= DB->NumberOfRules; RuleNr += 1){
+	bool Indexed = (Obj1 != NONE);
+	int TypeRule = 0;
+	int GenericRule = DB->FirstGenericRule;
+	if(Indexed){
+		TypeRule = *DB->FirstTypeRule.at(Obj1.getObjectType().TypeID);
+	}
+
+	// NOTE(fusion): The leading `IsType(Obj1, Type)` of rules taken from the type
+	// chain is already known to hold and isn't checked again.
+	int RuleNr = 0;
+	while(true){
+		int SkipConditions = 0;
+		if(!Indexed){
+			RuleNr += 1;
+			if(RuleNr > DB->NumberOfRules){
+				break;
+			}
+		}else if(TypeRule != 0 && (GenericRule == 0 || TypeRule < GenericRule)){
+			RuleNr = TypeRule;
+			TypeRule = DB->Rules.at(TypeRule)->NextRule;
+			SkipConditions = 1;
+		}else if(GenericRule != 0){
+			RuleNr = GenericRule;
+			GenericRule = DB->Rules.at(GenericRule)->NextRule;
+		}else{
+			break;
+		}
+
 		bool Execute = true;
-		Object Temp = NONE;
+		Objects[MOVEUSE_OBJECT_TEMP] = NONE;
 		TMoveUseRule *Rule = DB->Rules.at(RuleNr);
-		for(int ConditionNr = Rule->FirstCondition;
-				ConditionNr <= Rule->LastCondition;
-				ConditionNr += 1){
-			TMoveUseCondition *Condition = MoveUseConditions.at(ConditionNr);
-			if(!CheckCondition(EventType, Condition, User, Obj1, Obj2, &Temp)){
+		TMoveUseInstruction *Condition = Rule->ConditionCode + SkipConditions;
+		TMoveUseInstruction *ConditionEnd = Rule->ConditionCode + Rule->NumberOfConditions;
+		while(Condition < ConditionEnd){
+			MoveUseConditionChecks += 1;
+			if(!CheckCondition(EventType, Condition, Objects)){
 				Execute = false;
 				break;
 			}
+			Condition += 1;
 		}
 
 		if(Execute){
-			for(int ActionNr = Rule->FirstAction;
-					ActionNr <= Rule->LastAction;
-					ActionNr += 1){
-				TMoveUseAction *Action = MoveUseActions.at(ActionNr);
-				ExecuteAction(EventType, Action, User, Obj1, Obj2, &Temp);
+			TMoveUseInstruction *Action = Rule->ActionCode;
+			TMoveUseInstruction *ActionEnd = Rule->ActionCode + Rule->NumberOfActions;
+			while(Action < ActionEnd){
+				MoveUseActionCount += 1;
+				ExecuteAction(EventType, Action, Objects);
+				Action += 1;
 			}
 			Result = true;
 			break;
 		}
 	}
+	MoveUseEvents += 1;
 	RecursionDepth -= 1;
 	return Result;
 }
@@ -2479,15 +2427,15 @@ void LoadParameters(TReadScriptFile *Script, int *Parameters, int NumberOfParame
 			case MOVEUSE_PARAMETER_OBJECT:{
 				const char *Object = Script->readIdentifier();
 				if(strcmp(Object, "null") == 0){
-					Parameters[i] = 0; // MOVEUSE_OBJECT_NULL ?
+					Parameters[i] = MOVEUSE_OBJECT_NULL;
 				}else if(strcmp(Object, "obj1") == 0){
-					Parameters[i] = 1; // MOVEUSE_OBJECT_1 ?
+					Parameters[i] = MOVEUSE_OBJECT_OBJ1;
 				}else if(strcmp(Object, "obj2") == 0){
-					Parameters[i] = 2; // MOVEUSE_OBJECT_2 ?
+					Parameters[i] = MOVEUSE_OBJECT_OBJ2;
 				}else if(strcmp(Object, "user") == 0){
-					Parameters[i] = 3; // MOVEUSE_OBJECT_USER ?
+					Parameters[i] = MOVEUSE_OBJECT_USER;
 				}else if(strcmp(Object, "temp") == 0){
-					Parameters[i] = 4; // MOVEUSE_OBJECT_TEMP ?
+					Parameters[i] = MOVEUSE_OBJECT_TEMP;
 				}else{
 					Script->error("Object expected");
 				}
@@ -2952,6 +2900,325 @@ void LoadAction(TReadScriptFile *Script, TMoveUseAction *Action){
 	}
 }
 
+void CompileCondition(TMoveUseCondition *Condition, TMoveUseInstruction *Code){
+	int *Parameters = Condition->Parameters;
+	Code->Opcode = Condition->Condition;
+	Code->Modifier = Condition->Modifier;
+	switch(Condition->Condition){
+		case MOVEUSE_CONDITION_ISPOSITION:{
+			Code->ObjNr = Parameters[0];
+			UnpackAbsoluteCoordinate(Parameters[1], &Code->X, &Code->Y, &Code->Z);
+			break;
+		}
+
+		case MOVEUSE_CONDITION_ISTYPE:{
+			Code->ObjNr = Parameters[0];
+			Code->Type = Parameters[1];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_ISCREATURE:
+		case MOVEUSE_CONDITION_ISPLAYER:
+		case MOVEUSE_CONDITION_ISPEACEFUL:
+		case MOVEUSE_CONDITION_MAYLOGOUT:
+		case MOVEUSE_CONDITION_ISPROTECTIONZONE:
+		case MOVEUSE_CONDITION_ISHOUSE:
+		case MOVEUSE_CONDITION_ISDRESSED:{
+			Code->ObjNr = Parameters[0];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_HASFLAG:
+		case MOVEUSE_CONDITION_HASTEXT:
+		case MOVEUSE_CONDITION_HASPROFESSION:
+		case MOVEUSE_CONDITION_HASRIGHT:{
+			Code->ObjNr = Parameters[0];
+			Code->Value[0] = Parameters[1];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_HASTYPEATTRIBUTE:
+		case MOVEUSE_CONDITION_HASINSTANCEATTRIBUTE:
+		case MOVEUSE_CONDITION_HASQUESTVALUE:{
+			Code->ObjNr = Parameters[0];
+			Code->Value[0] = Parameters[1];
+			Code->Operator = Parameters[2];
+			Code->Value[1] = Parameters[3];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_HASLEVEL:
+		case MOVEUSE_CONDITION_COUNTOBJECTS:{
+			Code->ObjNr = Parameters[0];
+			Code->Operator = Parameters[1];
+			Code->Value[0] = Parameters[2];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_TESTSKILL:{
+			Code->ObjNr = Parameters[0];
+			Code->Value[0] = Parameters[1];
+			Code->Value[1] = Parameters[2];
+			Code->Value[2] = Parameters[3];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_COUNTOBJECTSONMAP:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Operator = Parameters[1];
+			Code->Value[0] = Parameters[2];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_ISOBJECTTHERE:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Type = Parameters[1];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_ISCREATURETHERE:
+		case MOVEUSE_CONDITION_ISPLAYERTHERE:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Type = TYPEID_CREATURE_CONTAINER;
+			break;
+		}
+
+		case MOVEUSE_CONDITION_ISOBJECTININVENTORY:{
+			Code->ObjNr = Parameters[0];
+			Code->Type = Parameters[1];
+			Code->Value[0] = Parameters[2];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_ISHOUSEOWNER:{
+			Code->ObjNr = Parameters[0];
+			Code->ObjNr2 = Parameters[1];
+			break;
+		}
+
+		case MOVEUSE_CONDITION_RANDOM:{
+			Code->Value[0] = Parameters[0];
+			break;
+		}
+
+		default:{
+			error("CompileCondition: Unbekannte Bedingung %d.\n", Condition->Condition);
+			break;
+		}
+	}
+}
+
+void CompileAction(TMoveUseAction *Action, TMoveUseInstruction *Code){
+	int *Parameters = Action->Parameters;
+	Code->Opcode = Action->Action;
+	Code->Modifier = MOVEUSE_MODIFIER_NORMAL;
+	switch(Action->Action){
+		case MOVEUSE_ACTION_CREATEONMAP:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Type = Parameters[1];
+			Code->Value[0] = Parameters[2];
+			break;
+		}
+
+		case MOVEUSE_ACTION_CREATE:
+		case MOVEUSE_ACTION_CHANGE:
+		case MOVEUSE_ACTION_DELETEININVENTORY:{
+			Code->ObjNr = Parameters[0];
+			Code->Type = Parameters[1];
+			Code->Value[0] = Parameters[2];
+			break;
+		}
+
+		case MOVEUSE_ACTION_MONSTERONMAP:
+		case MOVEUSE_ACTION_EFFECTONMAP:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Value[0] = Parameters[1];
+			break;
+		}
+
+		case MOVEUSE_ACTION_MONSTER:
+		case MOVEUSE_ACTION_EFFECT:{
+			Code->ObjNr = Parameters[0];
+			Code->Value[0] = Parameters[1];
+			break;
+		}
+
+		case MOVEUSE_ACTION_TEXTONMAP:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Value[0] = Parameters[1];
+			Code->Value[1] = Parameters[2];
+			break;
+		}
+
+		case MOVEUSE_ACTION_TEXT:
+		case MOVEUSE_ACTION_SETATTRIBUTE:
+		case MOVEUSE_ACTION_CHANGEATTRIBUTE:
+		case MOVEUSE_ACTION_SETQUESTVALUE:{
+			Code->ObjNr = Parameters[0];
+			Code->Value[0] = Parameters[1];
+			Code->Value[1] = Parameters[2];
+			break;
+		}
+
+		case MOVEUSE_ACTION_CHANGEONMAP:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Type = Parameters[1];
+			Code->Type2 = Parameters[2];
+			Code->Value[0] = Parameters[3];
+			break;
+		}
+
+		case MOVEUSE_ACTION_CHANGEREL:{
+			Code->ObjNr = Parameters[0];
+			UnpackRelativeCoordinate(Parameters[1], &Code->X, &Code->Y, &Code->Z);
+			Code->Type = Parameters[2];
+			Code->Type2 = Parameters[3];
+			Code->Value[0] = Parameters[4];
+			break;
+		}
+
+		case MOVEUSE_ACTION_DAMAGE:{
+			Code->ObjNr = Parameters[0];
+			Code->ObjNr2 = Parameters[1];
+			Code->Value[0] = Parameters[2];
+			Code->Value[1] = Parameters[3];
+			break;
+		}
+
+		case MOVEUSE_ACTION_SETSTART:
+		case MOVEUSE_ACTION_MOVEALL:
+		case MOVEUSE_ACTION_MOVETOP:
+		case MOVEUSE_ACTION_MOVE:{
+			Code->ObjNr = Parameters[0];
+			UnpackAbsoluteCoordinate(Parameters[1], &Code->X, &Code->Y, &Code->Z);
+			break;
+		}
+
+		case MOVEUSE_ACTION_WRITENAME:{
+			Code->ObjNr = Parameters[0];
+			Code->Value[0] = Parameters[1];
+			Code->ObjNr2 = Parameters[2];
+			break;
+		}
+
+		case MOVEUSE_ACTION_WRITETEXT:{
+			Code->Value[0] = Parameters[0];
+			Code->ObjNr = Parameters[1];
+			break;
+		}
+
+		case MOVEUSE_ACTION_LOGOUT:
+		case MOVEUSE_ACTION_DELETE:
+		case MOVEUSE_ACTION_SENDMAIL:{
+			Code->ObjNr = Parameters[0];
+			break;
+		}
+
+		case MOVEUSE_ACTION_MOVEALLONMAP:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			UnpackAbsoluteCoordinate(Parameters[1], &Code->X2, &Code->Y2, &Code->Z2);
+			break;
+		}
+
+		case MOVEUSE_ACTION_MOVEALLREL:
+		case MOVEUSE_ACTION_MOVETOPREL:{
+			Code->ObjNr = Parameters[0];
+			UnpackRelativeCoordinate(Parameters[1], &Code->X, &Code->Y, &Code->Z);
+			break;
+		}
+
+		case MOVEUSE_ACTION_MOVETOPONMAP:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Type = Parameters[1];
+			UnpackAbsoluteCoordinate(Parameters[2], &Code->X2, &Code->Y2, &Code->Z2);
+			break;
+		}
+
+		case MOVEUSE_ACTION_MOVEREL:{
+			Code->ObjNr = Parameters[0];
+			Code->ObjNr2 = Parameters[1];
+			UnpackRelativeCoordinate(Parameters[2], &Code->X, &Code->Y, &Code->Z);
+			break;
+		}
+
+		case MOVEUSE_ACTION_RETRIEVE:{
+			Code->ObjNr = Parameters[0];
+			UnpackRelativeCoordinate(Parameters[1], &Code->X, &Code->Y, &Code->Z);
+			UnpackRelativeCoordinate(Parameters[2], &Code->X2, &Code->Y2, &Code->Z2);
+			break;
+		}
+
+		case MOVEUSE_ACTION_DELETEALLONMAP:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			break;
+		}
+
+		case MOVEUSE_ACTION_DELETETOPONMAP:
+		case MOVEUSE_ACTION_DELETEONMAP:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Type = Parameters[1];
+			break;
+		}
+
+		case MOVEUSE_ACTION_DESCRIPTION:{
+			Code->ObjNr = Parameters[0];
+			Code->ObjNr2 = Parameters[1];
+			break;
+		}
+
+		case MOVEUSE_ACTION_LOADDEPOT:
+		case MOVEUSE_ACTION_SAVEDEPOT:{
+			UnpackAbsoluteCoordinate(Parameters[0], &Code->X, &Code->Y, &Code->Z);
+			Code->Type = Parameters[1];
+			Code->ObjNr = Parameters[2];
+			Code->Value[0] = Parameters[3];
+			break;
+		}
+
+		case MOVEUSE_ACTION_NOP:{
+			// no-op
+			break;
+		}
+
+		default:{
+			error("CompileAction: Unbekannte Aktion %d.\n", Action->Action);
+			break;
+		}
+	}
+}
+
+void CompileDataBase(TMoveUseDatabase *DB){
+	for(int TypeID = DB->FirstTypeRule.min; TypeID <= DB->FirstTypeRule.max; TypeID += 1){
+		*DB->FirstTypeRule.at(TypeID) = 0;
+	}
+	DB->FirstGenericRule = 0;
+
+	// NOTE(fusion): Rules are prepended in reverse so chains end up ascending.
+	int TypeRules = 0;
+	for(int RuleNr = DB->NumberOfRules; RuleNr >= 1; RuleNr -= 1){
+		TMoveUseRule *Rule = DB->Rules.at(RuleNr);
+		Rule->ConditionCode = &MoveUseConditionCode[Rule->FirstCondition];
+		Rule->NumberOfConditions = Rule->LastCondition - Rule->FirstCondition + 1;
+		Rule->ActionCode = &MoveUseActionCode[Rule->FirstAction];
+		Rule->NumberOfActions = Rule->LastAction - Rule->FirstAction + 1;
+
+		TMoveUseInstruction *Condition = Rule->ConditionCode;
+		if(Condition->Modifier == MOVEUSE_MODIFIER_NORMAL
+				&& Condition->Opcode == MOVEUSE_CONDITION_ISTYPE
+				&& Condition->ObjNr == MOVEUSE_OBJECT_OBJ1){
+			int *First = DB->FirstTypeRule.at(Condition->Type.TypeID);
+			Rule->NextRule = *First;
+			*First = RuleNr;
+			TypeRules += 1;
+		}else{
+			Rule->NextRule = DB->FirstGenericRule;
+			DB->FirstGenericRule = RuleNr;
+		}
+	}
+
+	print(2, "%d von %d Regeln nach Objekttyp indiziert.\n", TypeRules, DB->NumberOfRules);
+}
+
 void LoadDataBase(void){
 	print(1, "Lade Move/Use-Datenbank ...\n");
 
@@ -3050,6 +3317,26 @@ void LoadDataBase(void){
 
 	Script.close();
 
+	// NOTE(fusion): `vector::at` may move entries around while the tables still
+	// grow, so rules can only be compiled after everything has been read. The
+	// compiled tables are indexed like the source tables, leaving entry zero
+	// unused.
+	delete[] MoveUseConditionCode;
+	MoveUseConditionCode = new TMoveUseInstruction[NumberOfMoveUseConditions + 1]();
+	for(int i = 1; i <= NumberOfMoveUseConditions; i += 1){
+		CompileCondition(MoveUseConditions.at(i), &MoveUseConditionCode[i]);
+	}
+
+	delete[] MoveUseActionCode;
+	MoveUseActionCode = new TMoveUseInstruction[NumberOfMoveUseActions + 1]();
+	for(int i = 1; i <= NumberOfMoveUseActions; i += 1){
+		CompileAction(MoveUseActions.at(i), &MoveUseActionCode[i]);
+	}
+
+	for(int i = 0; i < NARRAY(MoveUseDatabases); i += 1){
+		CompileDataBase(&MoveUseDatabases[i]);
+	}
+
 	print(1, "Move/Use-Datenbank mit %d/%d/%d/%d/%d Regeln gelesen.\n",
 			MoveUseDatabases[MOVEUSE_EVENT_USE].NumberOfRules,
 			MoveUseDatabases[MOVEUSE_EVENT_MULTIUSE].NumberOfRules,
@@ -3058,6 +3345,16 @@ void LoadDataBase(void){
 			MoveUseDatabases[MOVEUSE_EVENT_SEPARATION].NumberOfRules);
 }
 
+void MoveUseSummary(void){
+	if(MoveUseEvents > 0){
+		Log("game", "%d Move/Use-Ereignisse mit %d Bedingungen und %d Aktionen.\n",
+				MoveUseEvents, MoveUseConditionChecks, MoveUseActionCount);
+	}
+	MoveUseEvents = 0;
+	MoveUseConditionChecks = 0;
+	MoveUseActionCount = 0;
+}
+
 void InitMoveUse(void){
 	NumberOfMoveUseConditions = 0;
 	NumberOfMoveUseActions = 0;
@@ -3070,4 +3367,9 @@ void ExitMoveUse(void){
 		error("ExitMoveUse: Paket an %u wurde nicht zugestellt.\n",
 				DelayedMail.at(i)->CharacterID);
 	}
+
+	delete[] MoveUseConditionCode;
+	MoveUseConditionCode = NULL;
+	delete[] MoveUseActionCode;
+	MoveUseActionCode = NULL;
 }
@@ -109,28 +109,73 @@ enum MoveUseParameterType: int {
 	MOVEUSE_PARAMETER_COMPARISON			= 11,
 };
 
+enum MoveUseObjectType: int {
+	MOVEUSE_OBJECT_NULL						= 0,
+	MOVEUSE_OBJECT_OBJ1						= 1,
+	MOVEUSE_OBJECT_OBJ2						= 2,
+	MOVEUSE_OBJECT_USER						= 3,
+	MOVEUSE_OBJECT_TEMP						= 4,
+	MOVEUSE_OBJECT_COUNT					= 5,
+};
+
 struct TMoveUseAction {
 	MoveUseActionType Action;
 	int Parameters[MOVEUSE_MAX_PARAMETERS];
 };
 
+struct TMoveUseCondition {
+	MoveUseModifierType Modifier;
+	MoveUseConditionType Condition;
+	int Parameters[MOVEUSE_MAX_PARAMETERS];
+};
+
+// NOTE(fusion): Conditions and actions are compiled into instructions once the
+// database is loaded. Object parameters become indices into the event's object
+// array, coordinates and vectors are unpacked, and object types are resolved,
+// so evaluating a rule doesn't need to decode any parameters. `Opcode` is the
+// condition or action type.
+struct TMoveUseInstruction {
+	int Opcode;
+	MoveUseModifierType Modifier;
+	int ObjNr;
+	int ObjNr2;
+	ObjectType Type;
+	ObjectType Type2;
+	int Operator;
+	int Value[3];
+	int X, Y, Z;
+	int X2, Y2, Z2;
+};
+
+// NOTE(fusion): `ConditionCode` and `ActionCode` are filled in by
+// `CompileDataBase` once loading is done and point into the compiled condition
+// and action tables.
 struct TMoveUseRule {
 	int FirstCondition;
 	int LastCondition;
 	int FirstAction;
 	int LastAction;
+	int NextRule;
+	TMoveUseInstruction *ConditionCode;
+	int NumberOfConditions;
+	TMoveUseInstruction *ActionCode;
+	int NumberOfActions;
 };
 
-struct TMoveUseCondition {
-	MoveUseModifierType Modifier;
-	MoveUseConditionType Condition;
-	int Parameters[MOVEUSE_MAX_PARAMETERS];
-};
-
+// NOTE(fusion): Rules whose first condition is `IsType(Obj1, Type)` are chained
+// through `NextRule` in ascending order starting at `FirstTypeRule[Type]`. All
+// other rules are chained the same way starting at `FirstGenericRule`. Zero is
+// used as the end of a chain, since rules are numbered from one.
 struct TMoveUseDatabase {
-	TMoveUseDatabase(void) : Rules(1, 100, 100), NumberOfRules(0) {}
+	TMoveUseDatabase(void) :
+		Rules(1, 100, 100),
+		FirstTypeRule(0, 5000, 1000, 0),
+		FirstGenericRule(0),
+		NumberOfRules(0) {}
 
 	vector<TMoveUseRule> Rules;
+	vector<int> FirstTypeRule;
+	int FirstGenericRule;
 	int NumberOfRules;
 };
 
@@ -146,10 +191,8 @@ void UnpackAbsoluteCoordinate(int Packed, int *x, int *y, int *z);
 int PackRelativeCoordinate(int x, int y, int z);
 void UnpackRelativeCoordinate(int Packed, int *x, int *y, int *z);
 
-Object GetEventObject(int Nr, Object User, Object Obj1, Object Obj2, Object Temp);
 bool Compare(int Value1, int Operator, int Value2);
-bool CheckCondition(MoveUseEventType EventType, TMoveUseCondition *Condition,
-		Object User, Object Obj1, Object Obj2, Object *Temp);
+bool CheckCondition(MoveUseEventType EventType, TMoveUseInstruction *Condition, Object *Objects);
 Object CreateObject(Object Con, ObjectType Type, uint32 Value);
 void ChangeObject(Object Obj, ObjectType NewType, uint32 Value);
 void MoveOneObject(Object Obj, Object Con);
@@ -161,8 +204,7 @@ void SaveDepotBox(uint32 CreatureID, int Nr, Object Con);
 void SendMail(Object Obj);
 void SendMails(TPlayerData *PlayerData);
 void TextEffect(const char *Text, int x, int y, int z, int Radius);
-void ExecuteAction(MoveUseEventType EventType, TMoveUseAction *Action,
-		Object User, Object Obj1, Object Obj2, Object *Temp);
+void ExecuteAction(MoveUseEventType EventType, TMoveUseInstruction *Action, Object *Objects);
 bool HandleEvent(MoveUseEventType EventType, Object User, Object Obj1, Object Obj2);
 
 void UseContainer(uint32 CreatureID, Object Con, int NextContainerNr);
@@ -186,9 +228,13 @@ void CollisionEvent(Object Obj, Object Dest);
 void LoadParameters(TReadScriptFile *Script, int *Parameters, int NumberOfParameters, ...);
 void LoadCondition(TReadScriptFile *Script, TMoveUseCondition *Condition);
 void LoadAction(TReadScriptFile *Script, TMoveUseAction *Action);
+void CompileCondition(TMoveUseCondition *Condition, TMoveUseInstruction *Code);
+void CompileAction(TMoveUseAction *Action, TMoveUseInstruction *Code);
+void CompileDataBase(TMoveUseDatabase *DB);
 void LoadDataBase(void);
 
 
+void MoveUseSummary(void);
 void InitMoveUse(void);
 void ExitMoveUse(void);
 
@@ -42,6 +42,7 @@ void AnnounceMovingCreature(uint32 CreatureID, Object Con){
 	int SearchRadiusY = 14 + (std::abs(Creature->posy - ConY) / 2) + 1;
 	int SearchCenterX = (Creature->posx + ConX) / 2;
 	int SearchCenterY = (Creature->posy + ConY) / 2;
+	TPacketFragment Fragment = {};
 	TFindCreatures Search(SearchRadiusX, SearchRadiusY, SearchCenterX, SearchCenterY, FIND_PLAYERS);
 	while(true){
 		uint32 CharacterID = Search.getNext();
@@ -54,7 +55,7 @@ void AnnounceMovingCreature(uint32 CreatureID, Object Con){
 			continue;
 		}
 
-		SendMoveCreature(Player->Connection, CreatureID, ConX, ConY, ConZ);
+		SendMoveCreature(Player->Connection, CreatureID, ConX, ConY, ConZ, &Fragment);
 	}
 }
 
@@ -95,9 +96,11 @@ void AnnounceChangedField(Object Obj, int Type){
 		return;
 	}
 
-	int ObjX, ObjY, ObjZ;
+	int ObjX, ObjY, ObjZ, MinZ, MaxZ;
 	GetObjectCoordinates(Obj, &ObjX, &ObjY, &ObjZ);
-	TFindCreatures Search(16, 14, ObjX, ObjY, FIND_PLAYERS);
+	GetSpectatorFloors(ObjZ, &MinZ, &MaxZ);
+	TPacketFragment Fragment = {};
+	TFindCreatures Search(16, 14, ObjX, ObjY, MinZ, MaxZ, FIND_PLAYERS);
 	while(true){
 		uint32 CharacterID = Search.getNext();
 		if(CharacterID == 0){
@@ -114,9 +117,9 @@ void AnnounceChangedField(Object Obj, int Type){
 		}
 
 		switch(Type){
-			case OBJECT_DELETED: SendDeleteField(Player->Connection, ObjX, ObjY, ObjZ, Obj); break;
-			case OBJECT_CREATED: SendAddField(Player->Connection,    ObjX, ObjY, ObjZ, Obj); break;
-			case OBJECT_CHANGED: SendChangeField(Player->Connection, ObjX, ObjY, ObjZ, Obj); break;
+			case OBJECT_DELETED: SendDeleteField(Player->Connection, ObjX, ObjY, ObjZ, Obj, &Fragment); break;
+			case OBJECT_CREATED: SendAddField(Player->Connection,    ObjX, ObjY, ObjZ, Obj, &Fragment); break;
+			case OBJECT_CHANGED: SendChangeField(Player->Connection, ObjX, ObjY, ObjZ, Obj, &Fragment); break;
 			default:{
 				error("AnnounceChangedField: Ungültiger Typ %d.\n", Type);
 				return;
@@ -215,7 +218,10 @@ void AnnounceGraphicalEffect(int x, int y, int z, int Type){
 		return;
 	}
 
-	TFindCreatures Search(16, 14, x, y, FIND_PLAYERS);
+	int MinZ, MaxZ;
+	GetSpectatorFloors(z, &MinZ, &MaxZ);
+	TPacketFragment Fragment = {};
+	TFindCreatures Search(16, 14, x, y, MinZ, MaxZ, FIND_PLAYERS);
 	while(true){
 		uint32 CharacterID = Search.getNext();
 		if(CharacterID == 0){
@@ -231,7 +237,7 @@ void AnnounceGraphicalEffect(int x, int y, int z, int Type){
 			continue;
 		}
 
-		SendGraphicalEffect(Player->Connection, x, y, z, Type);
+		SendGraphicalEffect(Player->Connection, x, y, z, Type, &Fragment);
 	}
 }
 
@@ -240,7 +246,10 @@ void AnnounceTextualEffect(int x, int y, int z, int Color, const char *Text){
 		return;
 	}
 
-	TFindCreatures Search(16, 14, x, y, FIND_PLAYERS);
+	int MinZ, MaxZ;
+	GetSpectatorFloors(z, &MinZ, &MaxZ);
+	TPacketFragment Fragment = {};
+	TFindCreatures Search(16, 14, x, y, MinZ, MaxZ, FIND_PLAYERS);
 	while(true){
 		uint32 CharacterID = Search.getNext();
 		if(CharacterID == 0){
@@ -256,7 +265,7 @@ void AnnounceTextualEffect(int x, int y, int z, int Color, const char *Text){
 			continue;
 		}
 
-		SendTextualEffect(Player->Connection, x, y, z, Color, Text);
+		SendTextualEffect(Player->Connection, x, y, z, Color, Text, &Fragment);
 	}
 }
 
@@ -270,7 +279,12 @@ void AnnounceMissile(int OrigX, int OrigY, int OrigZ,
 	int SearchRadiusY = 14 + (std::abs(OrigY - DestY) / 2) + 1;
 	int SearchCenterX = (OrigX + DestX) / 2;
 	int SearchCenterY = (OrigY + DestY) / 2;
-	TFindCreatures Search(SearchRadiusX, SearchRadiusY, SearchCenterX, SearchCenterY, FIND_PLAYERS);
+	int OrigMinZ, OrigMaxZ, DestMinZ, DestMaxZ;
+	GetSpectatorFloors(OrigZ, &OrigMinZ, &OrigMaxZ);
+	GetSpectatorFloors(DestZ, &DestMinZ, &DestMaxZ);
+	TPacketFragment Fragment = {};
+	TFindCreatures Search(SearchRadiusX, SearchRadiusY, SearchCenterX, SearchCenterY,
+			std::min<int>(OrigMinZ, DestMinZ), std::max<int>(OrigMaxZ, DestMaxZ), FIND_PLAYERS);
 	while(true){
 		uint32 CharacterID = Search.getNext();
 		if(CharacterID == 0){
@@ -289,7 +303,7 @@ void AnnounceMissile(int OrigX, int OrigY, int OrigZ,
 
 		SendMissileEffect(Player->Connection,
 				OrigX, OrigY, OrigZ,
-				DestX, DestY, DestZ, Type);
+				DestX, DestY, DestZ, Type, &Fragment);
 	}
 }
 
@@ -2789,7 +2803,10 @@ bool SectorRefreshable(int SectorX, int SectorY, int SectorZ){
 	int SearchRadiusY = 32 - 1;
 	int SearchCenterX = SectorX * 32 + (32 / 2);
 	int SearchCenterY = SectorY * 32 + (32 / 2);
-	TFindCreatures Search(SearchRadiusX, SearchRadiusY, SearchCenterX, SearchCenterY, FIND_PLAYERS);
+	int MinZ, MaxZ;
+	GetSpectatorFloors(SectorZ, &MinZ, &MaxZ);
+	TFindCreatures Search(SearchRadiusX, SearchRadiusY, SearchCenterX, SearchCenterY,
+			MinZ, MaxZ, FIND_PLAYERS);
 	while(true){
 		uint32 CharacterID = Search.getNext();
 		if(CharacterID == 0){
@@ -2810,20 +2827,20 @@ bool SectorRefreshable(int SectorX, int SectorY, int SectorZ){
 	return true;
 }
 
-void RefreshSector(int SectorX, int SectorY, int SectorZ, const uint8 *Data, int Count){
+void RefreshSector(int SectorX, int SectorY, int SectorZ){
 	if(!SectorRefreshable(SectorX, SectorY, SectorZ)){
 		return;
 	}
 
-	TReadBuffer Buffer(Data, Count);
-	RefreshSector(SectorX, SectorY, SectorZ, &Buffer);
+	RefreshSector(SectorX, SectorY, SectorZ, false);
 
 	// TODO(fusion): This function is very similar to `ApplyPatch`.
 	int SearchRadiusX = 32 / 2;
 	int SearchRadiusY = 32 / 2;
 	int SearchCenterX = SectorX * 32 + (32 / 2);
 	int SearchCenterY = SectorY * 32 + (32 / 2);
-	TFindCreatures Search(SearchRadiusX, SearchRadiusY, SearchCenterX, SearchCenterY, FIND_ALL);
+	TFindCreatures Search(SearchRadiusX, SearchRadiusY, SearchCenterX, SearchCenterY,
+			SectorZ, SectorZ, FIND_ALL);
 	while(true){
 		uint32 CreatureID = Search.getNext();
 		if(CreatureID == 0){
@@ -2882,77 +2899,12 @@ void RefreshSector(int SectorX, int SectorY, int SectorZ, const uint8 *Data, int
 }
 
 void RefreshMap(void){
-	TDynamicWriteBuffer HelpBuffer(KB(64));
 	for(int SectorZ = SectorZMin; SectorZ <= SectorZMax; SectorZ += 1)
 	for(int SectorY = SectorYMin; SectorY <= SectorYMax; SectorY += 1)
 	for(int SectorX = SectorXMin; SectorX <= SectorXMax; SectorX += 1){
-		if(!SectorRefreshable(SectorX, SectorY, SectorZ)){
-			continue;
-		}
-
-		char FileName[4096];
-		snprintf(FileName, sizeof(FileName), "%s/%04d-%04d-%02d.sec",
-				ORIGMAPPATH, SectorX, SectorY, SectorZ);
-		if(!FileExists(FileName)){
-			continue;
-		}
-
-		int OffsetX = -1;
-		int OffsetY = -1;
-		bool Refreshable = false;
-		HelpBuffer.Position = 0;
-		try{
-			TReadScriptFile Script;
-			Script.open(FileName);
-			while(true){
-				Script.nextToken();
-				if(Script.Token == ENDOFFILE){
-					Script.close();
-					break;
-				}
-
-				if(Script.Token == SPECIAL && Script.getSpecial() == ','){
-					continue;
-				}
-
-				if(Script.Token == BYTES){
-					uint8 *SectorOffset = Script.getBytesequence();
-					OffsetX = (int)SectorOffset[0];
-					OffsetY = (int)SectorOffset[1];
-					Refreshable = false;
-					Script.readSymbol(':');
-				}else if(Script.Token == IDENTIFIER){
-					if(OffsetX == -1 || OffsetY == -1){
-						Script.error("coordinate expected");
-					}
-
-					const char *Identifier = Script.getIdentifier();
-					if(strcmp(Identifier, "refresh") == 0){
-						// Check if this tile is a house tile
-						int AbsX = (SectorX * 32) + OffsetX;
-						int AbsY = (SectorY * 32) + OffsetY;
-						int AbsZ = SectorZ;
-						// Don't refresh house tiles to preserve player items
-						if(GetHouseID(AbsX, AbsY, AbsZ) == 0){
-							Refreshable = true;
-						}
-					}else if(strcmp(Identifier, "content") == 0){
-						Script.readSymbol('=');
-						if(Refreshable){
-							HelpBuffer.writeByte((uint8)OffsetX);
-							HelpBuffer.writeByte((uint8)OffsetY);
-						}
-						LoadObjects(&Script, &HelpBuffer, !Refreshable);
-					}
-				}
-			}
-
-			if(HelpBuffer.Position > 0){
-				TReadBuffer ReadBuffer(HelpBuffer.Data, HelpBuffer.Position);
-				RefreshSector(SectorX, SectorY, SectorZ, &ReadBuffer);
-			}
-		}catch(const char *str){
-			error("RefreshMap: Fehler beim Bearbeiten der Datei (%s).\n", str);
+		if(SectorRefreshable(SectorX, SectorY, SectorZ)){
+			// NOTE(fusion): Don't refresh house tiles to preserve player items.
+			RefreshSector(SectorX, SectorY, SectorZ, true);
 		}
 	}
 }
@@ -2978,9 +2930,7 @@ void RefreshCylinders(void){
 		for(int RefreshZ = SectorZMin;
 				RefreshZ <= SectorZMax;
 				RefreshZ += 1){
-			if(SectorRefreshable(RefreshX, RefreshY, RefreshZ)){
-				LoadSectorOrder(RefreshX, RefreshY, RefreshZ);
-			}
+			RefreshSector(RefreshX, RefreshY, RefreshZ);
 		}
 	}
 }
@@ -3002,7 +2952,8 @@ void ApplyPatch(int SectorX, int SectorY, int SectorZ,
 	int SearchRadiusY = 32 / 2;
 	int SearchCenterX = SectorX * 32 + (32 / 2);
 	int SearchCenterY = SectorY * 32 + (32 / 2);
-	TFindCreatures Search(SearchRadiusX, SearchRadiusY, SearchCenterX, SearchCenterY, FIND_ALL);
+	TFindCreatures Search(SearchRadiusX, SearchRadiusY, SearchCenterX, SearchCenterY,
+			SectorZ, SectorZ, FIND_ALL);
 	while(true){
 		uint32 CreatureID = Search.getNext();
 		if(CreatureID == 0){
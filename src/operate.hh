@@ -157,7 +157,7 @@ void DeleteAtCreature(uint32 CreatureID, ObjectType Type, int Amount, uint32 Val
 
 void ProcessCronSystem(void);
 bool SectorRefreshable(int SectorX, int SectorY, int SectorZ);
-void RefreshSector(int SectorX, int SectorY, int SectorZ, const uint8 *Data, int Count);
+void RefreshSector(int SectorX, int SectorY, int SectorZ);
 void RefreshMap(void);
 void RefreshCylinders(void);
 void ApplyPatch(int SectorX, int SectorY, int SectorZ,
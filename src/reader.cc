@@ -9,6 +9,7 @@ static ThreadHandle ReaderThread;
 static TReaderThreadOrder OrderBuffer[200];
 static int OrderPointerWrite;
 static int OrderPointerRead;
+static Semaphore OrderBufferMutex(1);
 static Semaphore OrderBufferEmpty(NARRAY(OrderBuffer));
 static Semaphore OrderBufferFull(0);
 
@@ -16,8 +17,6 @@ static TReaderThreadReply ReplyBuffer[200];
 static int ReplyPointerWrite;
 static int ReplyPointerRead;
 
-static TDynamicWriteBuffer HelpBuffer(KB(64));
-
 // Reader Orders
 // =============================================================================
 void InitReaderBuffers(void){
@@ -27,14 +26,9 @@ void InitReaderBuffers(void){
 	ReplyPointerRead = 0;
 }
 
-void InsertOrder(TReaderThreadOrderType OrderType,
+static void WriteOrder(TReaderThreadOrderType OrderType,
 		int SectorX, int SectorY, int SectorZ, uint32 CharacterID){
-	int Orders = (OrderPointerWrite - OrderPointerRead);
-	if(Orders >= NARRAY(OrderBuffer)){
-		error("InsertOrder (Reader): Order-Puffer ist voll => Vergrößern.\n");
-	}
-
-	OrderBufferEmpty.down();
+	// NOTE(fusion): The caller must hold `OrderBufferMutex` and an empty slot.
 	int WritePos = OrderPointerWrite % NARRAY(OrderBuffer);
 	OrderBuffer[WritePos].OrderType = OrderType;
 	OrderBuffer[WritePos].SectorX = SectorX;
@@ -42,13 +36,30 @@ void InsertOrder(TReaderThreadOrderType OrderType,
 	OrderBuffer[WritePos].SectorZ = SectorZ;
 	OrderBuffer[WritePos].CharacterID = CharacterID;
 	OrderPointerWrite += 1;
+}
+
+void InsertOrder(TReaderThreadOrderType OrderType,
+		int SectorX, int SectorY, int SectorZ, uint32 CharacterID){
+	OrderBufferMutex.down();
+	int Orders = (OrderPointerWrite - OrderPointerRead);
+	OrderBufferMutex.up();
+	if(Orders >= NARRAY(OrderBuffer)){
+		error("InsertOrder (Reader): Order-Puffer ist voll => Vergrößern.\n");
+	}
+
+	OrderBufferEmpty.down();
+	OrderBufferMutex.down();
+	WriteOrder(OrderType, SectorX, SectorY, SectorZ, CharacterID);
+	OrderBufferMutex.up();
 	OrderBufferFull.up();
 }
 
 void GetOrder(TReaderThreadOrder *Order){
 	OrderBufferFull.down();
+	OrderBufferMutex.down();
 	*Order = OrderBuffer[OrderPointerRead % NARRAY(OrderBuffer)];
 	OrderPointerRead += 1;
+	OrderBufferMutex.up();
 	OrderBufferEmpty.up();
 }
 
@@ -56,75 +67,29 @@ void TerminateReaderOrder(void){
 	InsertOrder(READER_ORDER_TERMINATE, 0, 0, 0, 0);
 }
 
-void LoadSectorOrder(int SectorX, int SectorY, int SectorZ){
-	InsertOrder(READER_ORDER_LOADSECTOR, SectorX, SectorY, SectorZ, 0);
-}
-
 void LoadCharacterOrder(uint32 CharacterID){
 	InsertOrder(READER_ORDER_LOADCHARACTER, 0, 0, 0, CharacterID);
 }
 
-void ProcessLoadSectorOrder(int SectorX, int SectorY, int SectorZ){
-	// TODO(fusion): We parsed sector files way too many times now. And there
-	// is also a drop in loader quality.
-	char FileName[4096];
-	snprintf(FileName, sizeof(FileName), "%s/%04d-%04d-%02d.sec",
-			ORIGMAPPATH, SectorX, SectorY, SectorZ);
-	if(!FileExists(FileName)){
-		return;
-	}
-
-	int OffsetX = -1;
-	int OffsetY = -1;
-	bool Refreshable = false;
-	HelpBuffer.Position = 0;
-
-	TReadScriptFile Script;
-	Script.open(FileName);
-	while(true){
-		Script.nextToken();
-		if(Script.Token == ENDOFFILE){
-			Script.close();
-			break;
-		}
-
-		if(Script.Token == SPECIAL && Script.getSpecial() == ','){
-			continue;
-		}
-
-		if(Script.Token == BYTES){
-			uint8 *Offset = Script.getBytesequence();
-			OffsetX = (int)Offset[0];
-			OffsetY = (int)Offset[1];
-			Refreshable = false;
-			Script.readSymbol(':');
-		}else if(Script.Token == IDENTIFIER){
-			if(OffsetX == -1 || OffsetY == -1){
-				Script.error("coordinate expected");
-			}
-
-			const char *Identifier = Script.getIdentifier();
-			if(strcmp(Identifier, "refresh") == 0){
-				Refreshable = true;
-			}else if(strcmp(Identifier, "content") == 0){
-				Script.readSymbol('=');
-
-				if(Refreshable){
-					HelpBuffer.writeByte((uint8)OffsetX);
-					HelpBuffer.writeByte((uint8)OffsetY);
-				}
-
-				LoadObjects(&Script, &HelpBuffer, !Refreshable);
-			}
-		}
+bool PrefetchSectorOrder(int SectorX, int SectorY, int SectorZ){
+	// NOTE(fusion): Prefetching is only an optimization so we don't want the game
+	// thread to ever block on it. Leave at least half of the buffer for orders
+	// that actually need to be carried out.
+	OrderBufferMutex.down();
+	int Orders = (OrderPointerWrite - OrderPointerRead);
+	if(Orders >= NARRAY(OrderBuffer) / 2){
+		OrderBufferMutex.up();
+		return false;
 	}
 
-	int Size = HelpBuffer.Position;
-	if(Size > 0){
-		uint8 *Data = new uint8[Size];
-		memcpy(Data, HelpBuffer.Data, Size);
-		SectorReply(SectorX, SectorY, SectorZ, Data, Size);
-	}
+	// NOTE(fusion): With less than half of the buffer in use, there is always an
+	// empty slot left unless there are that many threads stuck in `InsertOrder`,
+	// so this won't block while holding the mutex.
+	OrderBufferEmpty.down();
+	WriteOrder(READER_ORDER_PREFETCHSECTOR, SectorX, SectorY, SectorZ, 0);
+	OrderBufferMutex.up();
+	OrderBufferFull.up();
+	return true;
 }
 
 void ProcessLoadCharacterOrder(uint32 CharacterID){
@@ -159,13 +124,13 @@ int ReaderThreadLoop(void *Unused){
 		}
 
 		switch(Order.OrderType){
-			case READER_ORDER_LOADSECTOR:{
-				ProcessLoadSectorOrder(Order.SectorX, Order.SectorY, Order.SectorZ);
+			case READER_ORDER_LOADCHARACTER:{
+				ProcessLoadCharacterOrder(Order.CharacterID);
 				break;
 			}
 
-			case READER_ORDER_LOADCHARACTER:{
-				ProcessLoadCharacterOrder(Order.CharacterID);
+			case READER_ORDER_PREFETCHSECTOR:{
+				LoadSwappedSector(Order.SectorX, Order.SectorY, Order.SectorZ);
 				break;
 			}
 
@@ -208,20 +173,10 @@ bool GetReply(TReaderThreadReply *Reply){
 	return Result;
 }
 
-void SectorReply(int SectorX, int SectorY, int SectorZ, uint8 *Data, int Size){
-	InsertReply(READER_REPLY_SECTORDATA, SectorX, SectorY, SectorZ, Data, Size);
-}
-
 void CharacterReply(uint32 CharacterID){
 	InsertReply(READER_REPLY_CHARACTERDATA, 0, 0, 0, NULL, (int)CharacterID);
 }
 
-void ProcessSectorReply(TRefreshSectorFunction *RefreshSector,
-		int SectorX, int SectorY, int SectorZ, uint8 *Data, int Size){
-	RefreshSector(SectorX, SectorY, SectorZ, Data, Size);
-	delete[] Data;
-}
-
 void ProcessCharacterReply(TSendMailsFunction *SendMails, uint32 CharacterID){
 	TPlayerData *Slot = AttachPlayerPoolSlot(CharacterID, true);
 	if(Slot == NULL){
@@ -234,17 +189,10 @@ void ProcessCharacterReply(TSendMailsFunction *SendMails, uint32 CharacterID){
 	ReleasePlayerPoolSlot(Slot);
 }
 
-void ProcessReaderThreadReplies(TRefreshSectorFunction *RefreshSector, TSendMailsFunction *SendMails){
+void ProcessReaderThreadReplies(TSendMailsFunction *SendMails){
 	TReaderThreadReply Reply = {};
 	while(GetReply(&Reply)){
 		switch(Reply.ReplyType){
-			case READER_REPLY_SECTORDATA:{
-				ProcessSectorReply(RefreshSector,
-						Reply.SectorX, Reply.SectorY, Reply.SectorZ,
-						Reply.Data, Reply.Size);
-				break;
-			}
-
 			case READER_REPLY_CHARACTERDATA:{
 				ProcessCharacterReply(SendMails, (uint32)Reply.Size);
 				break;
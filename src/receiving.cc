@@ -1,10 +1,9 @@
 #include "connections.hh"
+#include "communication.hh"
 #include "houses.hh"
 #include "info.hh"
 #include "writer.hh"
 
-#include <signal.h>
-
 bool CommandAllowed(TConnection *Connection, int Command){
 	if(Connection == NULL){
 		error("CommandAllowed: Connection ist NULL.\n");
@@ -1794,20 +1793,20 @@ void ReceiveData(TConnection *Connection){
 }
 
 void ReceiveData(void){
-	TConnection *Connection = GetFirstConnection();
-	while(Connection != NULL){
-		if(Connection->Live() && Connection->WaitingForACK){
+	// NOTE(fusion): Commands are copied into the connection's `InData` one at a
+	// time, right before being dispatched, which allows the network thread to
+	// keep assembling the next packets in the meantime.
+	TCommand *Command = TakeCommands();
+	while(Command != NULL){
+		TCommand *Next = Command->Next;
+		TConnection *Connection = Command->Connection;
+		if(Connection->Live()){
+			memcpy(Connection->InData + 2, Command->Data, Command->Size);
+			Connection->InDataSize = Command->Size;
 			ReceiveData(Connection);
-			Connection->WaitingForACK = false;
-			// NOTE(fusion): `SIGUSR1` is used to signal the connection thread
-			// that we parsed all received data and that it may resume reading.
-			// We check if the connection is still live because it may have been
-			// disconnected inside `ReceiveData`.
-			if(Connection->Live()){
-				tgkill(GetGameProcessID(), Connection->GetThreadID(), SIGUSR1);
-			}
 		}
-		Connection = GetNextConnection();
+		ReleaseCommand(Command);
+		Command = Next;
 	}
 }
 
@@ -1,4 +1,5 @@
 #include "connections.hh"
+#include "communication.hh"
 #include "config.hh"
 #include "cr.hh"
 #include "info.hh"
@@ -6,8 +7,6 @@
 #include "map.hh"
 #include "writer.hh"
 
-#include <signal.h>
-
 #define MAX_OBJECTS_PER_POINT		10
 #define MAX_OBJECTS_PER_CONTAINER	36
 
@@ -87,10 +86,10 @@ void SendAll(void){
 	while(Connection != NULL){
 		if(Connection->WillingToSend){
 			Connection->WillingToSend = false;
-			// NOTE(fusion): `SIGUSR2` is used to signal the connection thread
-			// that there is pending data in the connection's output buffer.
+			// NOTE(fusion): Let the connection's network thread know that there
+			// is pending data in the connection's output buffer.
 			if(Connection->Live() && Connection->NextToCommit > Connection->NextToSend){
-				tgkill(GetGameProcessID(), Connection->GetThreadID(), SIGUSR2);
+				WakeConnection(Connection);
 			}
 		}else{
 			error("SendAll: Verbindung ist nicht sendewillig.\n");
@@ -254,6 +253,60 @@ static void SendItem(TConnection *Connection, Object Obj){
 	}
 }
 
+// NOTE(fusion): Announcements are sent to every player in range and, for the most
+// part, encode to the exact same bytes for all of them. The first viewer encodes
+// the packet as usual and we take the encoded bytes straight out of its output
+// buffer, so following viewers only need a copy. Everything is done within the
+// same announcement on the game thread, which is why the fragment doesn't need
+// any reference counting and may simply live on the stack.
+static bool SendFragment(TConnection *Connection, TPacketFragment *Fragment){
+	if(Fragment == NULL || Fragment->Size <= 0){
+		return false;
+	}
+
+	SendBytes(Connection, Fragment->Data, Fragment->Size);
+	FinishSendData(Connection);
+	return true;
+}
+
+static void StoreFragment(TConnection *Connection, int Start, TPacketFragment *Fragment){
+	if(Fragment == NULL || Connection->Overflow){
+		return;
+	}
+
+	int Size = Connection->NextToCommit - Start;
+	if(Size <= 0 || Size > (int)sizeof(Fragment->Data)){
+		return;
+	}
+
+	int OutDataCapacity = (int)sizeof(Connection->OutData);
+	int BufferStart = Start % OutDataCapacity;
+	int BufferEnd = BufferStart + Size;
+	if(BufferEnd <= OutDataCapacity){
+		memcpy(&Fragment->Data[0], &Connection->OutData[BufferStart], Size);
+	}else{
+		int Size1 = OutDataCapacity - BufferStart;
+		int Size2 = BufferEnd - OutDataCapacity;
+		memcpy(&Fragment->Data[0],     &Connection->OutData[BufferStart], Size1);
+		memcpy(&Fragment->Data[Size1], &Connection->OutData[0],           Size2);
+	}
+
+	Fragment->Size = Size;
+}
+
+// NOTE(fusion): Creatures are encoded depending on what the viewer already knows
+// about them. Only the short form for creatures that are known and up to date is
+// the same for every viewer.
+static bool IsSharedMapObject(TConnection *Connection, Object Obj){
+	if(!Obj.getObjectType().isCreatureContainer()){
+		return true;
+	}
+
+	TCreature *Creature = GetCreature(Obj);
+	return Creature != NULL
+		&& Connection->KnownCreature(Creature->ID, false) == KNOWNCREATURE_UPTODATE;
+}
+
 void SkipFlush(TConnection *Connection){
 	while(Skip >= 0){
 		int Count = std::min<int>(Skip, UINT8_MAX);
@@ -662,6 +715,11 @@ void SendFieldData(TConnection *Connection, int x, int y, int z){
 }
 
 void SendAddField(TConnection *Connection, int x, int y, int z, Object Obj){
+	SendAddField(Connection, x, y, z, Obj, NULL);
+}
+
+void SendAddField(TConnection *Connection, int x, int y, int z, Object Obj,
+		TPacketFragment *Fragment){
 	if(!BeginSendData(Connection)){
 		return;
 	}
@@ -671,15 +729,30 @@ void SendAddField(TConnection *Connection, int x, int y, int z, Object Obj){
 		return;
 	}
 
+	if(Fragment != NULL && !IsSharedMapObject(Connection, Obj)){
+		Fragment = NULL;
+	}
+
+	if(SendFragment(Connection, Fragment)){
+		return;
+	}
+
+	int Start = Connection->NextToWrite;
 	SendByte(Connection, SV_CMD_ADD_FIELD);
 	SendWord(Connection, (uint16)x);
 	SendWord(Connection, (uint16)y);
 	SendByte(Connection, (uint8)z);
 	SendMapObject(Connection, Obj);
 	FinishSendData(Connection);
+	StoreFragment(Connection, Start, Fragment);
 }
 
 void SendChangeField(TConnection *Connection, int x, int y, int z, Object Obj){
+	SendChangeField(Connection, x, y, z, Obj, NULL);
+}
+
+void SendChangeField(TConnection *Connection, int x, int y, int z, Object Obj,
+		TPacketFragment *Fragment){
 	if(!BeginSendData(Connection)){
 		return;
 	}
@@ -689,8 +762,17 @@ void SendChangeField(TConnection *Connection, int x, int y, int z, Object Obj){
 		return;
 	}
 
+	if(Fragment != NULL && !IsSharedMapObject(Connection, Obj)){
+		Fragment = NULL;
+	}
+
+	if(SendFragment(Connection, Fragment)){
+		return;
+	}
+
 	int ObjIndex = GetObjectRNum(Obj);
 	if(ObjIndex < MAX_OBJECTS_PER_POINT){
+		int Start = Connection->NextToWrite;
 		SendByte(Connection, SV_CMD_CHANGE_FIELD);
 		SendWord(Connection, (uint16)x);
 		SendWord(Connection, (uint16)y);
@@ -698,10 +780,16 @@ void SendChangeField(TConnection *Connection, int x, int y, int z, Object Obj){
 		SendByte(Connection, (uint8)ObjIndex);
 		SendMapObject(Connection, Obj);
 		FinishSendData(Connection);
+		StoreFragment(Connection, Start, Fragment);
 	}
 }
 
 void SendDeleteField(TConnection *Connection, int x, int y, int z, Object Obj){
+	SendDeleteField(Connection, x, y, z, Obj, NULL);
+}
+
+void SendDeleteField(TConnection *Connection, int x, int y, int z, Object Obj,
+		TPacketFragment *Fragment){
 	if(!BeginSendData(Connection)){
 		return;
 	}
@@ -711,19 +799,33 @@ void SendDeleteField(TConnection *Connection, int x, int y, int z, Object Obj){
 		return;
 	}
 
+	if(SendFragment(Connection, Fragment)){
+		return;
+	}
+
 	int ObjIndex = GetObjectRNum(Obj);
 	if(ObjIndex < MAX_OBJECTS_PER_POINT){
+		int Start = Connection->NextToWrite;
 		SendByte(Connection, SV_CMD_DELETE_FIELD);
 		SendWord(Connection, (uint16)x);
 		SendWord(Connection, (uint16)y);
 		SendByte(Connection, (uint8)z);
 		SendByte(Connection, (uint8)ObjIndex);
 		FinishSendData(Connection);
+		StoreFragment(Connection, Start, Fragment);
 	}
 }
 
 void SendMoveCreature(TConnection *Connection,
 		uint32 CreatureID, int DestX, int DestY, int DestZ){
+	SendMoveCreature(Connection, CreatureID, DestX, DestY, DestZ, NULL);
+}
+
+// NOTE(fusion): The fragment is only used when the creature is visible on both
+// ends, since that's the only case where the packet is the same for everyone.
+void SendMoveCreature(TConnection *Connection,
+		uint32 CreatureID, int DestX, int DestY, int DestZ,
+		TPacketFragment *Fragment){
 	if(Connection == NULL){
 		return;
 	}
@@ -742,7 +844,8 @@ void SendMoveCreature(TConnection *Connection,
 	bool WasVisible = OrigIndex < MAX_OBJECTS_PER_POINT
 			&& Connection->IsVisible(OrigX, OrigY, OrigZ);
 	if(IsVisible && WasVisible){
-		if(BeginSendData(Connection)){
+		if(BeginSendData(Connection) && !SendFragment(Connection, Fragment)){
+			int Start = Connection->NextToWrite;
 			SendByte(Connection, SV_CMD_MOVE_CREATURE);
 			SendWord(Connection, (uint16)OrigX);
 			SendWord(Connection, (uint16)OrigY);
@@ -752,6 +855,7 @@ void SendMoveCreature(TConnection *Connection,
 			SendWord(Connection, (uint16)DestY);
 			SendByte(Connection, (uint8)DestZ);
 			FinishSendData(Connection);
+			StoreFragment(Connection, Start, Fragment);
 		}
 	}else if(IsVisible){
 		SendAddField(Connection, DestX, DestY, DestZ, Creature->CrObject);
@@ -973,19 +1077,35 @@ void SendAmbiente(TConnection *Connection){
 }
 
 void SendGraphicalEffect(TConnection *Connection, int x, int y, int z, int Type){
+	SendGraphicalEffect(Connection, x, y, z, Type, NULL);
+}
+
+void SendGraphicalEffect(TConnection *Connection, int x, int y, int z, int Type,
+		TPacketFragment *Fragment){
 	if(!BeginSendData(Connection)){
 		return;
 	}
 
+	if(SendFragment(Connection, Fragment)){
+		return;
+	}
+
+	int Start = Connection->NextToWrite;
 	SendByte(Connection, SV_CMD_GRAPHICAL_EFFECT);
 	SendWord(Connection, (uint16)x);
 	SendWord(Connection, (uint16)y);
 	SendByte(Connection, (uint8)z);
 	SendByte(Connection, (uint8)Type);
 	FinishSendData(Connection);
+	StoreFragment(Connection, Start, Fragment);
 }
 
 void SendTextualEffect(TConnection *Connection, int x, int y, int z, int Color, const char *Text){
+	SendTextualEffect(Connection, x, y, z, Color, Text, NULL);
+}
+
+void SendTextualEffect(TConnection *Connection, int x, int y, int z, int Color, const char *Text,
+		TPacketFragment *Fragment){
 	if(Text == NULL){
 		error("SendTextualEffect: Text ist NULL.\n");
 		return;
@@ -1000,6 +1120,11 @@ void SendTextualEffect(TConnection *Connection, int x, int y, int z, int Color,
 		return;
 	}
 
+	if(SendFragment(Connection, Fragment)){
+		return;
+	}
+
+	int Start = Connection->NextToWrite;
 	SendByte(Connection, SV_CMD_TEXTUAL_EFFECT);
 	SendWord(Connection, (uint16)x);
 	SendWord(Connection, (uint16)y);
@@ -1007,14 +1132,25 @@ void SendTextualEffect(TConnection *Connection, int x, int y, int z, int Color,
 	SendByte(Connection, (uint8)Color);
 	SendString(Connection, Text);
 	FinishSendData(Connection);
+	StoreFragment(Connection, Start, Fragment);
 }
 
 void SendMissileEffect(TConnection *Connection, int OrigX, int OrigY, int OrigZ,
 		int DestX, int DestY, int DestZ, int Type){
+	SendMissileEffect(Connection, OrigX, OrigY, OrigZ, DestX, DestY, DestZ, Type, NULL);
+}
+
+void SendMissileEffect(TConnection *Connection, int OrigX, int OrigY, int OrigZ,
+		int DestX, int DestY, int DestZ, int Type, TPacketFragment *Fragment){
 	if(!BeginSendData(Connection)){
 		return;
 	}
 
+	if(SendFragment(Connection, Fragment)){
+		return;
+	}
+
+	int Start = Connection->NextToWrite;
 	SendByte(Connection, SV_CMD_MISSILE_EFFECT);
 	SendWord(Connection, (uint16)OrigX);
 	SendWord(Connection, (uint16)OrigY);
@@ -1024,6 +1160,7 @@ void SendMissileEffect(TConnection *Connection, int OrigX, int OrigY, int OrigZ,
 	SendByte(Connection, (uint8)DestZ);
 	SendByte(Connection, (uint8)Type);
 	FinishSendData(Connection);
+	StoreFragment(Connection, Start, Fragment);
 }
 
 void SendMarkCreature(TConnection *Connection, uint32 CreatureID, int Color){
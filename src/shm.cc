@@ -4,6 +4,7 @@
 #include "threads.hh"
 #include "writer.hh"
 
+#include <fcntl.h>
 #include <sys/shm.h>
 
 // NOTE(fusion): This looks like an interface to external tools. Looking at the
@@ -25,6 +26,22 @@ struct TSharedMemory {
 	GAMESTATE GameState;
 	pid_t GameProcessID;
 	pid_t GameThreadID;
+
+	// NOTE(fusion): Object hash table statistics, appended so the offsets of the
+	// original fields don't change. The load factor is in thousandths and the
+	// average probe length of the last round in hundredths.
+	uint32 HashTableSize;
+	uint32 HashTableLoad;
+	uint32 HashTableProbeLength;
+
+	// NOTE(fusion): Snapshot save status. The state is set to running by the
+	// game process before forking and to done or failed by the snapshot process
+	// right before it exits. Progress is counted in sectors.
+	pid_t SnapshotProcessID;
+	int SnapshotState;
+	int SnapshotProgress;
+	int SnapshotTotal;
+	uint32 SnapshotErrors;
 };
 
 static TSharedMemory *SHM = NULL;
@@ -204,6 +221,96 @@ uint32 GetObjectCounter(void){
 	return ObjectCounter;
 }
 
+void SetHashTableStatistics(uint32 Size, uint32 Load, uint32 ProbeLength){
+	if(SHM != NULL){
+		SHM->HashTableSize = Size;
+		SHM->HashTableLoad = Load;
+		SHM->HashTableProbeLength = ProbeLength;
+	}
+}
+
+// NOTE(fusion): The snapshot process is a fork of the game process and only
+// has the thread that forked it. Locks held by other threads at that point are
+// never released, so it can't go through the print buffer semaphore, the
+// protocol thread, or even stdio. Its output is written straight to the error
+// log and stdout with `write`, which doesn't take any user space lock.
+static int SnapshotErrorFile = -1;
+
+static void WriteSnapshotText(int File, const char *Text){
+	if(File == -1){
+		return;
+	}
+
+	int Length = (int)strlen(Text);
+	int Written = 0;
+	while(Written < Length){
+		int Ret = (int)write(File, &Text[Written], Length - Written);
+		if(Ret == -1){
+			if(errno == EINTR){
+				continue;
+			}
+			break;
+		}
+		Written += Ret;
+	}
+}
+
+static void SnapshotErrorHandler(const char *Text){
+	if(VerboseOutput){
+		WriteSnapshotText(STDOUT_FILENO, Text);
+	}
+
+	if(SHM != NULL){
+		SHM->SnapshotErrors += 1;
+	}
+
+	WriteSnapshotText(SnapshotErrorFile, Text);
+}
+
+static void SnapshotPrintHandler(int Level, const char *Text){
+	if(Level <= DebugLevel && VerboseOutput){
+		WriteSnapshotText(STDOUT_FILENO, Text);
+	}
+}
+
+void InitSnapshotProcess(void){
+	char FileName[4096];
+	snprintf(FileName, sizeof(FileName), "%s/error.log", LOGPATH);
+	SnapshotErrorFile = open(FileName, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+	SetErrorFunction(SnapshotErrorHandler);
+	SetPrintFunction(SnapshotPrintHandler);
+	if(SHM != NULL){
+		SHM->SnapshotErrors = 0;
+	}
+}
+
+void SetSnapshotState(int State){
+	if(SHM != NULL){
+		SHM->SnapshotState = State;
+	}
+}
+
+int GetSnapshotState(void){
+	int State = SNAPSHOT_IDLE;
+	if(SHM != NULL){
+		State = SHM->SnapshotState;
+	}
+	return State;
+}
+
+void SetSnapshotProcessID(pid_t Pid){
+	if(SHM != NULL){
+		SHM->SnapshotProcessID = Pid;
+	}
+}
+
+void SetSnapshotProgress(int Progress, int Total){
+	if(SHM != NULL){
+		SHM->SnapshotProgress = Progress;
+		SHM->SnapshotTotal = Total;
+	}
+}
+
 void IncrementPlayersOnline(void){
 	if(SHM != NULL){
 		SHM->PlayersOnline += 1;
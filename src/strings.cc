@@ -1,5 +1,6 @@
 #include "common.hh"
 #include "containers.hh"
+#include "writer.hh"
 
 struct TStaticStringTableBlock {
 	int TotalTextLength;
@@ -9,7 +10,12 @@ struct TStaticStringTableBlock {
 struct TDynamicStringTableBlock {
 	int FreeEntries;
 	int TotalTextLength;
+	int DeletedTextLength;
 	bool Dirty;
+	bool FreeListed;
+	int NextFreeBlock;
+	int NextDirtyBlock;
+	uint8 FreeEntry[256];
 	uint8 EntryType[256];
 	uint16 StringOffset[256];
 	char Text[32768];
@@ -19,6 +25,21 @@ constexpr int StaticBlockSize = NARRAY(TStaticStringTableBlock::Text);
 constexpr int DynamicBlockSize = NARRAY(TDynamicStringTableBlock::Text);
 constexpr int DynamicBlockEntries = NARRAY(TDynamicStringTableBlock::EntryType);
 
+// NOTE(fusion): Blocks with less text space than this are taken out of the
+// free block list until a cleanup gives them some space back.
+constexpr int DynamicBlockReserve = 64;
+
+// NOTE(fusion): Number of blocks in the free block list we look at before
+// giving up and allocating a new block for a string that doesn't fit.
+constexpr int DynamicBlockProbes = 4;
+
+// NOTE(fusion): A block is compacted once deleted strings make up this
+// percentage of its text, or when it ran out of entries. Each call to
+// `CleanupDynamicStrings` compacts queued blocks until it moved this many
+// bytes, so a burst of deletions is spread over several rounds.
+constexpr int DynamicCompactThreshold = 25;
+constexpr int DynamicCompactBudget = 64 * 1024;
+
 enum : uint8 {
 	DYNAMIC_STRING_FREE = 0,
 	DYNAMIC_STRING_ALLOCATED = 1,
@@ -28,6 +49,63 @@ enum : uint8 {
 static list<TStaticStringTableBlock> StaticStringTable;
 static list<TDynamicStringTableBlock> DynamicStringTable;
 
+// NOTE(fusion): String numbers are `1 + BlockIndex * DynamicBlockEntries +
+// EntryIndex`, so blocks are never removed or reordered. The block index maps
+// a block number directly to its block, and the free block list links blocks
+// that still have free entries and text space, most recently freed first.
+static vector<TDynamicStringTableBlock*> DynamicBlockIndex(0, 100, 100, NULL);
+static int DynamicBlocks;
+static int FirstFreeDynamicBlock = -1;
+static int FirstDirtyDynamicBlock = -1;
+static int LastDirtyDynamicBlock = -1;
+
+static int DynamicTextLength;
+static int DynamicDeletedTextLength;
+static int DynamicCompactCount;
+static int DynamicCompactBytes;
+static uint64 DynamicCompactTime;
+static uint64 DynamicCompactMaxTime;
+
+static TDynamicStringTableBlock *GetDynamicBlock(int BlockIndex){
+	if(BlockIndex < 0 || BlockIndex >= DynamicBlocks){
+		return NULL;
+	}
+
+	return *DynamicBlockIndex.at(BlockIndex);
+}
+
+static bool HasDynamicBlockSpace(TDynamicStringTableBlock *Block){
+	return Block->FreeEntries > 0
+		&& (Block->TotalTextLength + DynamicBlockReserve) <= DynamicBlockSize;
+}
+
+static void LinkFreeDynamicBlock(int BlockIndex){
+	TDynamicStringTableBlock *Block = GetDynamicBlock(BlockIndex);
+	if(Block != NULL && !Block->FreeListed && HasDynamicBlockSpace(Block)){
+		Block->FreeListed = true;
+		Block->NextFreeBlock = FirstFreeDynamicBlock;
+		FirstFreeDynamicBlock = BlockIndex;
+	}
+}
+
+static int NewDynamicBlock(void){
+	listnode<TDynamicStringTableBlock> *Node = DynamicStringTable.append();
+	TDynamicStringTableBlock *Block = &Node->data;
+	memset(Block, 0, sizeof(TDynamicStringTableBlock));
+	Block->NextFreeBlock = -1;
+	Block->NextDirtyBlock = -1;
+	Block->FreeEntries = DynamicBlockEntries;
+	for(int i = 0; i < DynamicBlockEntries; i += 1){
+		Block->FreeEntry[i] = (uint8)(DynamicBlockEntries - 1 - i);
+	}
+
+	int BlockIndex = DynamicBlocks;
+	*DynamicBlockIndex.at(BlockIndex) = Block;
+	DynamicBlocks += 1;
+	LinkFreeDynamicBlock(BlockIndex);
+	return BlockIndex;
+}
+
 const char *AddStaticString(const char *String){
 	int StringLen = (int)strlen(String);
 	if((StringLen + 1) > StaticBlockSize){
@@ -59,6 +137,81 @@ const char *AddStaticString(const char *String){
 	return Result;
 }
 
+static bool NeedsDynamicBlockCompaction(TDynamicStringTableBlock *Block){
+	if(Block->DeletedTextLength == 0){
+		return false;
+	}
+
+	return Block->FreeEntries == 0
+		|| (Block->DeletedTextLength * 100) >= (Block->TotalTextLength * DynamicCompactThreshold);
+}
+
+static void QueueDirtyDynamicBlock(int BlockIndex){
+	TDynamicStringTableBlock *Block = GetDynamicBlock(BlockIndex);
+	if(Block == NULL || Block->Dirty){
+		return;
+	}
+
+	Block->Dirty = true;
+	Block->NextDirtyBlock = -1;
+	if(LastDirtyDynamicBlock == -1){
+		FirstDirtyDynamicBlock = BlockIndex;
+	}else{
+		GetDynamicBlock(LastDirtyDynamicBlock)->NextDirtyBlock = BlockIndex;
+	}
+	LastDirtyDynamicBlock = BlockIndex;
+}
+
+// NOTE(fusion): Packs the remaining strings of a block to the front in a
+// single pass over the text, in offset order, and frees deleted entries.
+// Returns the number of bytes moved.
+static int CompactDynamicBlock(TDynamicStringTableBlock *Block){
+	uint8 Order[DynamicBlockEntries];
+	int Strings = 0;
+	for(int i = 0; i < DynamicBlockEntries; i += 1){
+		if(Block->EntryType[i] == DYNAMIC_STRING_ALLOCATED){
+			Order[Strings] = (uint8)i;
+			Strings += 1;
+		}else if(Block->EntryType[i] == DYNAMIC_STRING_DELETED){
+			Block->EntryType[i] = DYNAMIC_STRING_FREE;
+			Block->FreeEntry[Block->FreeEntries] = (uint8)i;
+			Block->FreeEntries += 1;
+		}
+	}
+
+	std::sort(Order, Order + Strings,
+		[Block](uint8 A, uint8 B){
+			return Block->StringOffset[A] < Block->StringOffset[B];
+		});
+
+	int Moved = 0;
+	int TextEnd = 0;
+	for(int i = 0; i < Strings; i += 1){
+		int EntryIndex = (int)Order[i];
+		int StringOffset = (int)Block->StringOffset[EntryIndex];
+		int StringSize = (int)strnlen(&Block->Text[StringOffset], DynamicBlockSize - StringOffset) + 1;
+		if((StringOffset + StringSize) > DynamicBlockSize){
+			error("CleanupDynamicStrings: Stringende fehlt\n");
+			StringSize = DynamicBlockSize - StringOffset;
+			Block->Text[DynamicBlockSize - 1] = 0;
+		}
+
+		ASSERT(StringOffset >= TextEnd);
+		if(StringOffset != TextEnd){
+			memmove(&Block->Text[TextEnd], &Block->Text[StringOffset], StringSize);
+			Block->StringOffset[EntryIndex] = (uint16)TextEnd;
+			Moved += StringSize;
+		}
+		TextEnd += StringSize;
+	}
+
+	DynamicTextLength -= Block->TotalTextLength - TextEnd;
+	DynamicDeletedTextLength -= Block->DeletedTextLength;
+	Block->TotalTextLength = TextEnd;
+	Block->DeletedTextLength = 0;
+	return Moved;
+}
+
 uint32 AddDynamicString(const char *String){
 	int StringLen = (String ? (int)strlen(String) : 0);
 	if(StringLen == 0){
@@ -70,41 +223,54 @@ uint32 AddDynamicString(const char *String){
 		return 0;
 	}
 
-	int BlockIndex = 0;
-	listnode<TDynamicStringTableBlock> *Node = DynamicStringTable.firstNode;
-	while(Node != NULL){
-		if(Node->data.FreeEntries > 0){
-			if((Node->data.TotalTextLength + StringLen + 1) <= DynamicBlockSize){
-				break;
+	// NOTE(fusion): Blocks that ran out of space are unlinked as we go, which
+	// keeps this amortized constant time. Blocks that still have space but not
+	// enough for this string are skipped, at most `DynamicBlockProbes` times.
+	int BlockIndex = -1;
+	int Probes = 0;
+	int *Link = &FirstFreeDynamicBlock;
+	while(*Link != -1 && Probes < DynamicBlockProbes){
+		TDynamicStringTableBlock *Block = GetDynamicBlock(*Link);
+		if(!HasDynamicBlockSpace(Block)){
+			// NOTE(fusion): Deletions below the compaction threshold don't queue
+			// a block, but once it ran out of entries or text they're the only
+			// way it can get space back, so queue it here.
+			if(Block->DeletedTextLength > 0){
+				QueueDirtyDynamicBlock(*Link);
 			}
-		}
-		Node = Node->next;
-		BlockIndex += 1;
-	}
 
-	if(Node == NULL){
-		Node = DynamicStringTable.append();
-		memset(&Node->data, 0, sizeof(TDynamicStringTableBlock));
-		Node->data.FreeEntries = DynamicBlockEntries;
-	}
+			Block->FreeListed = false;
+			*Link = Block->NextFreeBlock;
+			Block->NextFreeBlock = -1;
+			continue;
+		}
 
-	TDynamicStringTableBlock *Block = &Node->data;
-	int EntryIndex = -1;
-	for(int i = 0; i < DynamicBlockEntries; i += 1){
-		if(Block->EntryType[i] == DYNAMIC_STRING_FREE){
-			EntryIndex = i;
+		if((Block->TotalTextLength + StringLen + 1) <= DynamicBlockSize){
+			BlockIndex = *Link;
 			break;
 		}
+
+		Link = &Block->NextFreeBlock;
+		Probes += 1;
+	}
+
+	if(BlockIndex == -1){
+		BlockIndex = NewDynamicBlock();
 	}
 
-	if(EntryIndex == -1){
+	TDynamicStringTableBlock *Block = GetDynamicBlock(BlockIndex);
+	if(Block->FreeEntries <= 0){
 		error("AddDynamicString: Keinen freien Platz gefunden.\n");
 		return 0;
 	}
 
-	int StringOffset = Block->TotalTextLength;
 	Block->FreeEntries -= 1;
+	int EntryIndex = (int)Block->FreeEntry[Block->FreeEntries];
+	ASSERT(Block->EntryType[EntryIndex] == DYNAMIC_STRING_FREE);
+
+	int StringOffset = Block->TotalTextLength;
 	Block->TotalTextLength += StringLen + 1;
+	DynamicTextLength += StringLen + 1;
 	Block->EntryType[EntryIndex] = DYNAMIC_STRING_ALLOCATED;
 	Block->StringOffset[EntryIndex] = (uint16)StringOffset;
 	memcpy(&Block->Text[StringOffset], String, StringLen + 1);
@@ -119,18 +285,12 @@ const char *GetDynamicString(uint32 Number){
 
 	int BlockIndex = (int)(Number - 1) / DynamicBlockEntries;
 	int EntryIndex = (int)(Number - 1) % DynamicBlockEntries;
-	listnode<TDynamicStringTableBlock> *Node = DynamicStringTable.firstNode;
-	while(BlockIndex > 0 && Node != NULL){
-		Node = Node->next;
-		BlockIndex -= 1;
-	}
-
-	if(Node == NULL){
+	TDynamicStringTableBlock *Block = GetDynamicBlock(BlockIndex);
+	if(Block == NULL){
 		error("GetDynamicString: Block für String %u existiert nicht\n", Number);
 		return NULL;
 	}
 
-	TDynamicStringTableBlock *Block = &Node->data;
 	if(Block->EntryType[EntryIndex] != DYNAMIC_STRING_ALLOCATED){
 		error("GetDynamicString: Eintrag für String %u existiert nicht\n", Number);
 		return NULL;
@@ -147,65 +307,75 @@ void DeleteDynamicString(uint32 Number){
 
 	int BlockIndex = (int)(Number - 1) / DynamicBlockEntries;
 	int EntryIndex = (int)(Number - 1) % DynamicBlockEntries;
-	listnode<TDynamicStringTableBlock> *Node = DynamicStringTable.firstNode;
-	while(BlockIndex > 0 && Node != NULL){
-		Node = Node->next;
-		BlockIndex -= 1;
-	}
-
-	if(Node == NULL){
+	TDynamicStringTableBlock *Block = GetDynamicBlock(BlockIndex);
+	if(Block == NULL){
 		error("DeleteDynamicString: Block für String %u existiert nicht\n", Number);
 		return;
 	}
 
-	TDynamicStringTableBlock *Block = &Node->data;
 	if(Block->EntryType[EntryIndex] != DYNAMIC_STRING_ALLOCATED){
 		error("DeleteDynamicString: Eintrag für String %u existiert nicht\n", Number);
 		return;
 	}
 
+	int StringOffset = (int)Block->StringOffset[EntryIndex];
+	int StringSize = (int)strnlen(&Block->Text[StringOffset], DynamicBlockSize - StringOffset) + 1;
 	Block->EntryType[EntryIndex] = DYNAMIC_STRING_DELETED;
-	Block->Dirty = true;
+	Block->DeletedTextLength += StringSize;
+	DynamicDeletedTextLength += StringSize;
+	if(NeedsDynamicBlockCompaction(Block)){
+		QueueDirtyDynamicBlock(BlockIndex);
+	}
 }
 
 void CleanupDynamicStrings(void){
 	// IMPORTANT(fusion): The way we manage dynamic strings also mean pointers
 	// returned from `GetDynamicString` aren't stable.
-	for(listnode<TDynamicStringTableBlock> *Node = DynamicStringTable.firstNode;
-			Node != NULL;
-			Node = Node->next){
-		TDynamicStringTableBlock *Block = &Node->data;
-		if(!Block->Dirty){
-			continue;
+	if(FirstDirtyDynamicBlock == -1){
+		return;
+	}
+
+	uint64 StartTime = GetMonotonicMicroseconds();
+	int Moved = 0;
+	while(FirstDirtyDynamicBlock != -1 && Moved < DynamicCompactBudget){
+		int BlockIndex = FirstDirtyDynamicBlock;
+		TDynamicStringTableBlock *Block = GetDynamicBlock(BlockIndex);
+		FirstDirtyDynamicBlock = Block->NextDirtyBlock;
+		if(FirstDirtyDynamicBlock == -1){
+			LastDirtyDynamicBlock = -1;
 		}
 
-		for(int i = 0; i < DynamicBlockEntries; i += 1){
-			if(Block->EntryType[i] == DYNAMIC_STRING_DELETED){
-				int StringOffset = Block->StringOffset[i];
-				char *String = &Block->Text[StringOffset];
-				int StringSize = (int)strlen(String) + 1;
-				int StringEnd = StringOffset + StringSize;
-				Block->EntryType[i] = DYNAMIC_STRING_FREE;
-
-				if(StringEnd > DynamicBlockSize){
-					error("CleanupDynamicStrings: Stringende fehlt\n");
-					continue;
-				}
+		Block->Dirty = false;
+		Block->NextDirtyBlock = -1;
+		Moved += CompactDynamicBlock(Block);
+		LinkFreeDynamicBlock(BlockIndex);
+		DynamicCompactCount += 1;
+	}
 
-				if(StringEnd < DynamicBlockSize){
-					memmove(String, String + StringSize, DynamicBlockSize - StringEnd);
-				}
+	uint64 Time = GetMonotonicMicroseconds() - StartTime;
+	DynamicCompactBytes += Moved;
+	DynamicCompactTime += Time;
+	if(DynamicCompactMaxTime < Time){
+		DynamicCompactMaxTime = Time;
+	}
+}
 
-				for(int j = 0; j < DynamicBlockEntries; j += 1){
-					if(Block->EntryType[j] != DYNAMIC_STRING_FREE
-							&& Block->StringOffset[j] > StringOffset){
-						ASSERT(Block->StringOffset[j] >= StringEnd);
-						Block->StringOffset[j] -= StringSize;
-					}
-				}
-			}
+void DynamicStringSummary(void){
+	if(DynamicCompactCount > 0){
+		int Fragmentation = 0;
+		if(DynamicTextLength > 0){
+			Fragmentation = (int)((int64)DynamicDeletedTextLength * 100 / DynamicTextLength);
 		}
+
+		Log("game", "%d String-Blöcke kompaktiert, %d Bytes verschoben"
+				" (%u us gesamt, %u us max, %d Blöcke, %d%% fragmentiert).\n",
+				DynamicCompactCount, DynamicCompactBytes, (uint32)DynamicCompactTime,
+				(uint32)DynamicCompactMaxTime, DynamicBlocks, Fragmentation);
 	}
+	DynamicCompactCount = 0;
+	DynamicCompactBytes = 0;
+	DynamicCompactTime = 0;
+	DynamicCompactMaxTime = 0;
 }
 
 void InitStrings(void){
@@ -315,6 +485,31 @@ const char *Plural(const char *s, int Count){
 	return ObjectNameString;
 }
 
+static bool MatchWordAt(const char *Pattern, int PatternLength, bool WholeWord, const char *Text){
+	int j = 0;
+	while(j < PatternLength){
+		if(toLower(Pattern[j]) != toLower(Text[j])){
+			break;
+		}
+		j += 1;
+	}
+
+	return j == PatternLength
+		&& (!WholeWord || (!isAlpha(Text[j]) && !isDigit(Text[j])));
+}
+
+// NOTE(fusion): Checks `Pattern` against the word starting at `Text` exactly like
+// `SearchForWord` does for each word it visits.
+bool MatchWordAt(const char *Pattern, const char *Text){
+	int PatternLength = (int)strlen(Pattern);
+	bool WholeWord = false;
+	if(PatternLength > 0 && Pattern[PatternLength - 1] == '$'){
+		PatternLength -= 1;
+		WholeWord = true;
+	}
+	return MatchWordAt(Pattern, PatternLength, WholeWord, Text);
+}
+
 const char *SearchForWord(const char *Pattern, const char *Text){
 	if(Pattern == NULL || Pattern[0] == 0){
 		error("SearchForWord: Übergebenes Suchwort existiert nicht.\n");
@@ -343,19 +538,9 @@ const char *SearchForWord(const char *Pattern, const char *Text){
 		if(!isAlpha(Text[i]) && !isDigit(Text[i])){
 			WordStart = true;
 		}else if(WordStart){
-			int j = 0;
-			while(j < PatternLength){
-				if(toLower(Pattern[j]) != toLower(Text[i + j])){
-					break;
-				}
-				j += 1;
-			}
-
-			if(j == PatternLength){
-				if(!WholeWord || (!isAlpha(Text[i + j]) && !isDigit(Text[i + j]))){
-					Match = &Text[i];
-					break;
-				}
+			if(MatchWordAt(Pattern, PatternLength, WholeWord, &Text[i])){
+				Match = &Text[i];
+				break;
 			}
 
 			WordStart = false;
@@ -91,3 +91,18 @@ uint32 GetRoundForNextMinute(void){
 	int SecondsToNextMinute = 60 - LocalTime.tm_sec;
 	return SecondsToNextMinute + RoundNr + 30;
 }
+
+// NOTE(fusion): Monotonic clock readings used for timeouts and instrumentation.
+// They're independent from `RoundNr` and `ServerMilliseconds` so they're safe
+// to use from any thread.
+uint64 GetMonotonicMilliseconds(void){
+	struct timespec Now;
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (uint64)Now.tv_sec * 1000 + (uint64)Now.tv_nsec / 1000000;
+}
+
+uint64 GetMonotonicMicroseconds(void){
+	struct timespec Now;
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (uint64)Now.tv_sec * 1000000 + (uint64)Now.tv_nsec / 1000;
+}
@@ -95,6 +95,28 @@ bool FileExists(const char *FileName){
 	return Result;
 }
 
+bool GetFileModificationTime(const char *FileName, timespec *Time){
+	struct stat Stat;
+	if(stat(FileName, &Stat) == -1){
+		return false;
+	}
+
+	*Time = Stat.st_mtim;
+	return true;
+}
+
+// NOTE(fusion): Files that must survive a crash while saving are written to a
+// temporary file first and then renamed over the old one, so they can't be left
+// truncated.
+void ReplaceFile(const char *TempFileName, const char *FileName){
+	if(rename(TempFileName, FileName) == -1){
+		error("ReplaceFile: Kann Datei %s nicht umbenennen (Fehler %d).\n",
+				TempFileName, errno);
+		unlink(TempFileName);
+		throw "Cannot rename file";
+	}
+}
+
 // String Utility
 // =============================================================================
 bool isSpace(int c){
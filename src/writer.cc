@@ -5,15 +5,42 @@
 #include "query.hh"
 #include "threads.hh"
 
+#include <fcntl.h>
+#include <signal.h>
+
 static ThreadHandle ProtocolThread;
 static ThreadHandle WriterThread;
 
+// NOTE(fusion): The protocol thread keeps log files open and writes them in
+// large chunks. Buffers are flushed when full, every `ProtocolFlushInterval`
+// milliseconds, and right away for the error log. A file is closed and opened
+// again after a SIGHUP, so it can be moved away by an external log rotation,
+// and it's rotated to `<name>.log.1` once it grows past `ProtocolMaxFileSize`.
+// When the ring is full, lines are dropped instead of blocking the caller,
+// except for error lines, which are then written by the caller directly.
+struct TProtocolFile{
+	char ProtocolName[20];
+	int File;
+	int64 FileSize;
+	int BufferLength;
+	char Buffer[KB(64)];
+};
+
+constexpr int ProtocolFlushInterval = 1000;
+constexpr int64 ProtocolMaxFileSize = MB(256);
+
 static TProtocolThreadOrder ProtocolBuffer[1000];
 static int ProtocolPointerWrite;
 static int ProtocolPointerRead;
-static Semaphore ProtocolMutex(1);
-static Semaphore ProtocolBufferEmpty(NARRAY(ProtocolBuffer));
-static Semaphore ProtocolBufferFull(0);
+static int ProtocolDroppedLines;
+static int ProtocolLostLines;
+static bool ProtocolTerminate;
+static pthread_mutex_t ProtocolMutex;
+static pthread_cond_t ProtocolCondition;
+static volatile sig_atomic_t ProtocolReopen;
+
+static TProtocolFile *ProtocolFiles[50];
+static int ProtocolFileCount;
 
 static TWriterThreadOrder OrderBuffer[2000];
 static int OrderPointerWrite;
@@ -32,6 +59,22 @@ static TQueryManagerConnection *QueryManagerConnection;
 void InitProtocol(void){
 	ProtocolPointerWrite = 0;
 	ProtocolPointerRead = 0;
+	ProtocolDroppedLines = 0;
+	ProtocolLostLines = 0;
+	ProtocolTerminate = false;
+	ProtocolReopen = 0;
+
+	pthread_condattr_t ConditionAttr;
+	pthread_condattr_init(&ConditionAttr);
+	pthread_condattr_setclock(&ConditionAttr, CLOCK_MONOTONIC);
+	pthread_mutex_init(&ProtocolMutex, NULL);
+	pthread_cond_init(&ProtocolCondition, &ConditionAttr);
+	pthread_condattr_destroy(&ConditionAttr);
+}
+
+void ExitProtocol(void){
+	pthread_cond_destroy(&ProtocolCondition);
+	pthread_mutex_destroy(&ProtocolMutex);
 }
 
 void InsertProtocolOrder(const char *ProtocolName, const char *Text){
@@ -45,27 +88,75 @@ void InsertProtocolOrder(const char *ProtocolName, const char *Text){
 		return;
 	}
 
+	bool WriteDirect = false;
+	pthread_mutex_lock(&ProtocolMutex);
 	int Orders = (ProtocolPointerWrite - ProtocolPointerRead);
-	if(Orders >= NARRAY(ProtocolBuffer) && strcmp(ProtocolName, "error") != 0){
-		error("InsertProtocolOrder: Protokoll-Puffer ist voll => Vergrößern.\n");
-	}
-
-	ProtocolMutex.down();
-	ProtocolBufferEmpty.down();
-	int WritePos = ProtocolPointerWrite % NARRAY(ProtocolBuffer);
-	strcpy(ProtocolBuffer[WritePos].ProtocolName, ProtocolName);
-	strcpy(ProtocolBuffer[WritePos].Text, Text);
-	ProtocolPointerWrite += 1;
-	ProtocolBufferFull.up();
-	ProtocolMutex.up();
+	if(Orders >= NARRAY(ProtocolBuffer)){
+		if(strcmp(ProtocolName, "error") == 0){
+			WriteDirect = true;
+		}else{
+			ProtocolDroppedLines += 1;
+		}
+	}else{
+		int WritePos = ProtocolPointerWrite % NARRAY(ProtocolBuffer);
+		strcpy(ProtocolBuffer[WritePos].ProtocolName, ProtocolName);
+		strcpy(ProtocolBuffer[WritePos].Text, Text);
+		ProtocolPointerWrite += 1;
+		pthread_cond_signal(&ProtocolCondition);
+	}
+	pthread_mutex_unlock(&ProtocolMutex);
+
+	// NOTE(fusion): Error lines are never dropped. The protocol thread also opens
+	// the error log with `O_APPEND`, so both writers only append, although this
+	// line may end up ahead of older ones still waiting in the ring.
+	if(WriteDirect){
+		WriteProtocol(ProtocolName, Text);
+	}
+}
+
+void TerminateProtocolOrder(void){
+	pthread_mutex_lock(&ProtocolMutex);
+	ProtocolTerminate = true;
+	pthread_cond_signal(&ProtocolCondition);
+	pthread_mutex_unlock(&ProtocolMutex);
+}
+
+int GetProtocolOrder(TProtocolThreadOrder *Order, int Timeout, int *DroppedLines){
+	struct timespec Deadline;
+	clock_gettime(CLOCK_MONOTONIC, &Deadline);
+	Deadline.tv_sec += Timeout / 1000;
+	Deadline.tv_nsec += (Timeout % 1000) * 1000000;
+	if(Deadline.tv_nsec >= 1000000000){
+		Deadline.tv_sec += 1;
+		Deadline.tv_nsec -= 1000000000;
+	}
+
+	pthread_mutex_lock(&ProtocolMutex);
+	while(ProtocolPointerWrite == ProtocolPointerRead && !ProtocolTerminate){
+		if(pthread_cond_timedwait(&ProtocolCondition, &ProtocolMutex, &Deadline) == ETIMEDOUT){
+			break;
+		}
+	}
+
+	int Result = PROTOCOL_ORDER_TIMEOUT;
+	if(ProtocolPointerWrite != ProtocolPointerRead){
+		int ReadPos = ProtocolPointerRead % NARRAY(ProtocolBuffer);
+		*Order = ProtocolBuffer[ReadPos];
+		ProtocolPointerRead += 1;
+		Result = PROTOCOL_ORDER_OK;
+	}else if(ProtocolTerminate){
+		Result = PROTOCOL_ORDER_TERMINATE;
+	}
+
+	*DroppedLines = ProtocolDroppedLines;
+	ProtocolDroppedLines = 0;
+	pthread_mutex_unlock(&ProtocolMutex);
+	return Result;
 }
 
-void GetProtocolOrder(TProtocolThreadOrder *Order){
-	ProtocolBufferFull.down();
-	int ReadPos = ProtocolPointerRead % NARRAY(ProtocolBuffer);
-	*Order = ProtocolBuffer[ReadPos];
-	ProtocolPointerRead += 1;
-	ProtocolBufferEmpty.up();
+void ReopenProtocols(void){
+	// NOTE(fusion): Called from the SIGHUP handler.
+	ProtocolReopen = 1;
 }
 
 void WriteProtocol(const char *ProtocolName, const char *Text){
@@ -81,16 +172,186 @@ void WriteProtocol(const char *ProtocolName, const char *Text){
 	}
 }
 
+static bool OpenProtocolFile(TProtocolFile *Protocol){
+	char FileName[4096];
+	snprintf(FileName, sizeof(FileName), "%s/%s.log", LOGPATH, Protocol->ProtocolName);
+
+	Protocol->File = open(FileName, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+	if(Protocol->File == -1){
+		return false;
+	}
+
+	Protocol->FileSize = (int64)lseek(Protocol->File, 0, SEEK_END);
+	return true;
+}
+
+static int CountProtocolLines(const char *Buffer, int Length){
+	int Lines = 0;
+	for(int i = 0; i < Length; i += 1){
+		if(Buffer[i] == '\n'){
+			Lines += 1;
+		}
+	}
+	return Lines;
+}
+
+static void FlushProtocolFile(TProtocolFile *Protocol){
+	if(Protocol->BufferLength == 0){
+		return;
+	}
+
+	if(Protocol->File == -1 && !OpenProtocolFile(Protocol)){
+		// NOTE(fusion): Keep the buffer and try again on the next flush. If it
+		// is still full by then, the oldest lines are lost.
+		return;
+	}
+
+	int Written = 0;
+	while(Written < Protocol->BufferLength){
+		int Ret = (int)write(Protocol->File,
+				&Protocol->Buffer[Written],
+				Protocol->BufferLength - Written);
+		if(Ret == -1){
+			if(errno == EINTR){
+				continue;
+			}
+
+			print(1, "FlushProtocolFile: Fehler %d beim Schreiben von %s.log.\n",
+					errno, Protocol->ProtocolName);
+			ProtocolLostLines += CountProtocolLines(&Protocol->Buffer[Written],
+					Protocol->BufferLength - Written);
+			break;
+		}
+		Written += Ret;
+	}
+
+	Protocol->FileSize += Written;
+	Protocol->BufferLength = 0;
+
+	if(Protocol->FileSize >= ProtocolMaxFileSize){
+		char FileName[4096];
+		char OldFileName[4096];
+		snprintf(FileName, sizeof(FileName), "%s/%s.log", LOGPATH, Protocol->ProtocolName);
+		snprintf(OldFileName, sizeof(OldFileName), "%s.1", FileName);
+		close(Protocol->File);
+		Protocol->File = -1;
+		if(rename(FileName, OldFileName) == -1){
+			print(1, "FlushProtocolFile: Kann %s.log nicht rotieren (%d).\n",
+					Protocol->ProtocolName, errno);
+		}
+	}
+}
+
+static void CloseProtocolFiles(void){
+	for(int i = 0; i < ProtocolFileCount; i += 1){
+		TProtocolFile *Protocol = ProtocolFiles[i];
+		FlushProtocolFile(Protocol);
+		if(Protocol->File != -1){
+			close(Protocol->File);
+			Protocol->File = -1;
+		}
+	}
+}
+
+static void FlushProtocolFiles(void){
+	for(int i = 0; i < ProtocolFileCount; i += 1){
+		FlushProtocolFile(ProtocolFiles[i]);
+	}
+}
+
+static void DeleteProtocolFiles(void){
+	CloseProtocolFiles();
+	for(int i = 0; i < ProtocolFileCount; i += 1){
+		delete ProtocolFiles[i];
+		ProtocolFiles[i] = NULL;
+	}
+	ProtocolFileCount = 0;
+}
+
+static TProtocolFile *GetProtocolFile(const char *ProtocolName){
+	for(int i = 0; i < ProtocolFileCount; i += 1){
+		if(strcmp(ProtocolFiles[i]->ProtocolName, ProtocolName) == 0){
+			return ProtocolFiles[i];
+		}
+	}
+
+	if(ProtocolFileCount >= NARRAY(ProtocolFiles)){
+		return NULL;
+	}
+
+	TProtocolFile *Protocol = new TProtocolFile;
+	strcpy(Protocol->ProtocolName, ProtocolName);
+	Protocol->File = -1;
+	Protocol->FileSize = 0;
+	Protocol->BufferLength = 0;
+	ProtocolFiles[ProtocolFileCount] = Protocol;
+	ProtocolFileCount += 1;
+	return Protocol;
+}
+
+static void WriteBufferedProtocol(const char *ProtocolName, const char *Text){
+	TProtocolFile *Protocol = GetProtocolFile(ProtocolName);
+	if(Protocol == NULL){
+		WriteProtocol(ProtocolName, Text);
+		return;
+	}
+
+	int TextLength = (int)strlen(Text);
+	if((Protocol->BufferLength + TextLength) > NARRAY(Protocol->Buffer)){
+		FlushProtocolFile(Protocol);
+		if((Protocol->BufferLength + TextLength) > NARRAY(Protocol->Buffer)){
+			// NOTE(fusion): The file still can't be opened, so the buffered lines
+			// are lost. They're reported together with the dropped ones.
+			ProtocolLostLines += CountProtocolLines(Protocol->Buffer, Protocol->BufferLength);
+			Protocol->BufferLength = 0;
+		}
+	}
+
+	memcpy(&Protocol->Buffer[Protocol->BufferLength], Text, TextLength);
+	Protocol->BufferLength += TextLength;
+
+	if(strcmp(ProtocolName, "error") == 0){
+		FlushProtocolFile(Protocol);
+	}
+}
+
 int ProtocolThreadLoop(void *Unused){
 	TProtocolThreadOrder Order = {};
+	uint64 NextFlush = GetMonotonicMilliseconds() + ProtocolFlushInterval;
 	while(true){
-		GetProtocolOrder(&Order);
-		if(Order.ProtocolName[0] == 0){
+		int DroppedLines = 0;
+		int Result = GetProtocolOrder(&Order, ProtocolFlushInterval, &DroppedLines);
+		DroppedLines += ProtocolLostLines;
+		ProtocolLostLines = 0;
+		if(DroppedLines > 0){
+			char Line[256];
+			snprintf(Line, sizeof(Line),
+					"ProtocolThreadLoop: %d Protokollzeilen verworfen.\n",
+					DroppedLines);
+			WriteBufferedProtocol("error", Line);
+		}
+
+		if(Result == PROTOCOL_ORDER_TERMINATE){
 			break;
 		}
 
-		WriteProtocol(Order.ProtocolName, Order.Text);
+		if(Result == PROTOCOL_ORDER_OK){
+			WriteBufferedProtocol(Order.ProtocolName, Order.Text);
+		}
+
+		if(ProtocolReopen != 0){
+			ProtocolReopen = 0;
+			CloseProtocolFiles();
+		}
+
+		uint64 Now = GetMonotonicMilliseconds();
+		if(Now >= NextFlush){
+			FlushProtocolFiles();
+			NextFlush = Now + ProtocolFlushInterval;
+		}
 	}
+
+	DeleteProtocolFiles();
 	return 0;
 }
 
@@ -1031,9 +1292,10 @@ void AbortWriter(void){
 
 void ExitWriter(void){
 	if(ProtocolThread != INVALID_THREAD_HANDLE){
-		InsertProtocolOrder("", "");
+		TerminateProtocolOrder();
 		JoinThread(ProtocolThread);
 		ProtocolThread = INVALID_THREAD_HANDLE;
+		ExitProtocol();
 	}
 
 	if(WriterThread != INVALID_THREAD_HANDLE){
@@ -24,6 +24,12 @@ enum TWriterThreadReplyType: int {
 	WRITER_REPLY_LOGOUT				= 2,
 };
 
+enum : int {
+	PROTOCOL_ORDER_OK				= 0,
+	PROTOCOL_ORDER_TIMEOUT			= 1,
+	PROTOCOL_ORDER_TERMINATE		= 2,
+};
+
 struct TProtocolThreadOrder{
 	char ProtocolName[20];
 	char Text[256];
@@ -100,8 +106,11 @@ struct TDirectReplyData{
 };
 
 void InitProtocol(void);
+void ExitProtocol(void);
 void InsertProtocolOrder(const char *ProtocolName, const char *Text);
-void GetProtocolOrder(TProtocolThreadOrder *Order);
+void TerminateProtocolOrder(void);
+int GetProtocolOrder(TProtocolThreadOrder *Order, int Timeout, int *DroppedLines);
+void ReopenProtocols(void);
 void WriteProtocol(const char *ProtocolName, const char *Text);
 int ProtocolThreadLoop(void *Unused);
 void InitLog(const char *ProtocolName);